@@ -3,17 +3,22 @@
     Author: Spencer Scott
 */
 
-#define SCREEN_WIDTH 240
-#define SCREEN_HEIGHT 160
-
 /* include the background image we are using */
 #include "background.h"
 
 /* include the sprite image we are using */
 #include "dragon.h"
 
-/* include the ground layer map we are using */
-#include "groundlayermap.h"     //bg1
+/* include the cycle counter, and have the game time its passes with it */
+#include "profile.h"
+#define GAME_ZONE_BEGIN(zone) profile_begin(zone)
+#define GAME_ZONE_END(zone) profile_end(zone)
+
+/* include the memory sections and allocators */
+#include "memory.h"
+
+/* include the game logic, which brings in the ground layer map (bg1) */
+#include "game.h"
 
 /* include the background tile map */
 #include "layer0map.h"          //bg0
@@ -21,6 +26,54 @@
 /* include the the score tile map */
 #include "score.h"              //bg2
 
+/* include the autopilot */
+#include "autopilot.h"
+
+/* include rollback netplay and the link cable it runs over */
+#include "netplay.h"
+#include "link.h"
+
+/* include the keypad */
+#include "input.h"
+
+/* include the VRAM layout checks and allocator */
+#include "vram.h"
+
+/* include the vblank copy queue and the sprite tile cache that uses it */
+#include "dmaqueue.h"
+#include "spritecache.h"
+
+/* include the background tile animations */
+#include "tileanim.h"
+
+/* include the palette fades, flashes and cycles */
+#include "palette.h"
+
+/* include the particles */
+#include "particles.h"
+
+/* include the ghost of the best run, kept in SRAM */
+#include "ghost.h"
+
+/* include the zooming and turning of the affine background */
+#include "affine.h"
+
+/* include the frame task scheduler */
+#include "scheduler.h"
+
+/* include the level streamer and the level it streams */
+#include "level.h"
+#include "level1.h"
+
+/* include where everything goes in VRAM */
+#include "vramlayout.h"
+
+/* the benchmark build plays a recorded replay instead of the keypad, made
+ * into a header by cyclebench in the tools */
+#ifdef PHLAPU_BENCH
+#include "benchreplay.h"
+#endif
+
 /* the tile mode flags needed for display control register */
 #define MODE0 0x00
 #define MODE1 0x01
@@ -36,6 +89,9 @@
 #define SPRITE_MAP_1D 0x40
 #define SPRITE_ENABLE 0x1000
 
+/* the sprite mode in attribute0 that blends a sprite with what is under it */
+#define SPRITE_SEMI_TRANSPARENT 0x400
+
 
 /* the control registers for the four tile layers */
 volatile unsigned short* bg0_control = (volatile unsigned short*) 0x4000008;
@@ -47,9 +103,6 @@ volatile unsigned short* bg3_control = (volatile unsigned short*) 0x400000e;
 /* palette is always 256 colors */
 #define PALETTE_SIZE 256
 
-/* there are 128 sprites on the GBA */
-#define NUM_SPRITES 128
-
 /* the display control pointer points to the gba graphics register */
 volatile unsigned long* display_control = (volatile unsigned long*) 0x4000000;
 
@@ -63,11 +116,6 @@ volatile unsigned short* sprite_image_memory = (volatile unsigned short*) 0x6010
 volatile unsigned short* bg_palette = (volatile unsigned short*) 0x5000000;
 volatile unsigned short* sprite_palette = (volatile unsigned short*) 0x5000200;
 
-/* the button register holds the bits which indicate whether each button has
- * been pressed - this has got to be volatile as well
- */
-volatile unsigned short* buttons = (volatile unsigned short*) 0x04000130;
-
 /* scrolling registers for backgrounds */
 volatile short* bg0_x_scroll = (unsigned short*) 0x4000010;
 volatile short* bg0_y_scroll = (unsigned short*) 0x4000012;
@@ -78,19 +126,26 @@ volatile short* bg2_y_scroll = (unsigned short*) 0x400001a;
 volatile short* bg3_x_scroll = (unsigned short*) 0x400001c;
 volatile short* bg3_y_scroll = (unsigned short*) 0x400001e;
 
-/* the bit positions indicate each button - the first bit is for A, second for
- * B, and so on, each constant below can be ANDED into the register to get the
- * status of any one button */
-#define BUTTON_A (1 << 0)
-#define BUTTON_B (1 << 1)
-#define BUTTON_SELECT (1 << 2)
-#define BUTTON_START (1 << 3)
-#define BUTTON_RIGHT (1 << 4)
-#define BUTTON_LEFT (1 << 5)
-#define BUTTON_UP (1 << 6)
-#define BUTTON_DOWN (1 << 7)
-#define BUTTON_R (1 << 8)
-#define BUTTON_L (1 << 9)
+/* background 2's affine registers, BG2PA to BG2Y, which in modes 1 and 2
+ * are a line's AffineLine */
+volatile unsigned int* bg2_affine = (volatile unsigned int*) 0x4000020;
+
+/* the colour effect registers: which layers blend with which, and how much
+ * of each goes into the mix, out of 16 */
+volatile unsigned short* blend_control = (volatile unsigned short*) 0x4000050;
+volatile unsigned short* blend_alpha = (volatile unsigned short*) 0x4000052;
+
+/* the layers a see-through sprite can blend with, in blend_control */
+#define BLEND_BG0_UNDER 0x100
+#define BLEND_BG1_UNDER 0x200
+#define BLEND_BACKDROP_UNDER 0x2000
+
+/* the cartridge's save memory, which only takes 8 bit reads and writes */
+volatile unsigned char* save_memory = (volatile unsigned char*) 0xe000000;
+
+/* emulators and flash carts look through the ROM for this to know the
+ * cartridge has SRAM */
+__attribute__((used)) const char save_type[] = "SRAM_V113";
 
 /* the scanline counter is a memory cell which is updated to indicate how
  * much of the screen has been drawn */
@@ -98,23 +153,14 @@ volatile unsigned short* scanline_counter = (volatile unsigned short*) 0x4000006
 
 /* wait for the screen to be fully drawn so we can do something during vblank */
 void wait_vblank( ) {
+    /* if we are still in the last vblank, wait for it to end first so each
+     * frame waits for a vblank of its own */
+    while (*scanline_counter >= 160) { }
+
     /* wait until all 160 lines have been updated */
     while (*scanline_counter < 160) { }
 }
 
-/* this function checks whether a particular button has been pressed */
-unsigned char button_pressed(unsigned short button) {
-    /* and the button register with the button constant we want */
-    unsigned short pressed = *buttons & button;
-
-    /* if this value is zero, then it's not pressed */
-    if (pressed == 0) {
-        return 1;
-    } else {
-        return 0;
-    }
-}
-
 /* return a pointer to one of the 4 character blocks (0-3) */
 volatile unsigned short* char_block(unsigned long block) {
     /* they are each 16K big */
@@ -127,6 +173,10 @@ volatile unsigned short* screen_block(unsigned long block) {
     return (volatile unsigned short*) (0x6000000 + (block * 0x800));
 }
 
+/* who owns which part of VRAM, and where the sprite tiles went */
+struct Vram vram;
+struct VramLayout vram_offsets;
+
 /* flag for turning on DMA */
 #define DMA_ENABLE 0x80000000
 
@@ -143,6 +193,18 @@ volatile unsigned int* dma_destination = (volatile unsigned int*) 0x40000D8;
 /* pointer to the DMA count/control */
 volatile unsigned int* dma_count = (volatile unsigned int*) 0x40000DC;
 
+/* the same three for DMA 0, which goes before the others, so the affine
+ * registers for a line are in before it starts even while DMA 3 copies */
+volatile unsigned int* dma0_source = (volatile unsigned int*) 0x40000B0;
+volatile unsigned int* dma0_destination = (volatile unsigned int*) 0x40000B4;
+volatile unsigned int* dma0_count = (volatile unsigned int*) 0x40000B8;
+
+/* flags to have a DMA go again every HBlank, starting back at the same
+ * destination each time */
+#define DMA_DEST_RELOAD 0x00600000
+#define DMA_REPEAT 0x02000000
+#define DMA_AT_HBLANK 0x20000000
+
 /* copy data using DMA */
 void memcpy16_dma(unsigned short* dest, unsigned short* source, int amount) {
     *dma_source = (unsigned int) source;
@@ -150,22 +212,41 @@ void memcpy16_dma(unsigned short* dest, unsigned short* source, int amount) {
     *dma_count = amount | DMA_16 | DMA_ENABLE;
 }
 
+/* copies to VRAM made during the frame, sent in vblank */
+struct DmaQueue vblank_queue;
+
+/* send everything on a queue with 32 bit DMA, a copy at a time, or 16 bit
+ * for the copies that are not word aligned */
+void dma_queue_flush(struct DmaQueue* queue) {
+    for (int i = 0; i < queue->count; i++) {
+        const struct DmaCopy* copy = &queue->copies[i];
+        *dma_source = (unsigned int) copy->source;
+        *dma_destination = (unsigned int) copy->dest;
+        if (copy->unaligned) {
+            *dma_count = (copy->words * 2) | DMA_16 | DMA_ENABLE;
+        } else {
+            *dma_count = copy->words | DMA_32 | DMA_ENABLE;
+        }
+    }
+    dma_queue_done(queue);
+}
+
 /* function to setup background 0 for this program */
 void setup_background() {
 
     /* load the palette from the image into palette memory*/
     memcpy16_dma((unsigned short*) bg_palette, (unsigned short*) background_palette, PALETTE_SIZE);
 
-    /* load the image into char block 0 */
-    memcpy16_dma((unsigned short*) char_block(0), (unsigned short*) background_data,
-            (background_width * background_height) / 2);
+    /* load the image into its char block */
+    memcpy16_dma((unsigned short*) char_block(BG_TILES_CHAR_BLOCK), (unsigned short*) background_data,
+            BG_TILES_BYTES / 2);
 
     /* back */
     *bg0_control = 2 |    /* priority, 0 is highest, 3 is lowest */
-        (0 << 2)  |       /* the char block the image data is stored in */
+        (BG_TILES_CHAR_BLOCK << 2) | /* the char block the image data is stored in */
         (0 << 6)  |       /* the mosaic flag */
         (1 << 7)  |       /* color mode, 0 is 16 colors, 1 is 256 colors */
-        (16 << 8) |       /* the screen block the tile data is stored in */
+        (LAYER0_SCREEN_BLOCK << 8) | /* the screen block the tile data is stored in */
         (1 << 13) |       /* wrapping flag */
         (0 << 14);        /* bg size, 0 is 256x256 */
 
@@ -173,587 +254,1061 @@ void setup_background() {
 
     /* set all control the bits in ground layer */
     *bg1_control = 1 |    /* priority, 0 is highest, 3 is lowest */
-        (0 << 2)  |       /* the char block the image data is stored in */
+        (BG_TILES_CHAR_BLOCK << 2) | /* the char block the image data is stored in */
         (0 << 6)  |       /* the mosaic flag */
         (1 << 7)  |       /* color mode, 0 is 16 colors, 1 is 256 colors */
-        (21 << 8) |       /* the screen block the tile data is stored in */
+        (GROUND_SCREEN_BLOCK << 8) | /* the screen block the tile data is stored in */
         (1 << 13) |       /* wrapping flag */
-        (0 << 14);        /* bg size, 0 is 256x256 */
+        (1 << 14);        /* bg size, 1 is 512x256 */
 
     /* score page */
     *bg2_control = 0 |
-        (0 << 2) |
+        (BG_TILES_CHAR_BLOCK << 2) |
         (0 << 6) |
         (1 << 7) |
-        (26 << 8)|
+        (SCORE_SCREEN_BLOCK << 8) |
         (1 << 13) |
         (0 << 14);
 
-    /* load the score page */
-    memcpy16_dma((unsigned short*) screen_block(26), (unsigned short*) score, score_width * score_height);
+    /* load the score page, and again packed for when it zooms */
+    memcpy16_dma((unsigned short*) screen_block(SCORE_SCREEN_BLOCK), (unsigned short*) score, score_width * score_height);
+    affine_map_pack(screen_block(AFFINE_SCREEN_BLOCK), score, score_width * score_height);
 
-    /* load the ground layer tile data into screen block 21 */
-    memcpy16_dma((unsigned short*) screen_block(21), (unsigned short*) groundlayermap, groundlayermap_width * groundlayermap_height);
+    /* load the shipped ground map into both halves of the ground's screen
+     * blocks, so it wraps as it always has until a level is streamed in */
+    memcpy16_dma((unsigned short*) screen_block(GROUND_SCREEN_BLOCK), (unsigned short*) groundlayermap, groundlayermap_width * groundlayermap_height);
+    memcpy16_dma((unsigned short*) screen_block(GROUND_SCREEN_BLOCK + 1), (unsigned short*) groundlayermap, groundlayermap_width * groundlayermap_height);
 
     /* load in back layer */
-    memcpy16_dma((unsigned short*) screen_block(16), (unsigned short*)
+    memcpy16_dma((unsigned short*) screen_block(LAYER0_SCREEN_BLOCK), (unsigned short*)
         layer0map, layer0map_width * layer0map_height);
 }
 
-/* just kill time */
-void delay(unsigned int amount) {
-    for (int i = 0; i < amount * 10; i++);
-}
+/* the sprites as they go out, with tile numbers pointing into the cache */
+struct Sprite sprites_out[NUM_SPRITES];
 
-///////////////////Sprites
+/* the sprite frames shown lately, kept in sprite VRAM */
+struct SpriteCache sprite_cache;
 
-/* a sprite is a moveable image on the screen */
-struct Sprite {
-    unsigned short attribute0;
-    unsigned short attribute1;
-    unsigned short attribute2;
-    unsigned short attribute3;
-};
+/* update all of the spries on the screen */
+void sprite_update_all(struct Sprite* sprites) {
+    /* copy them all over */
+    profile_begin(PROFILE_SPRITE_UPDATE);
+    memcpy16_dma((unsigned short*) sprite_attribute_memory, (unsigned short*) sprites, NUM_SPRITES * 4);
+    profile_end(PROFILE_SPRITE_UPDATE);
+}
 
-/* array of all the sprites available on the GBA */
-struct Sprite sprites[NUM_SPRITES];
-int next_sprite_index = 0;
-
-/* the different sizes of sprites which are possible */
-enum SpriteSize {
-    SIZE_8_8,
-    SIZE_16_16,
-    SIZE_32_32,
-    SIZE_64_64,
-    SIZE_16_8,
-    SIZE_32_8,
-    SIZE_32_16,
-    SIZE_64_32,
-    SIZE_8_16,
-    SIZE_8_32,
-    SIZE_16_32,
-    SIZE_32_64
-};
+/* setup the sprite image and palette */
+void setup_sprite_image() {
+    /* load the palette from the image into palette memory*/
+    memcpy16_dma((unsigned short*) sprite_palette, (unsigned short*) dragon_palette, PALETTE_SIZE);
 
-/* function to initialize a sprite with its properties, and return a pointer */
-struct Sprite* sprite_init(int x, int y, enum SpriteSize size,
-        int horizontal_flip, int vertical_flip, int tile_index, int priority) {
-
-    /* grab the next index */
-    int index = next_sprite_index++;
-
-    /* setup the bits used for each shape/size possible */
-    int size_bits, shape_bits;
-    switch (size) {
-        case SIZE_8_8:   size_bits = 0; shape_bits = 0; break;
-        case SIZE_16_16: size_bits = 1; shape_bits = 0; break;
-        case SIZE_32_32: size_bits = 2; shape_bits = 0; break;
-        case SIZE_64_64: size_bits = 3; shape_bits = 0; break;
-        case SIZE_16_8:  size_bits = 0; shape_bits = 1; break;
-        case SIZE_32_8:  size_bits = 1; shape_bits = 1; break;
-        case SIZE_32_16: size_bits = 2; shape_bits = 1; break;
-        case SIZE_64_32: size_bits = 3; shape_bits = 1; break;
-        case SIZE_8_16:  size_bits = 0; shape_bits = 2; break;
-        case SIZE_8_32:  size_bits = 1; shape_bits = 2; break;
-        case SIZE_16_32: size_bits = 2; shape_bits = 2; break;
-        case SIZE_32_64: size_bits = 3; shape_bits = 2; break;
-    }
+    /* the frames of the image are uploaded as they are shown, into a pool
+     * of slots at the start of sprite VRAM */
+    int offset = vram_offsets.sprite_cache;
+    sprite_cache_init(&sprite_cache, dragon_data,
+            (unsigned char*) sprite_image_memory + offset, offset / 32);
+
+}
 
-    int h = horizontal_flip ? 1 : 0;
-    int v = vertical_flip ? 1 : 0;
+/* function to set text on the screen at a given location */
+void set_text(char* str, int row, int col) {                    
+    /* find the index in the texmap to draw to */
+    int index = row * 32 + col;
 
-    /* set up the first attribute */
-    sprites[index].attribute0 = y |             /* y coordinate */
-                            (0 << 8) |          /* rendering mode */
-                            (0 << 10) |         /* gfx mode */
-                            (0 << 12) |         /* mosaic */
-                            (1 << 13) |         /* color mode, 0:16, 1:256 */
-                            (shape_bits << 14); /* shape */
+    /* the first 32 characters are missing from the map (controls etc.) */
+    int missing = 32; 
 
-    /* set up the second attribute */
-    sprites[index].attribute1 = x |             /* x coordinate */
-                            (0 << 9) |          /* affine flag */
-                            (h << 12) |         /* horizontal flip flag */
-                            (v << 13) |         /* vertical flip flag */
-                            (size_bits << 14);  /* size */
+    /* pointer to text map */
+    volatile unsigned short* ptr = screen_block(SCORE_SCREEN_BLOCK);
 
-    /* setup the second attribute */
-    sprites[index].attribute2 = tile_index |   // tile index */
-                            (priority << 10) | // priority */
-                            (0 << 12);         // palette bank (only 16 color)*/
+    /* for each character */
+    while (*str) {
+        /* place this character in the map */
+        ptr[index] = *str - missing;
 
-    /* return pointer to this sprite */
-    return &sprites[index];
+        /* move onto the next character */
+        index++;
+        str++;
+    }   
 }
 
-/* update all of the spries on the screen */
-void sprite_update_all() {
-    /* copy them all over */
-    memcpy16_dma((unsigned short*) sprite_attribute_memory, (unsigned short*) sprites, NUM_SPRITES * 4);
-}
+/* declaration of assembly function to uppercase a string */
+void uppercase(char* s);
+
 
-/* setup all sprites */
-void sprite_clear() {
-    /* clear the index counter */
-    next_sprite_index = 0;
+//gameScore Assembly function
+int gameScore(int total, int lap);
 
-    /* move all sprites offscreen to hide them */
-    for(int i = 0; i < NUM_SPRITES; i++) {
-        sprites[i].attribute0 = SCREEN_HEIGHT;
-        sprites[i].attribute1 = SCREEN_WIDTH;
+/* the ends of the static data in each work RAM, from devkitARM's linker
+ * script. .bss is the last thing in IWRAM and .sbss the last in EWRAM */
+extern char __bss_end__[];
+extern char __sbss_end__[];
+
+/* where the two work RAMs start, and the top of the user stack, which grows
+ * down towards the end of .bss */
+#define IWRAM_START 0x3000000
+#define EWRAM_START 0x2000000
+#define STACK_TOP 0x3007f00
+
+/* what the stack is painted with at boot, to find how deep it has been */
+#define STACK_PAINT 0x5a5aa5a5
+
+/* scratch for the frame, in IWRAM, given back at the top of every frame.
+ * the palettes are blended into it for the vblank to copy out */
+#define FRAME_ARENA_SIZE 2048
+unsigned int frame_memory[FRAME_ARENA_SIZE / 4];
+struct Arena frame_arena;
+
+/* room for big buffers that last a level, in EWRAM, given back when a new
+ * game starts */
+#define LEVEL_ARENA_SIZE 0x10000
+EWRAM_BSS unsigned int level_memory[LEVEL_ARENA_SIZE / 4];
+struct Arena level_arena;
+
+/* paint the free IWRAM between the end of .bss and a little below where the
+ * stack is now. this is called first thing, so the stack is still shallow */
+void memory_paint_stack() {
+    unsigned int here;
+    unsigned int* word = (unsigned int*) (((unsigned int) __bss_end__ + 3) & ~3);
+    unsigned int* end = &here - 16;
+    while (word < end) {
+        *word++ = STACK_PAINT;
     }
 }
 
-/* set a sprite postion */
-void sprite_position(struct Sprite* sprite, int x, int y) {
-    /* clear out the y coordinate */
-    sprite->attribute0 &= 0xff00;
+/* how many bytes of stack have ever been used, from the lowest word that
+ * is not paint any more */
+unsigned int memory_stack_high() {
+    unsigned int* word = (unsigned int*) (((unsigned int) __bss_end__ + 3) & ~3);
+    while (word < (unsigned int*) STACK_TOP && *word == STACK_PAINT) {
+        word++;
+    }
+    return STACK_TOP - (unsigned int) word;
+}
 
-    /* set the new y coordinate */
-    sprite->attribute0 |= (y & 0xff);
+void memory_init() {
+    arena_init(&frame_arena, "frame", frame_memory, sizeof(frame_memory));
+    arena_init(&level_arena, "level", level_memory, sizeof(level_memory));
+}
 
-    /* clear out the x coordinate */
-    sprite->attribute1 &= 0xfe00;
+/* log one arena's use */
+void arena_report(const struct Arena* arena) {
+    char line[128];
+    char* end = debug_append(line, "arena ");
+    end = debug_append(end, arena->name);
+    end = debug_append(end, ": used ");
+    end = debug_append_number(end, arena->used);
+    end = debug_append(end, " high ");
+    end = debug_append_number(end, arena->high);
+    end = debug_append(end, " of ");
+    end = debug_append_number(end, arena->size);
+    end = debug_append(end, " failed ");
+    debug_append_number(end, arena->failures);
+    debug_print(line);
+}
 
-    /* set the new x coordinate */
-    sprite->attribute1 |= (x & 0x1ff);
+/* log how full each work RAM is: the static data, the deepest the stack has
+ * been, and the arenas carved out of the static data */
+void memory_report() {
+    char line[128];
+    char* end = debug_append(line, "memory: iwram static ");
+    end = debug_append_number(end, (unsigned int) __bss_end__ - IWRAM_START);
+    end = debug_append(end, " stack high ");
+    end = debug_append_number(end, memory_stack_high());
+    end = debug_append(end, " of ");
+    end = debug_append_number(end, IWRAM_SIZE);
+    end = debug_append(end, ", ewram static ");
+    end = debug_append_number(end, (unsigned int) __sbss_end__ - EWRAM_START);
+    end = debug_append(end, " of ");
+    debug_append_number(end, EWRAM_SIZE);
+    debug_print(line);
+    arena_report(&frame_arena);
+    arena_report(&level_arena);
 }
 
-/* move a sprite in a direction */
-void sprite_move(struct Sprite* sprite, int dx, int dy) {
-    /* get the current y coordinate */
-    int y = sprite->attribute0 & 0xff;
+/* the background tiles that animate */
+struct TileAnimator tile_animator;
+
+/* the tiles of the ground's grass, and the colours its blades are drawn in */
+#define GRASS_TILE_A 5
+#define GRASS_TILE_B 6
+#define GRASS_LIGHT 5
+#define GRASS_DARK 6
+
+/* tiles of the back layer with a star in, the star's colour and the sky's */
+#define STAR_TILE_A 0x22
+#define STAR_TILE_B 0x37
+#define STAR_COLOR 18
+#define SKY_COLOR 1
+
+/* give a tile two frames, its own pixels and a recoloured copy of them made
+ * in the level arena */
+void tile_animation_two_frames(int tile, unsigned char from, unsigned char to,
+        int both_ways, int delay) {
+    const unsigned char* frames[2];
+    frames[0] = background_data + tile * TILE_BYTES;
+    unsigned char* copy = arena_alloc(&level_arena, TILE_BYTES);
+    if (!copy) {
+        return;
+    }
+    tile_anim_recolour(copy, frames[0], from, to, both_ways);
+    frames[1] = copy;
+    tile_animator_add(&tile_animator, tile, frames, 2, delay);
+}
 
-    /* get the current x coordinate */
-    int x = sprite->attribute1 & 0x1ff;
+/* the grass shimmers and the stars twinkle, each star tile on a different
+ * beat so they do not all go out together */
+void setup_tile_animations() {
+    tile_animator_init(&tile_animator, (unsigned char*) char_block(BG_TILES_CHAR_BLOCK));
+    tile_animation_two_frames(GRASS_TILE_A, GRASS_LIGHT, GRASS_DARK, 1, 20);
+    tile_animation_two_frames(GRASS_TILE_B, GRASS_LIGHT, GRASS_DARK, 1, 20);
+    tile_animation_two_frames(STAR_TILE_A, STAR_COLOR, SKY_COLOR, 0, 30);
+    tile_animation_two_frames(STAR_TILE_B, STAR_COLOR, SKY_COLOR, 0, 45);
+}
 
-    /* move to the new location */
-    sprite_position(sprite, x + dx, y + dy);
+/* log how many tiles the animations have copied */
+void tile_animation_report() {
+    char line[128];
+    char* end = debug_append(line, "tile animation: copied ");
+    end = debug_append_number(end, tile_animator.total);
+    end = debug_append(end, " tiles, worst ");
+    end = debug_append_number(end, tile_animator.worst);
+    end = debug_append(end, " a frame, dropped ");
+    debug_append_number(end, tile_animator.dropped);
+    debug_print(line);
 }
 
-/* change the vertical flip flag */
-void sprite_set_vertical_flip(struct Sprite* sprite, int vertical_flip) {
-    if (vertical_flip) {
-        /* set the bit */
-        sprite->attribute1 |= 0x2000;
-    } else {
-        /* clear the bit */
-        sprite->attribute1 &= 0xdfff;
+/* the palettes as they are shown, with their effects on */
+struct Palettes palettes;
+
+/* the two yellows of the background palette, which swap round */
+#define YELLOW_COLOR 19
+#define YELLOW_COUNT 2
+
+/* how hard the dragon's colours flash when he hits something, and for how
+ * many vblanks */
+#define HIT_FLASH_LEVEL 24
+#define HIT_FLASH_VBLANKS 12
+
+/* how far the screen dims when the dragon goes down, leaving the score
+ * readable, and how long it takes */
+#define DEATH_DIM_LEVEL 16
+#define DEATH_DIM_VBLANKS 60
+
+/* take on the palettes the boot copied in, and fade both in from black */
+void setup_palettes() {
+    palettes_init(&palettes, background_palette, (unsigned short*) bg_palette,
+            dragon_palette, (unsigned short*) sprite_palette);
+    palette_cycle_add(&palettes.banks[PALETTE_BG], YELLOW_COLOR, YELLOW_COUNT, 24);
+    for (int b = 0; b < PALETTE_BANKS; b++) {
+        palette_fade(&palettes.banks[b], PALETTE_BLACK, PALETTE_LEVELS, 0);
+        palette_fade(&palettes.banks[b], PALETTE_BLACK, 0, 32);
     }
 }
 
-/* change the vertical flip flag */
-void sprite_set_horizontal_flip(struct Sprite* sprite, int horizontal_flip) {
-    if (horizontal_flip) {
-        /* set the bit */
-        sprite->attribute1 |= 0x1000;
-    } else {
-        /* clear the bit */
-        sprite->attribute1 &= 0xefff;
+/* flash the dragon if an enemy or obstacle hurt him this frame, though not
+ * for a pickup, then work out and queue the palettes that changed */
+void palette_update(const struct Game* g) {
+    if (g->entities.dragon_damage) {
+        palette_flash(&palettes.banks[PALETTE_SPRITES], PALETTE_WHITE, HIT_FLASH_LEVEL, HIT_FLASH_VBLANKS);
     }
+    profile_begin(PROFILE_PALETTE);
+    palettes_update(&palettes, &vblank_queue, &frame_arena);
+    profile_end(PROFILE_PALETTE);
 }
 
-/* change the tile offset of a sprite */
-void sprite_set_offset(struct Sprite* sprite, int offset) {
-    /* clear the old offset */
-    sprite->attribute2 &= 0xfc00;
-
-    /* apply the new one */
-    sprite->attribute2 |= (offset & 0x03ff);
+/* log how many colour words the effects have blended */
+void palette_report() {
+    char line[128];
+    char* end = debug_append(line, "palette: blended ");
+    end = debug_append_number(end, palettes.blended);
+    end = debug_append(end, " words, worst ");
+    end = debug_append_number(end, palettes.worst);
+    end = debug_append(end, " total ");
+    end = debug_append_number(end, palettes.total);
+    end = debug_append(end, ", uploads ");
+    end = debug_append_number(end, palettes.uploads);
+    end = debug_append(end, " dropped ");
+    debug_append_number(end, palettes.dropped);
+    debug_print(line);
 }
 
-/* setup the sprite image and palette */
-void setup_sprite_image() {
-    /* load the palette from the image into palette memory*/
-    memcpy16_dma((unsigned short*) sprite_palette, (unsigned short*) dragon_palette, PALETTE_SIZE);
-
-    /* load the image into char block 0 */
-    memcpy16_dma((unsigned short*) sprite_image_memory, (unsigned short*) dragon_data, (dragon_width * dragon_height) / 2);
+/* the particles take the sprites after the game's, leaving the last one
+ * for the other dragon in link play */
+#define PARTICLE_FIRST_SPRITE (NUM_SPRITES - 1 - PARTICLE_CAPACITY)
+_Static_assert(2 + ENTITY_CAPACITY <= PARTICLE_FIRST_SPRITE,
+        "the particles' sprites run into the game's");
+
+/* the particles, and their tiles as drawn at boot */
+struct Particles particles;
+unsigned char particle_pixels[PARTICLE_TILES_BYTES];
+
+/* how many particles each happening throws out */
+#define FLAP_PUFFS 4
+#define SCORE_SPARKS 8
+#define CRASH_DEBRIS 48
+
+/* draw the particle tiles into sprite VRAM of their own */
+void setup_particles() {
+    int offset = vram_offsets.particles;
+    particle_tiles_build(particle_pixels);
+    memcpy16_dma((unsigned short*) ((unsigned char*) sprite_image_memory + offset),
+            (unsigned short*) particle_pixels, sizeof(particle_pixels) / 2);
+    particles_init(&particles, offset / 32);
+}
 
+/* move the particles on into their stretch of the outgoing sprites */
+void particle_update() {
+    profile_begin(PROFILE_PARTICLES);
+    particles_update(&particles, sprites_out + PARTICLE_FIRST_SPRITE);
+    profile_end(PROFILE_PARTICLES);
 }
 
-/////////////////Dragon
+/* log what the particles cost, in all and for each one */
+void particle_report() {
+    const struct ProfileZone* zone = &profile_zones[PROFILE_PARTICLES];
+    char line[128];
+    char* end = debug_append(line, "particles: alive ");
+    end = debug_append_number(end, particles.count);
+    end = debug_append(end, " high ");
+    end = debug_append_number(end, particles.high);
+    end = debug_append(end, " dropped ");
+    end = debug_append_number(end, particles.dropped);
+    end = debug_append(end, ", cycles a particle last ");
+    end = debug_append_number(end, particles.updated ? zone->last / particles.updated : 0);
+    end = debug_append(end, " avg ");
+    debug_append_number(end, particles.total ? zone->total / particles.total : 0);
+    debug_print(line);
+}
 
-/* a struct for the dragon's logic and behavior */
-struct Dragon {
-    /* the actual sprite attribute info */
-    struct Sprite* sprite;
+/* log each 16K block of VRAM's use and who owns what in it */
+void vram_report() {
+    char line[128];
+    char* end = debug_append(line, "vram: blocks");
+    for (int block = 0; block < 6; block++) {
+        end = debug_append(end, " ");
+        end = debug_append_number(end, vram_block_used(&vram, block));
+    }
+    end = debug_append(end, " bytes, failed ");
+    debug_append_number(end, vram.failures);
+    debug_print(line);
+
+    for (int i = 0; i < VRAM_MAX_RANGES; i++) {
+        const struct VramRange* range = &vram.ranges[i];
+        if (!range->used) {
+            continue;
+        }
+        end = debug_append(line, range->region == VRAM_BG ? "vram bg " : "vram sprites ");
+        end = debug_append(end, range->name);
+        end = debug_append(end, ": ");
+        end = debug_append_number(end, range->first * vram_unit_size(range->region));
+        end = debug_append(end, " to ");
+        debug_append_number(end, (range->first + range->count) * vram_unit_size(range->region));
+        debug_print(line);
+    }
+}
 
-    /* the x and y postion, in 1/256 pixels */
-    int x, y;
+/* the autopilot may spend about a third of each frame searching */
+#define AUTOPILOT_CYCLES (CYCLES_PER_FRAME / 3)
+
+/* the autopilot's tables are too big for the stack or IWRAM, so it goes in
+ * EWRAM */
+EWRAM_BSS struct Autopilot autopilot;
+
+/* the whole game state lives in one block */
+struct Game game;
+
+/* a snapshot of the game, kept in EWRAM */
+EWRAM_BSS struct Game snapshot;
+
+/* time saving, restoring and hashing the game and log the cycles each took */
+void snapshot_benchmark() {
+    unsigned int start = profile_cycles();
+    game_save(&snapshot, &game);
+    unsigned int saved = profile_cycles();
+    game_restore(&game, &snapshot);
+    unsigned int restored = profile_cycles();
+    game_hash(&game);
+    unsigned int hashed = profile_cycles();
+
+    char line[128];
+    char* end = debug_append(line, "snapshot: ");
+    end = debug_append_number(end, sizeof(struct Game));
+    end = debug_append(end, " bytes, save ");
+    end = debug_append_number(end, saved - start);
+    end = debug_append(end, " restore ");
+    end = debug_append_number(end, restored - saved);
+    end = debug_append(end, " hash ");
+    end = debug_append_number(end, hashed - restored);
+    debug_append(end, " cycles");
+    debug_print(line);
+}
 
-    /* the dragon's y velocity in 1/256 pixels/second */
-    int yvel;
+/* log how many entities there are and what the collision pass found */
+void entities_report(const struct Entities* entities) {
+    char line[128];
+    char* end = debug_append(line, "entities: ");
+    end = debug_append_number(end, entities->count);
+    end = debug_append(end, " pairs tested ");
+    end = debug_append_number(end, entities->candidates);
+    end = debug_append(end, " overlapping ");
+    end = debug_append_number(end, entities->overlaps);
+    end = debug_append(end, " of ");
+    debug_append_number(end, entities->count * (entities->count - 1) / 2);
+    debug_print(line);
+}
 
-    /* the dragon's y acceleration in 1/256 pixels/second^2 */
-    int gravity; 
+/* log how the sprite cache and the vblank queue have done */
+void sprite_cache_report() {
+    char line[128];
+    char* end = debug_append(line, "sprite cache: hits ");
+    end = debug_append_number(end, sprite_cache.hits);
+    end = debug_append(end, " misses ");
+    end = debug_append_number(end, sprite_cache.misses);
+    end = debug_append(end, " overflows ");
+    end = debug_append_number(end, sprite_cache.overflows);
+    end = debug_append(end, ", vblank queue high ");
+    end = debug_append_number(end, vblank_queue.high);
+    end = debug_append(end, " words, unaligned ");
+    end = debug_append_number(end, vblank_queue.unaligned);
+    end = debug_append(end, " dropped ");
+    debug_append_number(end, vblank_queue.dropped);
+    debug_print(line);
+}
 
-    /* which frame of the animation he is on */
-    int frame;
+/* a head-to-head match, which is too big for IWRAM */
+EWRAM_BSS struct Netplay netplay;
+
+/* log how the rollbacks have gone */
+void netplay_report() {
+    char line[128];
+    char* end = debug_append(line, "netplay: rollbacks ");
+    end = debug_append_number(end, netplay.rollbacks);
+    end = debug_append(end, " depth ");
+    end = debug_append_number(end, netplay.depth);
+    end = debug_append(end, " worst ");
+    end = debug_append_number(end, netplay.worst_depth);
+    end = debug_append(end, " cycles ");
+    end = debug_append_number(end, netplay.cycles);
+    end = debug_append(end, " worst ");
+    end = debug_append_number(end, netplay.worst_cycles);
+    end = debug_append(end, " stalls ");
+    end = debug_append_number(end, netplay.stalls);
+    end = debug_append(end, " link errors ");
+    debug_append_number(end, link.errors);
+    debug_print(line);
+}
 
-    /* the number of frames to wait before flipping */
-    int animation_delay;
+/* play head-to-head over the link cable until both dragons are down, then
+ * leave our own game in the global one for the end screen */
+void link_play() {
+    /* wait for the other console to turn up */
+    link_init();
+    while (!link_connected()) {
+        wait_vblank();
+    }
+    netplay_init(&netplay, link.player & 1, &link_transport, &ground_tilemap);
+    netplay.clock = profile_cycles;
+
+    struct Game* local = &netplay.match.players[netplay.local];
+    struct Game* remote = &netplay.match.players[!netplay.local];
+    while (!netplay_over(&netplay)) {
+        arena_reset(&frame_arena);
+        unsigned short keys = input.pressed & BUTTON_A;
+
+        /* step the match, rolling back first if a guess was wrong */
+        profile_begin(PROFILE_NETPLAY);
+        netplay_update(&netplay, keys);
+        profile_end(PROFILE_NETPLAY);
+
+        /* our own game's sprites, with the other dragon in the last one */
+        sprite_cache_stream(&sprite_cache, &local->oam, sprites_out, &vblank_queue);
+        const struct Sprite* other = &remote->oam.sprites[remote->dragon.sprite];
+        struct Sprite* slot = &sprites_out[NUM_SPRITES - 1];
+        *slot = *other;
+        if (!sprite_hidden(other)) {
+            int tile = sprite_cache_tile(&sprite_cache, other->attribute2 & 0x3ff, 1, &vblank_queue);
+            if (tile < 0) {
+                slot->attribute0 = SCREEN_HEIGHT;
+            } else {
+                slot->attribute2 = (other->attribute2 & 0xfc00) | tile;
+            }
+        }
 
-    /* the animation counter counts how many frames until we flip */
-    int counter;
+        tile_animator_update(&tile_animator, &vblank_queue);
+        palette_update(local);
 
-    /* whether the dragon is moving right now or not */
-    int move;
+        /* kick off this frame's transfer and draw our own game */
+        wait_vblank();
+        link_service();
+        dma_queue_flush(&vblank_queue);
+        *bg0_x_scroll = local->xscroll * 1.2;
+        *bg1_x_scroll = local->xscroll;
+        sprite_update_all(sprites_out);
+        input_committed();
+
+        /* read the keys for the next frame */
+        input_latch();
+
+        profile_frame();
+        if ((profile_frames & 63) == 0) {
+            profile_report();
+            netplay_report();
+            input_report();
+            memory_report();
+            sprite_cache_report();
+            tile_animation_report();
+            palette_report();
+        }
+    }
 
-    /* the number of pixels away from the edge of the screen the dragon stays */
-    int border;
+    /* the parent starts every transfer, so it keeps them going until our
+     * last keys are out, for the other console to finish on */
+    while (link.player == 0 && (link.loaded || link.out_head != link.out_tail)) {
+        wait_vblank();
+        link_service();
+    }
+    game = *local;
+}
 
-    /* if the dragon is currently falling */
-    int falling;
+/* the long level single player flies, packed in ROM */
+const struct Level level1 = {level1_data, level1_index, level1_width};
 
-    /* if the dragon is alive */
-    int alive;
-};
+/* the columns of it around the screen, which the dragon collides against.
+ * 4K is a lot of IWRAM, and a frame only reads a few tiles of it */
+EWRAM_BSS struct LevelStreamer level_streamer;
 
-/* initialize the dragon */
-void dragon_init(struct Dragon* dragon) {
-    dragon->x = 40 << 8;
-    dragon->y = 40 << 8;
-    dragon->yvel = 0;
-    dragon->gravity = 40;
-    dragon->border = 40;
-    dragon->frame = 0;
-    dragon->move = 1;
-    dragon->counter = 0;
-    dragon->falling = 0;
-    dragon->alive = 1;
-    dragon->animation_delay = 8;
-    dragon->sprite = sprite_init(dragon->x >> 8, dragon->y >> 8, SIZE_16_16, 0, 0, dragon->frame, 0);
-}
-
-/* move the dragon left or right returns if it is at edge of the screen */
-int dragon_left(struct Dragon* dragon) {
-    /* face left */
-    sprite_set_horizontal_flip(dragon->sprite, 1);
-    dragon->move = 1;
-
-    /* if we are at the left end, just scroll the screen */
-    if ((dragon->x >> 8) < dragon->border) {
-        return 1;
-    } else {
-        /* else move left */
-        dragon->x -= 256;
-        return 0;
-    }
+/* start streaming the level in, and have the game collide against it */
+void setup_level() {
+    level_streamer_init(&level_streamer, &level1, screen_block(GROUND_SCREEN_BLOCK), &game);
 }
-int dragon_right(struct Dragon* dragon) {
-    /* face right */
-    sprite_set_horizontal_flip(dragon->sprite, 0);
-    dragon->move = 1;
 
-    /* if we are at the right end, just scroll the screen */
-    if ((dragon->x >> 8) > (SCREEN_WIDTH - 16 - dragon->border)) {
-        return 1;
-    } else {
-        /* else move right */
-        dragon->x += 256;
-        return 0;
-    }
+/* log how much of the level has been unpacked */
+void level_report() {
+    char line[128];
+    char* end = debug_append(line, "level: column ");
+    end = debug_append_number(end, level_streamer.next);
+    end = debug_append(end, " unpacked ");
+    end = debug_append_number(end, level_streamer.total);
+    end = debug_append(end, " columns, worst ");
+    end = debug_append_number(end, level_streamer.worst);
+    end = debug_append(end, " a frame, ");
+    end = debug_append_number(end, level_streamer.bytes);
+    end = debug_append(end, " bytes, late ");
+    debug_append_number(end, level_streamer.late);
+    debug_print(line);
 }
 
-/* stop the dragon from walking left/right */
-void dragon_stop(struct Dragon* dragon) {
-    dragon->move = 0;
-    dragon->frame = 0;
-    dragon->counter = 7;
-    sprite_set_offset(dragon->sprite, dragon->frame);
+/* the ghost takes the last sprite, which only link play uses otherwise */
+#define GHOST_SPRITE (NUM_SPRITES - 1)
+
+/* how much of the ghost and of what is under him shows, out of 16 */
+#define GHOST_ALPHA 7
+#define GHOST_UNDER 9
+
+/* the best run and this one, which with their keys packed is too big for
+ * IWRAM */
+EWRAM_BSS struct Ghost ghost;
+
+/* load the best run and have see-through sprites blend with the
+ * backgrounds */
+void setup_ghost() {
+    ghost_init(&ghost, save_memory);
+#ifdef PHLAPU_BENCH
+    /* the benchmark costs the same whatever is saved */
+    ghost.showing = 0;
+#endif
+    *blend_control = BLEND_BG0_UNDER | BLEND_BG1_UNDER | BLEND_BACKDROP_UNDER;
+    *blend_alpha = GHOST_ALPHA | (GHOST_UNDER << 8);
 }
 
-/* flap */
-void flap(struct Dragon* dragon) {
-        dragon->frame = 0;
-        dragon->yvel -= 1500;
-        dragon->y -= 40;
+/* log what the ghost costs next to the dragon's own step, and how saving
+ * this run has gone */
+void ghost_report() {
+    const struct ProfileZone* zone = &profile_zones[PROFILE_GHOST];
+    char line[128];
+    char* end = debug_append(line, "ghost: played ");
+    end = debug_append_number(end, ghost.played);
+    end = debug_append(end, " of ");
+    end = debug_append_number(end, ghost.play_frames);
+    end = debug_append(end, " cycles last ");
+    end = debug_append_number(end, zone->last);
+    end = debug_append(end, " worst ");
+    end = debug_append_number(end, zone->worst);
+    end = debug_append(end, ", dragon_update last ");
+    debug_append_number(end, profile_zones[PROFILE_DRAGON_UPDATE].last);
+    debug_print(line);
+
+    end = debug_append(line, "ghost save: state ");
+    end = debug_append_number(end, ghost.state);
+    end = debug_append(end, " frames ");
+    end = debug_append_number(end, ghost.frames);
+    end = debug_append(end, " sram bytes ");
+    end = debug_append_number(end, ghost.bytes);
+    end = debug_append(end, " slices ");
+    end = debug_append_number(end, ghost.slices);
+    end = debug_append(end, " worst ");
+    end = debug_append_number(end, ghost.worst);
+    end = debug_append(end, ", best ");
+    debug_append_number(end, ghost.best.total);
+    debug_print(line);
 }
 
-/* finds which tile a screen coordinate maps to, taking scroll into account */
-unsigned short tile_lookup(int x, int y, int xscroll, int yscroll,
-        const unsigned short* tilemap, int tilemap_w, int tilemap_h) {
-
-    /* adjust for the scroll */
-    x += xscroll;
-    y += yscroll;
+/* the two tables of affine lines. the DMA reads a line of one each HBlank
+ * and it is only used on the title and end screens, so it goes in EWRAM */
+EWRAM_BSS struct AffineTable affine_table;
+
+/* put the score page on background 2 as an affine layer, in mode 1 over
+ * the layers given. it is not shown until the first table is */
+void affine_start(unsigned long layers) {
+    affine_init(&affine_table);
+    *bg2_control = 0 |    /* priority, 0 is highest, 3 is lowest */
+        (BG_TILES_CHAR_BLOCK << 2) | /* the char block the image data is stored in */
+        (AFFINE_SCREEN_BLOCK << 8) | /* the screen block the tile data is stored in */
+        (0 << 13) |       /* wrapping flag, off so the page has edges */
+        (1 << 14);        /* bg size, 1 is 256x256 for an affine layer */
+    *display_control = MODE1 | layers | SPRITE_ENABLE | SPRITE_MAP_1D;
+}
 
-    /* convert from screen coordinates to tile coordinates */
-    x >>= 3;
-    y >>= 3;
+/* time building a frame's table */
+void affine_update(const struct AffineView* view) {
+    profile_begin(PROFILE_AFFINE);
+    affine_build(&affine_table, view);
+    profile_end(PROFILE_AFFINE);
+}
 
-    /* account for wraparound */
-    while (x >= tilemap_w) {
-        x -= tilemap_w;
-    }
-    while (y >= tilemap_h) {
-        y -= tilemap_h;
-    }
-    while (x < 0) {
-        x += tilemap_w;
+/* in vblank: show the newest table, setting the first line's registers
+ * now and having DMA 0 set each line after it in the HBlank before */
+void affine_show() {
+    const struct AffineLine* lines = affine_flip(&affine_table);
+    const unsigned int* first = (const unsigned int*) lines;
+    *dma0_count = 0;
+    for (int i = 0; i < 4; i++) {
+        bg2_affine[i] = first[i];
     }
-    while (y < 0) {
-        y += tilemap_h;
-    }
-
-    /* lookup this tile from the map */
-    int index = y * tilemap_w + x;
-
-    /* return the tile */
-    return tilemap[index];
+    *dma0_source = (unsigned int) (lines + 1);
+    *dma0_destination = (unsigned int) bg2_affine;
+    *dma0_count = 4 | DMA_32 | DMA_DEST_RELOAD | DMA_REPEAT | DMA_AT_HBLANK | DMA_ENABLE;
+    *display_control |= BG2_ENABLE;
 }
 
-/* function to set text on the screen at a given location */
-void set_text(char* str, int row, int col) {                    
-    /* find the index in the texmap to draw to */
-    int index = row * 32 + col;
-
-    /* the first 32 characters are missing from the map (controls etc.) */
-    int missing = 32; 
+/* stop the DMA and go back to the text layers the game is played on */
+void affine_stop() {
+    *dma0_count = 0;
+    *display_control = MODE0 | BG0_ENABLE | BG1_ENABLE | SPRITE_ENABLE | SPRITE_MAP_1D;
+}
 
-    /* pointer to text map */
-    volatile unsigned short* ptr = screen_block(26);
+/* log what building the tables costs, which is all the CPU does for them */
+void affine_report() {
+    const struct ProfileZone* zone = &profile_zones[PROFILE_AFFINE];
+    char line[128];
+    char* end = debug_append(line, "affine: built ");
+    end = debug_append_number(end, affine_table.builds);
+    end = debug_append(end, " skipped ");
+    end = debug_append_number(end, affine_table.skips);
+    end = debug_append(end, " cycles last ");
+    end = debug_append_number(end, zone->last);
+    end = debug_append(end, " worst ");
+    end = debug_append_number(end, zone->worst);
+    end = debug_append(end, ", ");
+    end = debug_append_number(end, zone->worst / AFFINE_LINES);
+    debug_append(end, " a line");
+    debug_print(line);
+}
 
-    /* for each character */
-    while (*str) {
-        /* place this character in the map */
-        ptr[index] = *str - missing;
+/* turn the score page round as a title until A or start is pressed */
+void title_screen() {
+    struct AffineView view;
+    affine_start(BG0_ENABLE);
+    for (int frame = 0; !(input.pressed & (BUTTON_A | BUTTON_START)); frame++) {
+        affine_title_view(&view, frame);
+        affine_update(&view);
+        wait_vblank();
+        affine_show();
+        input_committed();
+        input_latch();
+
+        profile_frame();
+        if ((profile_frames & 63) == 0) {
+            profile_report();
+            affine_report();
+        }
+    }
+    affine_stop();
 
-        /* move onto the next character */
-        index++;
-        str++;
-    }   
+    /* the press that started the game is not a flap */
+    input_committed();
+    input_latch();
 }
 
-/* declaration of assembly function to uppercase a string */
-void uppercase(char* s);
+/* the single player frame, as tasks */
+struct Scheduler scheduler;
 
+/* whether the autopilot has the dragon */
+int autopiloting = 0;
 
-/////////////SCORE
-/* a struct for the dragon's logic and behavior */
-struct Score {
-    /* the actual sprite attribute info */
-    struct Sprite* sprite;
+/* the keys the game was stepped with this frame, and the score it had
+ * before, for the particles to go by */
+unsigned short frame_keys = 0;
+int last_total = 0;
+int last_alive = 1;
 
-    /* the x and y postion, in 1/256 pixels */
-    int x, y;
+/* read the keys or ask the autopilot, and step the game */
+int task_game(void* data) {
+    (void) data;
+    /* select hands the dragon over to the autopilot and back */
+    if (input.pressed & BUTTON_SELECT) {
+        autopiloting = !autopiloting;
+    }
 
-    /* which frame of the animation he is on */
-    int frame;
+    /* flap when A goes down, or when the autopilot says so */
+    unsigned short keys = input.pressed & BUTTON_A;
+    if (autopiloting) {
+        profile_begin(PROFILE_AUTOPILOT);
+        keys = autopilot_decide(&autopilot, &game) ? BUTTON_A : 0;
+        profile_end(PROFILE_AUTOPILOT);
+    }
+#ifdef PHLAPU_BENCH
+    keys = bench_keys[game.frames];
+#endif
+
+    /* update the dragon and the score */
+    profile_begin(PROFILE_GAME_STEP);
+    game_step(&game, keys);
+    profile_end(PROFILE_GAME_STEP);
+    frame_keys = keys;
+    return 0;
+}
 
-    /* the number of frames to wait before flipping */
-    int animation_delay;
+/* unpack the level columns coming up. the autopilot's steering goes by
+ * the columns in the ring, so it has to look at them again */
+int task_level(void* data) {
+    (void) data;
+    profile_begin(PROFILE_LEVEL_STREAM);
+    if (level_streamer_update(&level_streamer, &game)) {
+        autopilot.steer_map = 0;
+    }
+    profile_end(PROFILE_LEVEL_STREAM);
+    return 0;
+}
 
-    /* the animation counter counts how many frames until we flip */
-    int counter;
+/* point the sprites at the cached frames, queueing any uploads */
+int task_sprites(void* data) {
+    (void) data;
+    profile_begin(PROFILE_SPRITE_CACHE);
+    sprite_cache_stream(&sprite_cache, &game.oam, sprites_out, &vblank_queue);
+    profile_end(PROFILE_SPRITE_CACHE);
+    return 0;
+}
 
-    /* the number of pixels away from the edge of the screen the dragon stays */
-    int border;
+/* queue the background tiles whose frame changes this vblank, and the
+ * palettes */
+int task_effects(void* data) {
+    (void) data;
+    tile_animator_update(&tile_animator, &vblank_queue);
+    palette_update(&game);
+    return 0;
+}
 
-    /* total score */
-    int total;
+/* puff when the dragon flaps, sparkle when the score goes up and break up
+ * when he goes down, then move the particles on */
+int task_particles(void* data) {
+    (void) data;
+    int x = game.dragon.x >> 8, y = game.dragon.y >> 8;
+    if (!game.dragon.alive) {
+        if (last_alive) {
+            particles_burst(&particles, PARTICLE_DEBRIS, x + 4, y + 4, CRASH_DEBRIS);
+        }
+    } else if (frame_keys & BUTTON_A) {
+        particles_burst(&particles, PARTICLE_PUFF, x - 4, y + 6, FLAP_PUFFS);
+    }
+    if (game.score.total > last_total) {
+        particles_burst(&particles, PARTICLE_SPARK, game.score.x >> 8, game.score.y >> 8, SCORE_SPARKS);
+    }
+    last_total = game.score.total;
+    last_alive = game.dragon.alive;
+    particle_update();
+    return 0;
+}
 
-    /* lap number */
-    int lap;
+/* the background task that writes the run out to SRAM, so it can be woken */
+int ghost_save_task;
+
+/* the frames of this run recorded so far */
+int ghost_recorded = 0;
+
+/* record the keys the game stepped with and fly the ghost the same frame,
+ * keep the run if it is the best once the dragon is down, and put the
+ * ghost in his sprite see-through */
+int task_ghost(void* data) {
+    (void) data;
+    if (game.frames > ghost_recorded) {
+        ghost_recorded = game.frames;
+        if (ghost_record(&ghost, frame_keys)) {
+            scheduler_wake(&scheduler, ghost_save_task);
+        }
+        profile_begin(PROFILE_GHOST);
+        ghost_step(&ghost, game.xscroll, game.ground);
+        profile_end(PROFILE_GHOST);
+    }
+    if (!game.dragon.alive && ghost_finish(&ghost, game.score.total)) {
+        scheduler_wake(&scheduler, ghost_save_task);
+    }
 
-};
+    struct Sprite* slot = &sprites_out[GHOST_SPRITE];
+    slot->attribute0 = SCREEN_HEIGHT;
+    const struct Sprite* flier = ghost_sprite(&ghost);
+    if (flier && game.dragon.alive && !sprite_hidden(flier)) {
+        int tile = sprite_cache_tile(&sprite_cache, flier->attribute2 & 0x3ff, 1, &vblank_queue);
+        if (tile >= 0) {
+            *slot = *flier;
+            slot->attribute0 |= SPRITE_SEMI_TRANSPARENT;
+            slot->attribute2 = (flier->attribute2 & 0xfc00) | tile;
+        }
+    }
+    return 0;
+}
 
-/* initialize the score */
-void score_init(struct Score* score) {
-    score->x = 116 << 8;
-    score->y = 30 << 8;
-    score->border = 110;
-    score->frame = 24;
-    score->counter = 0;
-    score->animation_delay = 8;
-    score->sprite = sprite_init(score->x >> 8, score->y >> 8, SIZE_8_8, 0, 0, score->frame, 0);
+/* write a slice of the run to SRAM */
+int task_ghost_save(void* data) {
+    (void) data;
+    return ghost_save(&ghost);
 }
 
-////////////Sprite Updates
+/* upload, scroll and move the sprites while the screen is not drawing */
+int task_video(void* data) {
+    (void) data;
+    dma_queue_flush(&vblank_queue);
+    level_streamer_commit(&level_streamer, screen_block(GROUND_SCREEN_BLOCK));
+    *bg0_x_scroll = game.xscroll * 1.2;
+    *bg1_x_scroll = game.xscroll;
+    sprite_update_all(sprites_out);
+    return 0;
+}
 
+/* note the frame's presses as acted on, and read the keys for the next
+ * frame at the same point in every frame, so a press is always acted on in
+ * the frame after it is seen */
+int task_input(void* data) {
+    (void) data;
+    input_committed();
+    input_latch();
+    return 0;
+}
 
-void score_update(struct Score* score, struct Dragon* dragon, int xscroll){
-    /*check if dragon has passed key tile*/
-   // unsigned short begin = tile_lookup((dragon->x >> 8)+8, 0, xscroll, 0, groundlayermap, groundlayermap_width, groundlayermap_height);
-    unsigned short above = tile_lookup((dragon->x >> 8)-1,0,xscroll,0,groundlayermap,groundlayermap_width,groundlayermap_height);
-    unsigned short passed = 0;
-    if(above == 11){
-        passed = 1;
-    }
-    if(passed == 1){
-        score->counter++;
-        if (score->counter >= score->animation_delay) {
-            score->frame += 1;
-            score->total += 1;
-            score->lap = (score->total/3)+1;
-            if (score->frame > 45) {
-                score->frame = 24;
-            }
-            sprite_set_offset(score->sprite, score->frame);
-            score->counter = 0;
-        }
+/* log how each task has done against its deadline */
+void scheduler_report() {
+    char line[128];
+    char* end = debug_append(line, "scheduler: misses ");
+    end = debug_append_number(end, scheduler.misses);
+    end = debug_append(end, " idle ");
+    end = debug_append_number(end, scheduler.idle);
+    end = debug_append(end, " deferred ");
+    debug_append_number(end, scheduler.deferred);
+    debug_print(line);
+    for (int i = 0; i < scheduler.count; i++) {
+        const struct Task* task = &scheduler.tasks[i];
+        end = debug_append(line, "  ");
+        end = debug_append(end, task->name);
+        end = debug_append(end, ": runs ");
+        end = debug_append_number(end, task->runs);
+        end = debug_append(end, " last ");
+        end = debug_append_number(end, task->last);
+        end = debug_append(end, " worst ");
+        end = debug_append_number(end, task->worst);
+        end = debug_append(end, " deadline ");
+        end = debug_append_number(end, task->deadline);
+        end = debug_append(end, " misses ");
+        debug_append_number(end, task->misses);
+        debug_print(line);
     }
 }
 
-//accelerate Assembly function
-void accelerate(int y, int yvel, int grav);
+void game_entities_report() {
+    entities_report(&game.entities);
+}
 
-//gameScore Assembly function
-int gameScore(int total, int lap);
+/* the reports logged every 64 frames, one a slice, so a frame with no time
+ * to spare puts the rest off to the next */
+void (*const reports[])() = {
+    profile_report,
+    game_entities_report,
+    input_report,
+    memory_report,
+    sprite_cache_report,
+    tile_animation_report,
+    palette_report,
+    particle_report,
+    level_report,
+    ghost_report,
+    scheduler_report,
+};
+#define REPORTS ((int) (sizeof(reports) / sizeof(reports[0])))
+int next_report = 0;
 
-/* update the dragon */
-void dragon_update(struct Dragon* dragon, struct Score* score, int xscroll) {
-    /* update y position and speed if falling */
-    if (dragon->falling) {
-        accelerate(dragon->y,dragon->yvel,dragon->gravity);
-        //dragon->y += dragon->yvel;
-        //dragon->yvel += dragon->gravity;
+int task_reports(void* data) {
+    (void) data;
+    reports[next_report++]();
+    if (next_report < REPORTS) {
+        return 1;
     }
+    next_report = 0;
+    return 0;
+}
 
-    /* check which tile the dragon's feet are over */
-    unsigned short below = tile_lookup((dragon->x >> 8) + 8, (dragon->y >> 8) + 16, xscroll, 0, groundlayermap, groundlayermap_width, groundlayermap_height);
-    /* top right of dragon */
-    unsigned short topRight = tile_lookup((dragon->x >> 8)+13,(dragon->y >> 8), xscroll, 0, groundlayermap, groundlayermap_width,groundlayermap_height);
-    /* right of dragon */
-    unsigned short right = tile_lookup((dragon->x>>8)+16,(dragon->y >> 8) + 8, xscroll, 0, groundlayermap, groundlayermap_width, groundlayermap_height);
-    /* bottom right */
-    unsigned short botRight = tile_lookup((dragon->x>>8)+15,(dragon->y >>8)+15, xscroll, 0, groundlayermap, groundlayermap_width, groundlayermap_height);
-    //dragon stops if he runs into a block (2,3,4,5,12,13,14,15)
-    unsigned short above = tile_lookup((dragon->x>>8)+8,(dragon->y>>8),xscroll,0,groundlayermap,groundlayermap_width,groundlayermap_height);
-    /* if it's block tile
-     * these numbers refer to the tile indices of the blocks the dragon can walk on */
-    
-    dragon->falling = 1;
-        dragon->move = 1;
+/* the report task, so it can be woken */
+int reports_task;
+
+/* put the frame's work on the scheduler */
+void setup_scheduler() {
+    scheduler_init(&scheduler, profile_cycles);
+    scheduler_add(&scheduler, "video", TASK_VBLANK, 1, 0, task_video, 0);
+    scheduler_add(&scheduler, "input", TASK_VBLANK, 0, 0, task_input, 0);
+    scheduler_add(&scheduler, "game", TASK_FRAME, 3, 0, task_game, 0);
+    scheduler_add(&scheduler, "level", TASK_FRAME, 2, 0, task_level, 0);
+    scheduler_add(&scheduler, "sprites", TASK_FRAME, 1, 0, task_sprites, 0);
+    scheduler_add(&scheduler, "effects", TASK_FRAME, 0, 0, task_effects, 0);
+    scheduler_add(&scheduler, "particles", TASK_FRAME, 0, 0, task_particles, 0);
+    scheduler_add(&scheduler, "ghost", TASK_FRAME, 0, 0, task_ghost, 0);
+    ghost_save_task = scheduler_add(&scheduler, "ghost save", TASK_BACKGROUND, 1, 0, task_ghost_save, 0);
+    reports_task = scheduler_add(&scheduler, "reports", TASK_BACKGROUND, 0, 0, task_reports, 0);
+}
 
-    if(dragon->x == 240){
-        dragon->alive = 0;
-    }
-    if((above == 21) || 
-        (above >= 1 && above <= 6) ||
-        (above >= 12 && above <= 17)){
-        dragon->alive = 0;
-    }
-    else if((right == 21) ||
-        (right >= 1 && right <= 6) ||
-        (right >= 12 && right <= 17)) {
-        dragon->alive = 0;
-    }
-    else if((topRight == 21) ||
-            (topRight >= 1 && topRight <= 6) ||
-            (topRight >= 12 && topRight <= 17)){
-        dragon->alive = 0;
-    }
-    else if ((botRight == 21) ||
-             (botRight >= 1 && botRight <= 6) ||
-             (botRight >= 12 && botRight <= 17)){
-        dragon->alive = 0;
-    }
-    else if((below == 21) ||
-            (below >= 1 && below <= 6) ||
-            (below >= 12 && below <= 17)){
-        dragon->alive = 0;
-    }
-    /*
-    else {
-        /* he is falling now */
-        //dragon->falling = 1;
-      //  dragon->move = 1;
-    //}
-
-    //if collided = 1
-    if(dragon->alive == 0){
-        dragon->x = 240;
-        dragon->y = 160;
-        score->x = 120;
-        score->y = 40;
-        sprite_position(dragon->sprite,240, 160);
-        sprite_position(score->sprite,240,160);
-        //*display_control |= BG2_ENABLE;
-        dragon->yvel = 0;
-        dragon->falling = 0;
-    }
-    else{
-        /* update animation if moving */
-        if (dragon->move) {
-            dragon->counter++;
-            if (dragon->counter >= dragon->animation_delay) {
-                dragon->frame += 1;
-                if (dragon->frame > 16) {
-                    dragon->frame = 0;
-                }
-                sprite_set_offset(dragon->sprite, dragon->frame);
-                dragon->counter = 0;
-            }
-        }
-        /* set on screen position */
-        sprite_position(dragon->sprite, dragon->x >> 8, dragon->y >> 8);
+#ifdef PHLAPU_BENCH
+/* end a benchmark run: log the zones one last time, say so, and stop */
+void bench_finish() {
+    profile_report();
+    debug_print(BENCH_DONE);
+    while (1) {
+        wait_vblank();
     }
 }
-
+#endif
 
 /* the main function */
 int main( ) {
+    /* paint the stack before anything goes deep into it */
+    memory_paint_stack();
+    memory_init();
+
+    /* start counting cycles, so the setup is timed too */
+    profile_init();
+
     /* we set the mode to mode 0 with bg0 on */
     *display_control = MODE0 | BG0_ENABLE | BG1_ENABLE |SPRITE_ENABLE | SPRITE_MAP_1D;
 
     /* setup the background 0 */
+    vram_init(&vram);
+    vram_layout(&vram, &vram_offsets);
+    dma_queue_init(&vblank_queue);
+    profile_begin(PROFILE_SETUP_BACKGROUND);
     setup_background();
+    profile_end(PROFILE_SETUP_BACKGROUND);
 
     /* setup the sprite image data */
     setup_sprite_image();
-
-    /* clear all the sprites on screen now */
-    sprite_clear();
-
-    /* create the dragon */
-    struct Dragon dragon;
-    dragon_init(&dragon);
-
-    /* create the score */
-    struct Score score;
-    score_init(&score);
-
-    /* set initial scroll to 1 */
-    int xscroll = 1;
+    setup_particles();
+
+    /* clear the sprites and create the dragon and the score, with nothing
+     * left over from another level */
+    arena_reset(&level_arena);
+    tilemap_columns(&ground_tilemap);
+    game_init(&game, &ground_tilemap);
+    setup_tile_animations();
+    setup_palettes();
+
+    /* get the autopilot ready */
+    vram_report();
+    snapshot_benchmark();
+    autopilot_init(&autopilot, 0);
+    autopilot.clock = profile_cycles;
+    autopilot.cycle_budget = AUTOPILOT_CYCLES;
+
+    /* stamp presses of A with the keypad interrupt, and read the keys once
+     * before the first frame */
+    input_init(BUTTON_A);
+    input_latch();
+
+#ifndef PHLAPU_BENCH
+    title_screen();
+#endif
+
+    /* hold L while pressing A or start on the title to play head-to-head
+     * over the link cable. the title latches the keys as it ends, so held
+     * is what was down on that press */
+    if (input.held & BUTTON_L) {
+        link_play();
+    }
 
     /* loop forever */
-    while (dragon.alive) {
-        /*scroll continuously*/
-        xscroll++;
-
-        /* update the dragon */
-        dragon_update(&dragon, &score, xscroll);
-        /* update the score */
-        score_update(&score, &dragon, xscroll);
-
-        /* check if they're flapping*/
-        if (button_pressed(BUTTON_A)) {
-            flap(&dragon);
-        }
-        /* wait for vblank before scrolling and moving sprites */
+    setup_level();
+    setup_ghost();
+    setup_scheduler();
+    while (game.dragon.alive) {
+        /* last frame's scratch is free again */
+        arena_reset(&frame_arena);
+
+        /* step the game and queue what changed, then spend what is left of
+         * the frame on background work */
+        scheduler_frame(&scheduler);
+
+        /* wait for vblank before uploading, scrolling and moving sprites */
         wait_vblank();
-        *bg0_x_scroll = xscroll * 1.2;
-        *bg1_x_scroll = xscroll;
-        sprite_update_all();
+        scheduler_vblank(&scheduler);
 
-        /* delay some */
-        delay(300);
+        /* log the cycle counts every second or so, in the frames' spare
+         * time */
+        profile_frame();
+        if ((profile_frames & 63) == 0) {
+            scheduler_wake(&scheduler, reports_task);
+        }
+#ifdef PHLAPU_BENCH
+        if (game.frames >= bench_frames) {
+            break;
+        }
+#endif
     }
+#ifdef PHLAPU_BENCH
+    bench_finish();
+#endif
     
 
-    while(dragon.alive == 0){
-        *display_control |= BG2_ENABLE;
-        dragon.x = 240;
-        dragon.y = 160;
-        score.x = 120;
-        score.y = 40;
+    /* dim everything behind the score */
+    for (int b = 0; b < PALETTE_BANKS; b++) {
+        palette_fade(&palettes.banks[b], PALETTE_BLACK, DEATH_DIM_LEVEL, DEATH_DIM_VBLANKS);
+    }
+
+    /* zoom the score page in over the game */
+    struct AffineView view;
+    affine_start(BG0_ENABLE | BG1_ENABLE);
+    int end_frame = 0;
+
+    while(game.dragon.alive == 0){
+        arena_reset(&frame_arena);
+        palette_update(&game);
+        particle_update();
+        affine_zoom_view(&view, end_frame++);
+        affine_update(&view);
+
+        /* finish saving the run in the time the end screen leaves */
+        scheduler_background(&scheduler);
+        wait_vblank();
+        scheduler_vblank(&scheduler);
+        affine_show();
+        profile_frame();
+        if ((profile_frames & 63) == 0) {
+            affine_report();
+        }
+        game.dragon.x = 240;
+        game.dragon.y = 160;
+        game.score.x = 120;
+        game.score.y = 40;
         //char grats[16] = "Score: ";
         //char youScored[12] = "you scored: ";
         //uppercase(grats);
         //uppercase(youScored);
-        //int playerScore = gameScore(score.total,score.lap);
+        //int playerScore = gameScore(game.score.total,game.score.lap);
         //int printX = 60;
         //set_text(grats, printX, 60);
         //set_text(youScored, printX, 90);     
@@ -772,7 +1327,8 @@ void interrupt_ignore( ) {
 }
 
 /* this table specifies which interrupts we handle which way
- * for now, we ignore all of them */
+ * for now, we only handle the serial one for the link cable, and the
+ * keypad one for timing presses */
 typedef void (*intrp)( );
 const intrp IntrTable[13] = {
     interrupt_ignore,   /* V Blank interrupt */
@@ -782,11 +1338,11 @@ const intrp IntrTable[13] = {
     interrupt_ignore,   /* Timer 1 interrupt */
     interrupt_ignore,   /* Timer 2 interrupt */
     interrupt_ignore,   /* Timer 3 interrupt */
-    interrupt_ignore,   /* Serial communication interrupt */
+    link_interrupt,     /* Serial communication interrupt */
     interrupt_ignore,   /* DMA 0 interrupt */
     interrupt_ignore,   /* DMA 1 interrupt */
     interrupt_ignore,   /* DMA 2 interrupt */
     interrupt_ignore,   /* DMA 3 interrupt */
-    interrupt_ignore,   /* Key interrupt */
+    input_interrupt,    /* Key interrupt */
 };
 
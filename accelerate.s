@@ -1,14 +1,18 @@
 @ accelerate.s
 
 /* function to alter dragon position, velocity, and gravity relative to one another */
-/* given 	r0: dragon->y */
-			/*r1: dragon->yvel*/ 
+/* given 	r0: &dragon->y */
+			/*r1: &dragon->yvel*/ 
 			/*r2: dragon->gravity	*/
 
 .global accelerate
 accelerate:
-	add r0,r0,r1		/*y += yvel*/
-	add r1,r1,r2		/*yvel += gravity*/
+	ldr r3,[r0]			/*load y*/
+	ldr r12,[r1]		/*load yvel*/
+	add r3,r3,r12		/*y += yvel*/
+	add r12,r12,r2		/*yvel += gravity*/
+	str r3,[r0]			/*store y back into the dragon*/
+	str r12,[r1]		/*store yvel back into the dragon*/
 	mov pc, lr			
 
 /* function to  calculate score of player */
@@ -0,0 +1,243 @@
+/* affine.h
+ * zooming and turning a background a scanline at a time, for the title and
+ * the end screen.
+ *
+ * in mode 1 background 2 is an affine layer: the hardware walks its map
+ * along a line of the screen by the matrix's pa and pc for each pixel, from
+ * the point in BG2X and BG2Y. writing those six registers between lines
+ * gives every line a matrix of its own, so the layer can ripple as well as
+ * zoom and turn. a line's registers are laid out in an AffineLine just as
+ * they are in memory, and an HBlank DMA copies the next line's into place
+ * as each line finishes, so once a table is built the frame costs the CPU
+ * nothing more.
+ *
+ * a table is built from an AffineView: a turn, a scale and a ripple in the
+ * scale that runs down the screen. there is no divide or floating point on
+ * the GBA, so the turn goes through a table of sines, and the scale is the
+ * texels a screen pixel covers rather than the zoom, which needs only
+ * multiplies. without a ripple every line has the same matrix and each
+ * line's start is the last one's plus pb and pd.
+ *
+ * there are two tables, one the DMA is reading and one being built, and a
+ * view the same as a table was last built from is not built again, so a
+ * screen that has stopped moving costs nothing at all. the build runs from
+ * IWRAM as ARM code.
+ *
+ * nothing in here touches the hardware, so the host tools can use it too.
+ * this needs memory.h for the IWRAM section */
+
+/* a line for every one on the screen, and one more for the HBlank after
+ * the last, which the DMA copies before vblank stops it */
+#define AFFINE_LINES (SCREEN_HEIGHT + 1)
+
+/* 1 in the matrix, which is 8.8 fixed point, and in the sines, 4.12 */
+#define AFFINE_ONE 256
+#define AFFINE_SINE_SHIFT 12
+
+/* angles go round in 256 steps */
+#define AFFINE_TURN 256
+
+/* how far round the ripple goes from one line to the next */
+#define AFFINE_RIPPLE_STEP 3
+
+/* the frames the end screen takes to zoom in, and how much smaller it
+ * starts, as a scale */
+#define AFFINE_ZOOM_FRAMES 64
+#define AFFINE_ZOOM_FROM (8 * AFFINE_ONE)
+
+/* sin(2 pi i / 256) in 4.12 */
+const short affine_sine[AFFINE_TURN] = {
+    0, 101, 201, 301, 401, 501, 601, 700,
+    799, 897, 995, 1092, 1189, 1285, 1380, 1474,
+    1567, 1660, 1751, 1842, 1931, 2019, 2106, 2191,
+    2276, 2359, 2440, 2520, 2598, 2675, 2751, 2824,
+    2896, 2967, 3035, 3102, 3166, 3229, 3290, 3349,
+    3406, 3461, 3513, 3564, 3612, 3659, 3703, 3745,
+    3784, 3822, 3857, 3889, 3920, 3948, 3973, 3996,
+    4017, 4036, 4052, 4065, 4076, 4085, 4091, 4095,
+    4096, 4095, 4091, 4085, 4076, 4065, 4052, 4036,
+    4017, 3996, 3973, 3948, 3920, 3889, 3857, 3822,
+    3784, 3745, 3703, 3659, 3612, 3564, 3513, 3461,
+    3406, 3349, 3290, 3229, 3166, 3102, 3035, 2967,
+    2896, 2824, 2751, 2675, 2598, 2520, 2440, 2359,
+    2276, 2191, 2106, 2019, 1931, 1842, 1751, 1660,
+    1567, 1474, 1380, 1285, 1189, 1092, 995, 897,
+    799, 700, 601, 501, 401, 301, 201, 101,
+    0, -101, -201, -301, -401, -501, -601, -700,
+    -799, -897, -995, -1092, -1189, -1285, -1380, -1474,
+    -1567, -1660, -1751, -1842, -1931, -2019, -2106, -2191,
+    -2276, -2359, -2440, -2520, -2598, -2675, -2751, -2824,
+    -2896, -2967, -3035, -3102, -3166, -3229, -3290, -3349,
+    -3406, -3461, -3513, -3564, -3612, -3659, -3703, -3745,
+    -3784, -3822, -3857, -3889, -3920, -3948, -3973, -3996,
+    -4017, -4036, -4052, -4065, -4076, -4085, -4091, -4095,
+    -4096, -4095, -4091, -4085, -4076, -4065, -4052, -4036,
+    -4017, -3996, -3973, -3948, -3920, -3889, -3857, -3822,
+    -3784, -3745, -3703, -3659, -3612, -3564, -3513, -3461,
+    -3406, -3349, -3290, -3229, -3166, -3102, -3035, -2967,
+    -2896, -2824, -2751, -2675, -2598, -2520, -2440, -2359,
+    -2276, -2191, -2106, -2019, -1931, -1842, -1751, -1660,
+    -1567, -1474, -1380, -1285, -1189, -1092, -995, -897,
+    -799, -700, -601, -501, -401, -301, -201, -101,
+};
+
+/* one line's affine registers, BG2PA to BG2Y, as the hardware has them.
+ * pa and pc step across a line in texels a pixel, pb and pd would step
+ * down, and x and y are where the line starts in the map, in 1/256ths of a
+ * texel */
+struct AffineLine {
+    short pa, pb, pc, pd;
+    int x, y;
+};
+
+_Static_assert(sizeof(struct AffineLine) == 16, "an affine line is not the size of its registers");
+
+/* what a table shows: the map's point that sits at a point of the screen,
+ * in pixels, the layer turned by angle about it, and scale texels to a
+ * screen pixel in 8.8, so AFFINE_ONE is as it is and more is smaller. the
+ * scale swings by ripple either way, a line at a time, from phase on */
+struct AffineView {
+    int angle;
+    int scale;
+    int ripple;
+    int phase;
+    int center_x, center_y;
+    int screen_x, screen_y;
+};
+
+struct AffineTable {
+    struct AffineLine lines[2][AFFINE_LINES];
+
+    /* the view each table was last built from, if it has been */
+    struct AffineView views[2];
+    int built[2];
+
+    /* the table the DMA reads, and whether the other is newer */
+    int front;
+    int ready;
+
+    /* tables built, and views that needed no building */
+    unsigned int builds;
+    unsigned int skips;
+};
+
+void affine_init(struct AffineTable* table) {
+    table->built[0] = 0;
+    table->built[1] = 0;
+    table->front = 0;
+    table->ready = 0;
+    table->builds = 0;
+    table->skips = 0;
+}
+
+int affine_same(const struct AffineView* a, const struct AffineView* b) {
+    return a->angle == b->angle && a->scale == b->scale && a->ripple == b->ripple &&
+        a->phase == b->phase && a->center_x == b->center_x && a->center_y == b->center_y &&
+        a->screen_x == b->screen_x && a->screen_y == b->screen_y;
+}
+
+/* work out a view's lines into the table the DMA is not reading */
+IWRAM_CODE void affine_build(struct AffineTable* table, const struct AffineView* view) {
+    int back = !table->front;
+    if (table->built[table->front] && affine_same(&table->views[table->front], view)) {
+        table->ready = 0;
+        table->skips++;
+        return;
+    }
+    table->ready = 1;
+    if (table->built[back] && affine_same(&table->views[back], view)) {
+        table->skips++;
+        return;
+    }
+
+    struct AffineLine* line = table->lines[back];
+    int sine = affine_sine[view->angle & (AFFINE_TURN - 1)];
+    int cosine = affine_sine[(view->angle + AFFINE_TURN / 4) & (AFFINE_TURN - 1)];
+    int cx = view->center_x << 8, cy = view->center_y << 8;
+    int sx = view->screen_x, sy = view->screen_y;
+
+    if (!view->ripple) {
+        /* one matrix for the lot, so each line starts a step down from the
+         * last */
+        int pa = (cosine * view->scale) >> AFFINE_SINE_SHIFT;
+        int pb = (sine * view->scale) >> AFFINE_SINE_SHIFT;
+        int x = cx - pa * sx - pb * sy;
+        int y = cy + pb * sx - pa * sy;
+        for (int i = 0; i < AFFINE_LINES; i++, line++) {
+            line->pa = pa;
+            line->pb = pb;
+            line->pc = -pb;
+            line->pd = pa;
+            line->x = x;
+            line->y = y;
+            x += pb;
+            y += pa;
+        }
+    } else {
+        int phase = view->phase;
+        for (int i = 0; i < AFFINE_LINES; i++, line++, phase += AFFINE_RIPPLE_STEP) {
+            int scale = view->scale +
+                ((view->ripple * affine_sine[phase & (AFFINE_TURN - 1)]) >> AFFINE_SINE_SHIFT);
+            int pa = (cosine * scale) >> AFFINE_SINE_SHIFT;
+            int pb = (sine * scale) >> AFFINE_SINE_SHIFT;
+            int dy = i - sy;
+            line->pa = pa;
+            line->pb = pb;
+            line->pc = -pb;
+            line->pd = pa;
+            line->x = cx - pa * sx + pb * dy;
+            line->y = cy + pb * sx + pa * dy;
+        }
+    }
+    table->views[back] = *view;
+    table->built[back] = 1;
+    table->builds++;
+}
+
+/* in vblank: swap to the table just built, if there is one, and return the
+ * lines to show this frame */
+const struct AffineLine* affine_flip(struct AffineTable* table) {
+    if (table->ready) {
+        table->front = !table->front;
+        table->ready = 0;
+    }
+    return table->lines[table->front];
+}
+
+/* the title: a page going round about the middle of the screen once every
+ * 256 frames, growing and shrinking a little and rippling as it goes */
+void affine_title_view(struct AffineView* view, int frame) {
+    view->angle = frame & (AFFINE_TURN - 1);
+    view->scale = AFFINE_ONE + ((48 * affine_sine[(frame * 2) & (AFFINE_TURN - 1)]) >> AFFINE_SINE_SHIFT);
+    view->ripple = 20;
+    view->phase = frame * 3;
+    view->center_x = SCREEN_WIDTH / 2;
+    view->center_y = SCREEN_HEIGHT / 2;
+    view->screen_x = SCREEN_WIDTH / 2;
+    view->screen_y = SCREEN_HEIGHT / 2;
+}
+
+/* the end screen: the page zooms in from an eighth of its size, turning
+ * back a quarter turn and rippling less and less as it comes, and sits
+ * still once it is all there */
+void affine_zoom_view(struct AffineView* view, int frame) {
+    int left = frame < AFFINE_ZOOM_FRAMES ? AFFINE_ZOOM_FRAMES - frame : 0;
+    view->angle = left;
+    view->scale = AFFINE_ONE +
+        (((AFFINE_ZOOM_FROM - AFFINE_ONE) * left * left) / (AFFINE_ZOOM_FRAMES * AFFINE_ZOOM_FRAMES));
+    view->ripple = left * 2;
+    view->phase = left ? frame * 4 : 0;
+    view->center_x = SCREEN_WIDTH / 2;
+    view->center_y = SCREEN_HEIGHT / 2;
+    view->screen_x = SCREEN_WIDTH / 2;
+    view->screen_y = SCREEN_HEIGHT / 2;
+}
+
+/* an affine map is a byte a tile, with no flips or palette bits, and goes
+ * into VRAM two tiles at a time since VRAM takes no byte writes. a text
+ * map of tiles under 256 packs straight into one */
+void affine_map_pack(volatile unsigned short* dest, const unsigned short* map, int tiles) {
+    for (int i = 0; i + 1 < tiles; i += 2) {
+        dest[i / 2] = (map[i] & 0xff) | ((map[i + 1] & 0xff) << 8);
+    }
+}
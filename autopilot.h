@@ -0,0 +1,323 @@
+/* autopilot.h
+ * a player for attract mode and soak tests. each frame it searches ahead
+ * over whether to flap on each coming frame, stepping a copy of the dragon
+ * with the same accelerate(), dragon_collides(), dragon_animate() and flap()
+ * the game uses, and flaps now if the best plan it found starts with a flap.
+ *
+ * the search is a depth first search that tries the plan kept from the last
+ * frame first, so while that plan still works it costs one step per frame of
+ * lookahead. states met twice in one search are only expanded once, and
+ * states whose every future was found to crash are remembered from frame to
+ * frame, so a search that runs out of time still leaves the next one less to
+ * do. the search stops when it runs out of nodes or cycles, and the depth it
+ * aims for grows while it finishes in time and shrinks when it falls short */
+
+/* the range the lookahead depth is kept in, in frames */
+#define AUTOPILOT_MIN_DEPTH 8
+#define AUTOPILOT_MAX_DEPTH 96
+
+/* how many entries the state tables have, a power of two */
+#define AUTOPILOT_TABLE_BITS 10
+#define AUTOPILOT_TABLE (1 << AUTOPILOT_TABLE_BITS)
+
+/* the widest map the steering table covers, in tiles */
+#define AUTOPILOT_COLUMNS 64
+
+/* how often, in nodes, the cycle budget is checked */
+#define AUTOPILOT_CLOCK_EVERY 8
+
+/* what the search needs to know about the dragon at one depth */
+struct AutopilotState {
+    int y, yvel;
+    int falling;
+
+    /* the animation, as collisions go by the frame that is showing */
+    int frame, counter;
+};
+
+/* a table of states, each tagged with the frame it is for */
+struct AutopilotTable {
+    unsigned int key[AUTOPILOT_TABLE];
+    unsigned int frame[AUTOPILOT_TABLE];
+};
+
+struct Autopilot {
+    /* the best plan found, one flap flag per coming frame */
+    unsigned char plan[AUTOPILOT_MAX_DEPTH];
+    int plan_length;
+
+    /* the depth the next search aims for */
+    int depth;
+
+    /* the most nodes one search may visit, 0 for no limit */
+    int node_budget;
+
+    /* optional cycle counter and the most cycles one search may take */
+    unsigned int (*clock)();
+    unsigned int cycle_budget;
+
+    /* states met in this search, and states known to always crash */
+    struct AutopilotTable seen;
+    struct AutopilotTable doomed;
+
+    /* for each column of the map, the pixel height the search steers the
+     * dragon's middle towards: the middle of the next gap coming up */
+    const struct Tilemap* steer_map;
+    short steer[AUTOPILOT_COLUMNS];
+
+    /* the search stack */
+    struct AutopilotState stack[AUTOPILOT_MAX_DEPTH + 1];
+    signed char tried[AUTOPILOT_MAX_DEPTH + 1];
+    unsigned char path[AUTOPILOT_MAX_DEPTH];
+
+    /* how the last search went, and totals over all of them */
+    int nodes;
+    int reached;
+    int finished;
+    unsigned int total_nodes;
+    unsigned int searches;
+};
+
+/* empty a state table */
+void autopilot_table_clear(struct AutopilotTable* table) {
+    for (int i = 0; i < AUTOPILOT_TABLE; i++) {
+        table->frame[i] = 0xffffffff;
+    }
+}
+
+void autopilot_init(struct Autopilot* ap, int node_budget) {
+    ap->plan_length = 0;
+    ap->depth = AUTOPILOT_MAX_DEPTH;
+    ap->node_budget = node_budget;
+    ap->clock = 0;
+    ap->cycle_budget = 0;
+    ap->steer_map = 0;
+    autopilot_table_clear(&ap->seen);
+    autopilot_table_clear(&ap->doomed);
+    ap->nodes = 0;
+    ap->reached = 0;
+    ap->finished = 0;
+    ap->total_nodes = 0;
+    ap->searches = 0;
+}
+
+/* step a state one frame the way game_step() would, returns whether the
+ * dragon lives and stays on screen */
+int autopilot_step(const struct Dragon* dragon, const struct AutopilotState* from,
+        int xscroll, int flapping, const struct Tilemap* map, struct AutopilotState* to) {
+    struct Dragon d = *dragon;
+    d.y = from->y;
+    d.yvel = from->yvel;
+    d.frame = from->frame;
+    d.counter = from->counter;
+
+    if (from->falling) {
+        accelerate(&d.y, &d.yvel, d.gravity);
+    }
+    int y = d.y >> 8;
+    if (y < 0 || y > SCREEN_HEIGHT - 16 ||
+            dragon_collides(d.x >> 8, y, d.frame, xscroll, map)) {
+        return 0;
+    }
+    dragon_animate(&d);
+    if (flapping) {
+        flap(&d, 0);
+    }
+    to->y = d.y;
+    to->yvel = d.yvel;
+    to->falling = 1;
+    to->frame = d.frame;
+    to->counter = d.counter;
+    return 1;
+}
+
+/* work out the steering height for every column of a map */
+void autopilot_steer(struct Autopilot* ap, const struct Tilemap* map) {
+    int columns = map->width < AUTOPILOT_COLUMNS ? map->width : AUTOPILOT_COLUMNS;
+    int rows = SCREEN_HEIGHT / 8;
+
+    /* the middle of the longest run of open tiles in columns with pipes */
+    for (int x = 0; x < columns; x++) {
+        int best = 0, middle = -1, run = 0, blocked = 0;
+        for (int y = 0; y <= rows; y++) {
+            if (y < rows && !tile_solid(map->tiles[y * map->width + x])) {
+                run++;
+                continue;
+            }
+            if (y < rows) {
+                blocked++;
+            }
+            if (run > best) {
+                best = run;
+                middle = (y - run) * 8 + run * 4;
+            }
+            run = 0;
+        }
+        /* a column with nothing but the ground in it is filled in below */
+        ap->steer[x] = blocked > 2 ? middle : -1;
+    }
+
+    /* open columns steer for whatever gap comes next, going round the map
+     * twice so the last columns see the gaps at the start */
+    short next = SCREEN_HEIGHT / 2;
+    short filled[AUTOPILOT_COLUMNS];
+    for (int i = 2 * columns - 1; i >= 0; i--) {
+        int x = i % columns;
+        if (ap->steer[x] >= 0) {
+            next = ap->steer[x];
+        }
+        filled[x] = next;
+    }
+    for (int x = 0; x < columns; x++) {
+        ap->steer[x] = filled[x];
+    }
+    ap->steer_map = map;
+}
+
+/* the key of a state, to a quarter pixel of y and a sixteenth of a pixel
+ * per frame of yvel along with the animation frame, and the slot it goes in
+ * for a given frame. the animation counter only depends on the frame the
+ * state is for, as flapping leaves it alone */
+unsigned int autopilot_key(const struct AutopilotState* s) {
+    return (((unsigned int) s->frame & 0x1f) << 25) |
+        (((unsigned int) (s->y >> 6) & 0x3ff) << 15) |
+        (((unsigned int) (s->yvel >> 4)) & 0x7fff);
+}
+unsigned int autopilot_slot(unsigned int key, unsigned int frame) {
+    return ((key ^ (frame * 0x9e3779b9u)) * 2654435761u) >> (32 - AUTOPILOT_TABLE_BITS);
+}
+
+/* look a state up in a table */
+int autopilot_find(const struct AutopilotTable* table, unsigned int frame,
+        const struct AutopilotState* s) {
+    unsigned int key = autopilot_key(s);
+    unsigned int slot = autopilot_slot(key, frame);
+    return table->frame[slot] == frame && table->key[slot] == key;
+}
+
+/* put a state in a table, pushing out whatever shared its slot */
+void autopilot_insert(struct AutopilotTable* table, unsigned int frame,
+        const struct AutopilotState* s) {
+    unsigned int key = autopilot_key(s);
+    unsigned int slot = autopilot_slot(key, frame);
+    table->frame[slot] = frame;
+    table->key[slot] = key;
+}
+
+/* decide whether to flap this frame, before game_step() is called */
+int autopilot_decide(struct Autopilot* ap, const struct Game* game) {
+    const struct Dragon* dragon = &game->dragon;
+    unsigned int start = ap->clock ? ap->clock() : 0;
+
+    /* the first flag of the old plan was used last frame */
+    if (ap->plan_length > 0) {
+        for (int i = 1; i < ap->plan_length; i++) {
+            ap->plan[i - 1] = ap->plan[i];
+        }
+        ap->plan_length--;
+    }
+    if (ap->steer_map != game->ground) {
+        autopilot_steer(ap, game->ground);
+        autopilot_table_clear(&ap->doomed);
+    }
+    autopilot_table_clear(&ap->seen);
+
+    /* states are tagged with the frame they happen on, so what is learned
+     * now still holds next frame */
+    unsigned int now = (unsigned int) game->frames;
+    int target = ap->depth;
+    int best = 0;
+    int nodes = 0;
+    int out_of_time = 0;
+    int d = 0;
+    ap->stack[0].y = dragon->y;
+    ap->stack[0].yvel = dragon->yvel;
+    ap->stack[0].falling = dragon->falling;
+    ap->stack[0].frame = dragon->frame;
+    ap->stack[0].counter = dragon->counter;
+    ap->tried[0] = 0;
+
+    while (d >= 0 && best < target) {
+        /* both choices crash from here, so never come here again */
+        if (ap->tried[d] == 2) {
+            if (d > 0) {
+                autopilot_insert(&ap->doomed, now + d, &ap->stack[d]);
+            }
+            d--;
+            continue;
+        }
+
+        /* out of nodes or cycles, keep the deepest plan so far */
+        if (ap->node_budget && nodes >= ap->node_budget) {
+            out_of_time = 1;
+            break;
+        }
+        if (ap->clock && (nodes % AUTOPILOT_CLOCK_EVERY) == 0 &&
+                ap->clock() - start >= ap->cycle_budget) {
+            out_of_time = 1;
+            break;
+        }
+
+        /* try what the old plan did first, then the other choice. past the
+         * end of the plan, try flapping first if the dragon is sinking below
+         * the gap coming up */
+        int preferred;
+        if (d < ap->plan_length) {
+            preferred = ap->plan[d];
+        } else {
+            int column = ((dragon->x >> 8) + 16 + game->xscroll + d) >> 3;
+            int steer = ap->steer[(column % game->ground->width) % AUTOPILOT_COLUMNS];
+            preferred = (ap->stack[d].y >> 8) + 8 > steer && ap->stack[d].yvel > 0;
+        }
+        int flapping = ap->tried[d] == 0 ? preferred : !preferred;
+        ap->tried[d]++;
+        nodes++;
+
+        struct AutopilotState next;
+        if (!autopilot_step(dragon, &ap->stack[d], game->xscroll + d + 1, flapping,
+                    game->ground, &next) ||
+                autopilot_find(&ap->seen, now + d + 1, &next) ||
+                autopilot_find(&ap->doomed, now + d + 1, &next)) {
+            continue;
+        }
+        autopilot_insert(&ap->seen, now + d + 1, &next);
+        ap->path[d] = flapping;
+        d++;
+        ap->stack[d] = next;
+        ap->tried[d] = 0;
+
+        if (d > best) {
+            best = d;
+            for (int i = 0; i < d; i++) {
+                ap->plan[i] = ap->path[i];
+            }
+        }
+    }
+
+    /* with nothing surviving, keep what is left of the old plan */
+    if (best > 0) {
+        ap->plan_length = best;
+    }
+
+    /* aim deeper next time if this search finished. running out of time is
+     * fine while the plan still reaches most of the way, as the next search
+     * starts from it, but if it falls well short aim shallower */
+    if (out_of_time && best < target / 2) {
+        ap->depth -= 4;
+    } else if (best >= target) {
+        ap->depth += 2;
+    }
+    if (ap->depth < AUTOPILOT_MIN_DEPTH) {
+        ap->depth = AUTOPILOT_MIN_DEPTH;
+    }
+    if (ap->depth > AUTOPILOT_MAX_DEPTH) {
+        ap->depth = AUTOPILOT_MAX_DEPTH;
+    }
+
+    ap->nodes = nodes;
+    ap->reached = best;
+    ap->finished = best >= target;
+    ap->total_nodes += nodes;
+    ap->searches++;
+    return ap->plan_length > 0 ? ap->plan[0] : 0;
+}
@@ -0,0 +1,77 @@
+/* dmaqueue.h
+ * copies to video memory, held until vblank. VRAM, OAM and palette memory
+ * are busy while the screen is being drawn, so anything that writes to them
+ * during the frame puts a copy on the queue instead, and the whole queue is
+ * sent with 32 bit DMA straight after the vblank wait. the GBA build does
+ * that in dma_queue_flush() in Phlapu.c, and the host tools use memcpy.
+ *
+ * 32 bit DMA ignores the low two bits of both addresses, so a copy from or
+ * to somewhere off a word boundary would come out shifted. the queue checks
+ * each copy as it goes on and marks those to go 16 bits at a time instead,
+ * so data generated as plain byte arrays is safe wherever it is linked.
+ *
+ * the queue counts the words it was given each frame, the most it has been
+ * given in one frame, the copies that had to go 16 bits at a time and the
+ * copies it had to turn down for being full */
+
+/* the most copies that can be waiting at once */
+#define DMA_QUEUE_SIZE 32
+
+/* one copy, a whole number of 32 bit words, sent as halfwords if either
+ * end is not word aligned */
+struct DmaCopy {
+    void* dest;
+    const void* source;
+    unsigned int words;
+    int unaligned;
+};
+
+struct DmaQueue {
+    struct DmaCopy copies[DMA_QUEUE_SIZE];
+    int count;
+
+    /* words waiting now, and the most there have been at one flush */
+    unsigned int words;
+    unsigned int high;
+
+    /* copies sent as halfwords, copies turned down, and flushes done */
+    unsigned int unaligned;
+    unsigned int dropped;
+    unsigned int flushes;
+};
+
+void dma_queue_init(struct DmaQueue* queue) {
+    queue->count = 0;
+    queue->words = 0;
+    queue->high = 0;
+    queue->unaligned = 0;
+    queue->dropped = 0;
+    queue->flushes = 0;
+}
+
+/* put a copy of bytes (a multiple of 4, both ends at least halfword
+ * aligned) on the queue, returns 0 if it is full */
+int dma_queue_push(struct DmaQueue* queue, void* dest, const void* source, unsigned int bytes) {
+    if (queue->count >= DMA_QUEUE_SIZE) {
+        queue->dropped++;
+        return 0;
+    }
+    struct DmaCopy* copy = &queue->copies[queue->count++];
+    copy->dest = dest;
+    copy->source = source;
+    copy->words = bytes / 4;
+    copy->unaligned = (((unsigned long) dest | (unsigned long) source) & 3) != 0;
+    queue->unaligned += copy->unaligned;
+    queue->words += copy->words;
+    return 1;
+}
+
+/* empty the queue once its copies are done, keeping the high-water mark */
+void dma_queue_done(struct DmaQueue* queue) {
+    if (queue->words > queue->high) {
+        queue->high = queue->words;
+    }
+    queue->count = 0;
+    queue->words = 0;
+    queue->flushes++;
+}
@@ -0,0 +1,1243 @@
+/* game.h
+ * the game logic: sprites, the dragon, the score and the tile collision.
+ * nothing in here touches the hardware, so the same code runs on the GBA
+ * and headless on the host (define PHLAPU_HOST before including it) */
+
+#include <stddef.h>
+
+#define SCREEN_WIDTH 240
+#define SCREEN_HEIGHT 160
+
+/* include the ground layer map we are using */
+#include "groundlayermap.h"     //bg1
+
+/* the GBA build times the dragon, the score, the tile lookup and the entity
+ * passes with the profiler, by defining these before it includes this file */
+#ifndef GAME_ZONE_BEGIN
+#define GAME_ZONE_BEGIN(zone)
+#define GAME_ZONE_END(zone)
+#endif
+
+/* the fuzzer checks every tile the game reads is inside its map, index out
+ * of count, by defining this before it includes this file */
+#ifndef GAME_TILE_READ
+#define GAME_TILE_READ(index, count)
+#endif
+
+/* include the collision masks mkmasks made from the sprite and tile images */
+#include "masks.h"
+
+/* there are 128 sprites on the GBA */
+#define NUM_SPRITES 128
+
+/* the bit positions indicate each button - the first bit is for A, second for
+ * B, and so on, each constant below can be ANDED into the register to get the
+ * status of any one button */
+#define BUTTON_A (1 << 0)
+#define BUTTON_B (1 << 1)
+#define BUTTON_SELECT (1 << 2)
+#define BUTTON_START (1 << 3)
+#define BUTTON_RIGHT (1 << 4)
+#define BUTTON_LEFT (1 << 5)
+#define BUTTON_UP (1 << 6)
+#define BUTTON_DOWN (1 << 7)
+#define BUTTON_R (1 << 8)
+#define BUTTON_L (1 << 9)
+
+///////////////////Sprites
+
+/* a sprite is a moveable image on the screen */
+struct Sprite {
+    unsigned short attribute0;
+    unsigned short attribute1;
+    unsigned short attribute2;
+    unsigned short attribute3;
+};
+
+/* the shadow copy of all the sprites available on the GBA, which gets
+ * copied into sprite attribute memory during vblank */
+struct Oam {
+    struct Sprite sprites[NUM_SPRITES];
+    int next_sprite_index;
+};
+
+/* the different sizes of sprites which are possible */
+enum SpriteSize {
+    SIZE_8_8,
+    SIZE_16_16,
+    SIZE_32_32,
+    SIZE_64_64,
+    SIZE_16_8,
+    SIZE_32_8,
+    SIZE_32_16,
+    SIZE_64_32,
+    SIZE_8_16,
+    SIZE_8_32,
+    SIZE_16_32,
+    SIZE_32_64
+};
+
+/* function to initialize a sprite with its properties, and return its index */
+int sprite_init(struct Oam* oam, int x, int y, enum SpriteSize size,
+        int horizontal_flip, int vertical_flip, int tile_index, int priority) {
+
+    /* grab the next index */
+    int index = oam->next_sprite_index++;
+    struct Sprite* sprites = oam->sprites;
+
+    /* setup the bits used for each shape/size possible */
+    int size_bits = 0, shape_bits = 0;
+    switch (size) {
+        case SIZE_8_8:   size_bits = 0; shape_bits = 0; break;
+        case SIZE_16_16: size_bits = 1; shape_bits = 0; break;
+        case SIZE_32_32: size_bits = 2; shape_bits = 0; break;
+        case SIZE_64_64: size_bits = 3; shape_bits = 0; break;
+        case SIZE_16_8:  size_bits = 0; shape_bits = 1; break;
+        case SIZE_32_8:  size_bits = 1; shape_bits = 1; break;
+        case SIZE_32_16: size_bits = 2; shape_bits = 1; break;
+        case SIZE_64_32: size_bits = 3; shape_bits = 1; break;
+        case SIZE_8_16:  size_bits = 0; shape_bits = 2; break;
+        case SIZE_8_32:  size_bits = 1; shape_bits = 2; break;
+        case SIZE_16_32: size_bits = 2; shape_bits = 2; break;
+        case SIZE_32_64: size_bits = 3; shape_bits = 2; break;
+    }
+
+    int h = horizontal_flip ? 1 : 0;
+    int v = vertical_flip ? 1 : 0;
+
+    /* set up the first attribute */
+    sprites[index].attribute0 = y |             /* y coordinate */
+                            (0 << 8) |          /* rendering mode */
+                            (0 << 10) |         /* gfx mode */
+                            (0 << 12) |         /* mosaic */
+                            (1 << 13) |         /* color mode, 0:16, 1:256 */
+                            (shape_bits << 14); /* shape */
+
+    /* set up the second attribute */
+    sprites[index].attribute1 = x |             /* x coordinate */
+                            (0 << 9) |          /* affine flag */
+                            (h << 12) |         /* horizontal flip flag */
+                            (v << 13) |         /* vertical flip flag */
+                            (size_bits << 14);  /* size */
+
+    /* setup the second attribute */
+    sprites[index].attribute2 = tile_index |   // tile index */
+                            (priority << 10) | // priority */
+                            (0 << 12);         // palette bank (only 16 color)*/
+
+    /* return the index of this sprite */
+    return index;
+}
+
+/* setup all sprites */
+void sprite_clear(struct Oam* oam) {
+    /* clear the index counter */
+    oam->next_sprite_index = 0;
+
+    /* move all sprites offscreen to hide them */
+    for(int i = 0; i < NUM_SPRITES; i++) {
+        oam->sprites[i].attribute0 = SCREEN_HEIGHT;
+        oam->sprites[i].attribute1 = SCREEN_WIDTH;
+    }
+}
+
+/* set a sprite postion */
+void sprite_position(struct Sprite* sprite, int x, int y) {
+    /* clear out the y coordinate */
+    sprite->attribute0 &= 0xff00;
+
+    /* set the new y coordinate */
+    sprite->attribute0 |= (y & 0xff);
+
+    /* clear out the x coordinate */
+    sprite->attribute1 &= 0xfe00;
+
+    /* set the new x coordinate */
+    sprite->attribute1 |= (x & 0x1ff);
+}
+
+/* move a sprite in a direction */
+void sprite_move(struct Sprite* sprite, int dx, int dy) {
+    /* get the current y coordinate */
+    int y = sprite->attribute0 & 0xff;
+
+    /* get the current x coordinate */
+    int x = sprite->attribute1 & 0x1ff;
+
+    /* move to the new location */
+    sprite_position(sprite, x + dx, y + dy);
+}
+
+/* change the vertical flip flag */
+void sprite_set_vertical_flip(struct Sprite* sprite, int vertical_flip) {
+    if (vertical_flip) {
+        /* set the bit */
+        sprite->attribute1 |= 0x2000;
+    } else {
+        /* clear the bit */
+        sprite->attribute1 &= 0xdfff;
+    }
+}
+
+/* change the vertical flip flag */
+void sprite_set_horizontal_flip(struct Sprite* sprite, int horizontal_flip) {
+    if (horizontal_flip) {
+        /* set the bit */
+        sprite->attribute1 |= 0x1000;
+    } else {
+        /* clear the bit */
+        sprite->attribute1 &= 0xefff;
+    }
+}
+
+/* change the tile offset of a sprite */
+void sprite_set_offset(struct Sprite* sprite, int offset) {
+    /* clear the old offset */
+    sprite->attribute2 &= 0xfc00;
+
+    /* apply the new one */
+    sprite->attribute2 |= (offset & 0x03ff);
+}
+
+/////////////////Tilemaps
+
+/* what is known about the rows of one column of a map, a bit a row: the
+ * rows with no block, and the rows with a block drawn all over. a row in
+ * neither could be anything, so a column of zeroes is always safe */
+struct TileColumn {
+    unsigned int clear;
+    unsigned int full;
+};
+
+/* a tile map the dragon collides against, with its size in tiles, and a
+ * TileColumn for each column if it has them (NULL if not), which let
+ * dragon_collides() answer without reading the tiles. tilemap_columns()
+ * fills them in, and they need doing again whenever a column changes */
+struct Tilemap {
+    const unsigned short* tiles;
+    int width, height;
+    struct TileColumn* columns;
+};
+
+/* the ground layer as shipped in the ROM, with its columns left for the
+ * game to fill in when it starts */
+struct TileColumn ground_columns[groundlayermap_width];
+const struct Tilemap ground_tilemap = {
+    groundlayermap, groundlayermap_width, groundlayermap_height, ground_columns
+};
+
+/* finds which tile a screen coordinate maps to, taking scroll into account */
+unsigned short tile_lookup(int x, int y, int xscroll, int yscroll,
+        const unsigned short* tilemap, int tilemap_w, int tilemap_h) {
+    GAME_ZONE_BEGIN(PROFILE_TILE_LOOKUP);
+
+    /* adjust for the scroll */
+    x += xscroll;
+    y += yscroll;
+
+    /* convert from screen coordinates to tile coordinates */
+    x >>= 3;
+    y >>= 3;
+
+    /* account for wraparound */
+    while (x >= tilemap_w) {
+        x -= tilemap_w;
+    }
+    while (y >= tilemap_h) {
+        y -= tilemap_h;
+    }
+    while (x < 0) {
+        x += tilemap_w;
+    }
+    while (y < 0) {
+        y += tilemap_h;
+    }
+
+    /* lookup this tile from the map */
+    int index = y * tilemap_w + x;
+    GAME_TILE_READ(index, tilemap_w * tilemap_h);
+
+    /* return the tile */
+    unsigned short tile = tilemap[index];
+    GAME_ZONE_END(PROFILE_TILE_LOOKUP);
+    return tile;
+}
+
+/////////////////Dragon
+
+/* a struct for the dragon's logic and behavior */
+struct Dragon {
+    /* the index of the sprite in the shadow OAM */
+    int sprite;
+
+    /* the x and y postion, in 1/256 pixels */
+    int x, y;
+
+    /* the dragon's y velocity in 1/256 pixels/second */
+    int yvel;
+
+    /* the dragon's y acceleration in 1/256 pixels/second^2 */
+    int gravity;
+
+    /* what a flap takes off yvel, and how far it lifts him straight away,
+     * in 1/256 pixels */
+    int flap_impulse;
+    int flap_lift;
+
+    /* which frame of the animation he is on */
+    int frame;
+
+    /* the number of frames to wait before flipping */
+    int animation_delay;
+
+    /* the animation counter counts how many frames until we flip */
+    int counter;
+
+    /* whether the dragon is moving right now or not */
+    int move;
+
+    /* the number of pixels away from the edge of the screen the dragon stays */
+    int border;
+
+    /* if the dragon is currently falling */
+    int falling;
+
+    /* if the dragon is alive */
+    int alive;
+};
+
+/* initialize the dragon */
+void dragon_init(struct Dragon* dragon, struct Oam* oam) {
+    dragon->x = 40 << 8;
+    dragon->y = 40 << 8;
+    dragon->yvel = 0;
+    dragon->gravity = 40;
+    dragon->flap_impulse = 1500;
+    dragon->flap_lift = 40;
+    dragon->border = 40;
+    dragon->frame = 0;
+    dragon->move = 1;
+    dragon->counter = 0;
+    dragon->falling = 0;
+    dragon->alive = 1;
+    dragon->animation_delay = 8;
+    dragon->sprite = sprite_init(oam, dragon->x >> 8, dragon->y >> 8, SIZE_16_16, 0, 0, dragon->frame, 0);
+}
+
+/* move the dragon left or right returns if it is at edge of the screen */
+int dragon_left(struct Dragon* dragon, struct Oam* oam) {
+    /* face left */
+    sprite_set_horizontal_flip(&oam->sprites[dragon->sprite], 1);
+    dragon->move = 1;
+
+    /* if we are at the left end, just scroll the screen */
+    if ((dragon->x >> 8) < dragon->border) {
+        return 1;
+    } else {
+        /* else move left */
+        dragon->x -= 256;
+        return 0;
+    }
+}
+int dragon_right(struct Dragon* dragon, struct Oam* oam) {
+    /* face right */
+    sprite_set_horizontal_flip(&oam->sprites[dragon->sprite], 0);
+    dragon->move = 1;
+
+    /* if we are at the right end, just scroll the screen */
+    if ((dragon->x >> 8) > (SCREEN_WIDTH - 16 - dragon->border)) {
+        return 1;
+    } else {
+        /* else move right */
+        dragon->x += 256;
+        return 0;
+    }
+}
+
+/* stop the dragon from walking left/right */
+void dragon_stop(struct Dragon* dragon, struct Oam* oam) {
+    dragon->move = 0;
+    dragon->frame = 0;
+    dragon->counter = 7;
+    sprite_set_offset(&oam->sprites[dragon->sprite], dragon->frame);
+}
+
+/* flap. the wings go back to the first frame, and so does the sprite
+ * unless oam is 0, so the mask the next collision tests is the frame on
+ * screen */
+void flap(struct Dragon* dragon, struct Oam* oam) {
+        dragon->frame = 0;
+        dragon->yvel -= dragon->flap_impulse;
+        dragon->y -= dragon->flap_lift;
+        if (oam) {
+            sprite_set_offset(&oam->sprites[dragon->sprite], dragon->frame);
+        }
+}
+
+/////////////SCORE
+/* a struct for the dragon's logic and behavior */
+struct Score {
+    /* the index of the sprite in the shadow OAM */
+    int sprite;
+
+    /* the x and y postion, in 1/256 pixels */
+    int x, y;
+
+    /* which frame of the animation he is on */
+    int frame;
+
+    /* the number of frames to wait before flipping */
+    int animation_delay;
+
+    /* the animation counter counts how many frames until we flip */
+    int counter;
+
+    /* the number of pixels away from the edge of the screen the dragon stays */
+    int border;
+
+    /* total score */
+    int total;
+
+    /* lap number */
+    int lap;
+
+};
+
+/* initialize the score */
+void score_init(struct Score* score, struct Oam* oam) {
+    score->x = 116 << 8;
+    score->y = 30 << 8;
+    score->border = 110;
+    score->frame = 24;
+    score->counter = 0;
+    score->animation_delay = 8;
+    score->total = 0;
+    score->lap = 0;
+    score->sprite = sprite_init(oam, score->x >> 8, score->y >> 8, SIZE_8_8, 0, 0, score->frame, 0);
+}
+
+////////////Sprite Updates
+
+
+void score_update(struct Score* score, struct Dragon* dragon, struct Oam* oam,
+        int xscroll, const struct Tilemap* map) {
+    /*check if dragon has passed key tile*/
+   // unsigned short begin = tile_lookup((dragon->x >> 8)+8, 0, xscroll, 0, map->tiles, map->width, map->height);
+    unsigned short above = tile_lookup((dragon->x >> 8)-1,0,xscroll,0,map->tiles,map->width,map->height);
+    unsigned short passed = 0;
+    if(above == 11){
+        passed = 1;
+    }
+    if(passed == 1){
+        score->counter++;
+        if (score->counter >= score->animation_delay) {
+            score->frame += 1;
+            score->total += 1;
+            score->lap = (score->total/3)+1;
+            if (score->frame > 45) {
+                score->frame = 24;
+            }
+            sprite_set_offset(&oam->sprites[score->sprite], score->frame);
+            score->counter = 0;
+        }
+    }
+}
+
+/* y += yvel; yvel += gravity - in accelerate.s on the GBA, in C on the host */
+#ifdef PHLAPU_HOST
+void accelerate(int* y, int* yvel, int grav) {
+    *y += *yvel;
+    *yvel += grav;
+}
+#else
+//accelerate Assembly function
+void accelerate(int* y, int* yvel, int grav);
+#endif
+
+/* whether a tile is one of the blocks the dragon dies running into
+ * these numbers refer to the tile indices of the blocks */
+int tile_solid(unsigned short tile) {
+    return (tile == 21) ||
+        (tile >= 1 && tile <= 6) ||
+        (tile >= 12 && tile <= 17);
+}
+
+/* wrap a tile coordinate onto a map dimension. maps a power of two across,
+ * like the shipped one, only need a mask, and a division is only done for
+ * other maps once the coordinate is off the map */
+int tile_wrap(int i, int size) {
+    if ((size & (size - 1)) == 0) {
+        return i & (size - 1);
+    }
+    if (i >= 0 && i < size) {
+        return i;
+    }
+    i %= size;
+    return i < 0 ? i + size : i;
+}
+
+/* work out what is in one column of a map, for the maps that have columns.
+ * maps taller than 32 rows, or shorter than 3, are left with zeroes */
+void tilemap_column(const struct Tilemap* map, int column) {
+    struct TileColumn* known = &map->columns[column];
+    known->clear = 0;
+    known->full = 0;
+    if (map->height < 3 || map->height > 32) {
+        return;
+    }
+    for (int row = 0; row < map->height; row++) {
+        unsigned short tile = map->tiles[row * map->width + column];
+        if (!tile_solid(tile) || tile >= TILE_MASK_COUNT) {
+            known->clear |= 1u << row;
+        } else if (tile_full[tile]) {
+            known->full |= 1u << row;
+        }
+    }
+}
+
+/* work out every column of a map that has them */
+void tilemap_columns(const struct Tilemap* map) {
+    if (map->columns) {
+        for (int column = 0; column < map->width; column++) {
+            tilemap_column(map, column);
+        }
+    }
+}
+
+/* three rows of a column's bits from the given one down, wrapping round
+ * the bottom of the map */
+unsigned int tile_column_rows(unsigned int bits, int row, int height) {
+    unsigned int rows = bits >> row;
+    if (row > height - 3) {
+        rows |= bits << (height - row);
+    }
+    return rows & 7;
+}
+
+/* whether the dragon's sprite, showing the given animation frame at screen
+ * pixel x, y, has any drawn pixel over a drawn pixel of a block. the sprite
+ * covers up to three rows and three columns of tiles. if the map knows its
+ * columns, dragon_cover gives the ones of those the frame reaches with a
+ * drawn pixel from where it sits in its tile, and that settles it. if not,
+ * rows of the tiles with no block in them are passed over, and for the rest
+ * each line of the sprite in the row is ANDed against the masks of the
+ * tiles beside it, three tiles to a 32 bit word shifted down to where the
+ * sprite starts */
+int dragon_collides(int x, int y, int frame, int xscroll, const struct Tilemap* map) {
+    int left = x + xscroll;
+    int shift = left & 7;
+    int top = y & 7;
+
+    /* the columns, and the first row, with the wrapping worked out once */
+    int columns[3];
+    columns[0] = tile_wrap(left >> 3, map->width);
+    for (int c = 1; c < 3; c++) {
+        columns[c] = columns[c - 1] + 1 == map->width ? 0 : columns[c - 1] + 1;
+    }
+    int row = tile_wrap(y >> 3, map->height);
+
+    /* with the map's columns, the tiles the sprite reaches with a drawn
+     * pixel are enough unless one of them might be a block that is not
+     * drawn all over, which none of the shipped ones are */
+    if (map->columns && map->height <= 32) {
+        unsigned int clear = 0;
+        unsigned int full = 0;
+        for (int c = 0; c < 3; c++) {
+            const struct TileColumn* column = &map->columns[columns[c]];
+            clear |= tile_column_rows(column->clear, row, map->height) << (c * 3);
+            full |= tile_column_rows(column->full, row, map->height) << (c * 3);
+        }
+        unsigned int cover = dragon_cover[frame][top * 8 + shift];
+        if (!(cover & ~clear & ~full)) {
+            return (cover & full) != 0;
+        }
+    }
+
+    /* the sprite's rows start 8 in, so in line with each row of tiles */
+    const unsigned short* sprite = dragon_masks[frame] + 8 - top;
+    int rows = top ? 3 : 2;
+    for (int r = 0; r < rows; r++, sprite += 8) {
+        const unsigned short* tiles = map->tiles + row * map->width;
+        row = row + 1 == map->height ? 0 : row + 1;
+
+        /* the masks of the blocks beside each other, 0 for anything else */
+        static const unsigned char empty[8];
+        const unsigned char* masks[3];
+        int blocks = 0;
+        for (int c = 0; c < 3; c++) {
+            GAME_TILE_READ(tiles - map->tiles + columns[c], map->width * map->height);
+            unsigned short tile = tiles[columns[c]];
+            int solid = tile_solid(tile) && tile < TILE_MASK_COUNT;
+            masks[c] = solid ? tile_masks[tile] : empty;
+            blocks |= solid;
+        }
+        if (!blocks) {
+            continue;
+        }
+
+        /* only the lines of the row the sprite is on, the first row from
+         * where it starts and the last up to where it ends */
+        int first = r == 0 ? top : 0;
+        int last = r == 2 ? top : 8;
+        unsigned int hits = 0;
+        for (int line = first; line < last; line++) {
+            unsigned int ground = masks[0][line] | (masks[1][line] << 8) | (masks[2][line] << 16);
+            hits |= (ground >> shift) & sprite[line];
+        }
+        if (hits) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* move the dragon's animation on a frame if he is moving, returns whether
+ * it went on to the next frame */
+int dragon_animate(struct Dragon* dragon) {
+    if (!dragon->move) {
+        return 0;
+    }
+    dragon->counter++;
+    if (dragon->counter < dragon->animation_delay) {
+        return 0;
+    }
+    dragon->frame += 1;
+    if (dragon->frame > 16) {
+        dragon->frame = 0;
+    }
+    dragon->counter = 0;
+    return 1;
+}
+
+/* update the dragon */
+void dragon_update(struct Dragon* dragon, struct Score* score, struct Oam* oam,
+        int xscroll, const struct Tilemap* map) {
+    /* update y position and speed if falling */
+    if (dragon->falling) {
+        accelerate(&dragon->y,&dragon->yvel,dragon->gravity);
+    }
+
+    dragon->falling = 1;
+        dragon->move = 1;
+
+    if(dragon->x == 240){
+        dragon->alive = 0;
+    }
+    if (dragon_collides(dragon->x >> 8, dragon->y >> 8, dragon->frame, xscroll, map)) {
+        dragon->alive = 0;
+    }
+    //else {
+        // he is falling now
+        //dragon->falling = 1;
+      //  dragon->move = 1;
+    //}
+
+    //if collided = 1
+    if(dragon->alive == 0){
+        dragon->x = 240;
+        dragon->y = 160;
+        score->x = 120;
+        score->y = 40;
+        sprite_position(&oam->sprites[dragon->sprite],240, 160);
+        sprite_position(&oam->sprites[score->sprite],240,160);
+        //*display_control |= BG2_ENABLE;
+        dragon->yvel = 0;
+        dragon->falling = 0;
+    }
+    else{
+        /* update animation if moving */
+        if (dragon_animate(dragon)) {
+            sprite_set_offset(&oam->sprites[dragon->sprite], dragon->frame);
+        }
+        /* set on screen position */
+        sprite_position(&oam->sprites[dragon->sprite], dragon->x >> 8, dragon->y >> 8);
+    }
+}
+
+/////////////Entities
+
+/* the most entities alive at once, each with a sprite of its own. the host
+ * benchmarks raise it by defining it first */
+#ifndef ENTITY_CAPACITY
+#define ENTITY_CAPACITY 48
+#endif
+
+/* the broad phase splits the screen into columns this many pixels wide,
+ * which is as wide as the widest entity, with one spare column each side
+ * for entities half off the screen */
+#define ENTITY_CELL_SHIFT 4
+#define ENTITY_CELLS ((SCREEN_WIDTH >> ENTITY_CELL_SHIFT) + 2)
+
+/* how often a new entity comes on, in frames */
+#define ENTITY_SPAWN_EVERY 6
+
+/* the kinds of entity */
+enum EntityKind {
+    ENTITY_ENEMY,       /* a dragon flying the other way, bobbing a little */
+    ENTITY_OBSTACLE,    /* an upside down dragon bouncing up and down */
+    ENTITY_PICKUP,      /* a digit drifting past with the ground */
+    ENTITY_KINDS
+};
+
+/* what every entity of a kind has in common */
+struct EntityKindInfo {
+    /* speed across and up and down, in 1/256 pixels a frame. across is
+     * on top of the scroll, so 0 keeps still against the ground */
+    short xvel, yvel;
+
+    /* the range of y it stays in, in pixels */
+    short top, bottom;
+
+    /* size in pixels, and sprite size, flips and animation frames */
+    unsigned char width, height;
+    unsigned char size, shape;
+    unsigned char horizontal_flip, vertical_flip;
+    unsigned char tiles[3];
+    unsigned char frames;
+    unsigned char animation_delay;
+};
+
+const struct EntityKindInfo entity_kinds[ENTITY_KINDS] = {
+    /* enemy */
+    {-128, 64, 16, 120, 16, 16, 1, 0, 1, 0, {0, 8, 16}, 3, 8},
+    /* obstacle */
+    {0, 192, 0, 128, 16, 16, 1, 0, 0, 1, {0, 8, 16}, 3, 12},
+    /* pickup */
+    {0, 0, 24, 112, 8, 8, 0, 0, 0, 0, {24, 26, 28}, 3, 10},
+};
+
+/* every live entity, stored a field to an array so each pass runs down the
+ * arrays it needs. the live ones are packed at the front: a despawn moves
+ * the last one into the gap */
+struct Entities {
+    int count;
+
+    /* the position on screen and the speed up and down, in 1/256 pixels */
+    int x[ENTITY_CAPACITY];
+    int y[ENTITY_CAPACITY];
+    short yvel[ENTITY_CAPACITY];
+
+    unsigned char kind[ENTITY_CAPACITY];
+
+    /* the animation frame and how long until the next one */
+    unsigned char frame[ENTITY_CAPACITY];
+    unsigned char counter[ENTITY_CAPACITY];
+
+    /* the broad phase. each entity sits in the column its left edge is in,
+     * and each column is a list threaded through next and prev, so moving
+     * an entity to another column is only an unlink and a link */
+    signed char cell[ENTITY_CAPACITY];
+    short next[ENTITY_CAPACITY];
+    short prev[ENTITY_CAPACITY];
+    short head[ENTITY_CELLS];
+
+    /* from the last collision pass: pairs tested, pairs overlapping, and
+     * entities the dragon ran into, and how many of those hurt him rather
+     * than being picked up */
+    int candidates;
+    int overlaps;
+    int dragon_hits;
+    int dragon_damage;
+
+    /* the first of the ENTITY_CAPACITY sprites kept for entities, and how
+     * many of them were showing after the last sync */
+    int first_sprite;
+    int shown;
+
+    /* frames until the next spawn, and the state of the spawn generator */
+    int spawn_timer;
+    unsigned int random;
+};
+
+/* set up with no entities, keeping sprites for them unless oam is 0 */
+void entities_init(struct Entities* entities, struct Oam* oam) {
+    entities->count = 0;
+    entities->shown = 0;
+    entities->spawn_timer = ENTITY_SPAWN_EVERY;
+    entities->random = 0x2545f491;
+    entities->candidates = 0;
+    entities->overlaps = 0;
+    entities->dragon_hits = 0;
+    entities->dragon_damage = 0;
+    for (int c = 0; c < ENTITY_CELLS; c++) {
+        entities->head[c] = -1;
+    }
+    entities->first_sprite = 0;
+    if (oam) {
+        entities->first_sprite = oam->next_sprite_index;
+        for (int i = 0; i < ENTITY_CAPACITY; i++) {
+            sprite_init(oam, SCREEN_WIDTH, SCREEN_HEIGHT, SIZE_8_8, 0, 0, 0, 0);
+        }
+    }
+}
+
+/* the broad phase column a screen x position, in 1/256 pixels, is in */
+int entity_cell(int x) {
+    int cell = ((x >> 8) + (1 << ENTITY_CELL_SHIFT)) >> ENTITY_CELL_SHIFT;
+    if (cell < 0) {
+        return 0;
+    }
+    if (cell >= ENTITY_CELLS) {
+        return ENTITY_CELLS - 1;
+    }
+    return cell;
+}
+
+/* put an entity at the front of a column's list */
+void entity_link(struct Entities* entities, int i, int cell) {
+    int first = entities->head[cell];
+    entities->cell[i] = cell;
+    entities->prev[i] = -1;
+    entities->next[i] = first;
+    if (first >= 0) {
+        entities->prev[first] = i;
+    }
+    entities->head[cell] = i;
+}
+
+/* take an entity out of its column's list */
+void entity_unlink(struct Entities* entities, int i) {
+    int prev = entities->prev[i];
+    int next = entities->next[i];
+    if (prev >= 0) {
+        entities->next[prev] = next;
+    } else {
+        entities->head[entities->cell[i]] = next;
+    }
+    if (next >= 0) {
+        entities->prev[next] = prev;
+    }
+}
+
+/* the spawn generator, a xorshift */
+unsigned int entities_random(struct Entities* entities) {
+    unsigned int r = entities->random;
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    entities->random = r;
+    return r;
+}
+
+/* bring a new entity on at the right edge, returns its index or -1 if the
+ * pool is full */
+int entity_spawn(struct Entities* entities, enum EntityKind kind, int y) {
+    if (entities->count >= ENTITY_CAPACITY) {
+        return -1;
+    }
+    int i = entities->count++;
+    entities->x[i] = SCREEN_WIDTH << 8;
+    entities->y[i] = y << 8;
+    entities->yvel[i] = entity_kinds[kind].yvel;
+    entities->kind[i] = kind;
+    entities->frame[i] = 0;
+    entities->counter[i] = 0;
+    entity_link(entities, i, entity_cell(entities->x[i]));
+    return i;
+}
+
+/* take an entity out, filling its place with the last one */
+void entity_despawn(struct Entities* entities, int i) {
+    entity_unlink(entities, i);
+    int last = --entities->count;
+    if (i == last) {
+        return;
+    }
+    entities->x[i] = entities->x[last];
+    entities->y[i] = entities->y[last];
+    entities->yvel[i] = entities->yvel[last];
+    entities->kind[i] = entities->kind[last];
+    entities->frame[i] = entities->frame[last];
+    entities->counter[i] = entities->counter[last];
+
+    /* the last one keeps its place in its column, under its new index */
+    int prev = entities->prev[last];
+    int next = entities->next[last];
+    entities->cell[i] = entities->cell[last];
+    entities->prev[i] = prev;
+    entities->next[i] = next;
+    if (prev >= 0) {
+        entities->next[prev] = i;
+    } else {
+        entities->head[entities->cell[i]] = i;
+    }
+    if (next >= 0) {
+        entities->prev[next] = i;
+    }
+}
+
+/* bring on a new entity every so often */
+void entities_spawn(struct Entities* entities) {
+    if (--entities->spawn_timer > 0) {
+        return;
+    }
+    entities->spawn_timer = ENTITY_SPAWN_EVERY;
+
+    unsigned int r = entities_random(entities);
+    enum EntityKind kind = (enum EntityKind) ((r >> 8) % ENTITY_KINDS);
+    const struct EntityKindInfo* info = &entity_kinds[kind];
+    int y = info->top + (int) ((r >> 16) % (unsigned int) (info->bottom - info->top + 1));
+    entity_spawn(entities, kind, y);
+}
+
+/* move every entity, bouncing off the edges of its range, and drop the ones
+ * that have gone off the left of the screen */
+void entities_move(struct Entities* entities) {
+    int* x = entities->x;
+    int* y = entities->y;
+    short* yvel = entities->yvel;
+    const unsigned char* kind = entities->kind;
+
+    for (int i = 0; i < entities->count; i++) {
+        const struct EntityKindInfo* info = &entity_kinds[kind[i]];
+
+        /* the ground scrolls a pixel a frame under everything */
+        x[i] += info->xvel - 256;
+        y[i] += yvel[i];
+        if (y[i] < (info->top << 8) || y[i] > (info->bottom << 8)) {
+            yvel[i] = -yvel[i];
+        }
+    }
+
+    /* go backwards so the one moved into a gap has already been looked at */
+    for (int i = entities->count - 1; i >= 0; i--) {
+        if (x[i] < -(16 << 8)) {
+            entity_despawn(entities, i);
+        }
+    }
+}
+
+/* move entities that have crossed into another column to that column's
+ * list. they move a pixel or two a frame, so only a few do each frame */
+void entities_grid(struct Entities* entities) {
+    const int* x = entities->x;
+    const signed char* cell = entities->cell;
+    for (int i = 0; i < entities->count; i++) {
+        int now = entity_cell(x[i]);
+        if (now != cell[i]) {
+            entity_unlink(entities, i);
+            entity_link(entities, i, now);
+        }
+    }
+}
+
+/* whether two boxes overlap, given their corners and sizes in pixels */
+int boxes_overlap(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh) {
+    return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+/* whether entities a and b overlap */
+int entities_overlap(const struct Entities* entities, int a, int b) {
+    const struct EntityKindInfo* ka = &entity_kinds[entities->kind[a]];
+    const struct EntityKindInfo* kb = &entity_kinds[entities->kind[b]];
+    return boxes_overlap(entities->x[a] >> 8, entities->y[a] >> 8, ka->width, ka->height,
+            entities->x[b] >> 8, entities->y[b] >> 8, kb->width, kb->height);
+}
+
+/* two entities have run into each other: unless one is a pickup they bounce
+ * apart, the higher one going up and the lower one down */
+void entities_bounce(struct Entities* entities, int a, int b) {
+    if (entities->kind[a] == ENTITY_PICKUP || entities->kind[b] == ENTITY_PICKUP) {
+        return;
+    }
+    if (entities->y[a] > entities->y[b]) {
+        int swap = a;
+        a = b;
+        b = swap;
+    }
+    short* yvel = entities->yvel;
+    if (yvel[a] > 0) {
+        yvel[a] = -yvel[a];
+    }
+    if (yvel[b] < 0) {
+        yvel[b] = -yvel[b];
+    }
+}
+
+/* find every pair of overlapping entities and bounce them. an entity can
+ * only reach into the column after its own, so each column is only tested
+ * against itself and the next one */
+void entities_collide(struct Entities* entities) {
+    const short* head = entities->head;
+    const short* next = entities->next;
+    const int* x = entities->x;
+    const int* y = entities->y;
+    const unsigned char* kind = entities->kind;
+    int candidates = 0, overlaps = 0;
+
+    for (int c = 0; c < ENTITY_CELLS; c++) {
+        for (int a = head[c]; a >= 0; a = next[a]) {
+            const struct EntityKindInfo* ka = &entity_kinds[kind[a]];
+            int ax = x[a] >> 8, ay = y[a] >> 8;
+            int right = ax + ka->width, bottom = ay + ka->height;
+
+            /* the rest of this column, then all of the next one */
+            int b = next[a];
+            int column = c;
+            for (;;) {
+                if (b < 0) {
+                    if (++column > c + 1 || column >= ENTITY_CELLS) {
+                        break;
+                    }
+                    b = head[column];
+                    continue;
+                }
+                candidates++;
+                const struct EntityKindInfo* kb = &entity_kinds[kind[b]];
+                int bx = x[b] >> 8, by = y[b] >> 8;
+                if (ax < bx + kb->width && bx < right && ay < by + kb->height && by < bottom) {
+                    overlaps++;
+                    entities_bounce(entities, a, b);
+                }
+                b = next[b];
+            }
+        }
+    }
+    entities->candidates = candidates;
+    entities->overlaps = overlaps;
+}
+
+/* the dragon picks up the pickups it touches for a point each, and loses a
+ * point to each enemy or obstacle it runs into, which gets knocked away */
+void entities_hit_dragon(struct Entities* entities, const struct Dragon* dragon,
+        struct Score* score) {
+    int dx = dragon->x >> 8, dy = dragon->y >> 8;
+
+    /* gather the entities it touches from the columns it reaches */
+    short hits[ENTITY_CAPACITY];
+    int count = 0;
+    int first = entity_cell((dx - 15) << 8), last = entity_cell((dx + 15) << 8);
+    for (int c = first; c <= last; c++) {
+        for (int i = entities->head[c]; i >= 0; i = entities->next[i]) {
+            const struct EntityKindInfo* info = &entity_kinds[entities->kind[i]];
+            if (boxes_overlap(dx, dy, 16, 16, entities->x[i] >> 8, entities->y[i] >> 8,
+                        info->width, info->height)) {
+                hits[count++] = i;
+            }
+        }
+    }
+    entities->dragon_hits = count;
+
+    /* take them out highest index first, so despawning one never moves
+     * another that is still to be taken out */
+    for (int j = 1; j < count; j++) {
+        for (int k = j; k > 0 && hits[k] > hits[k - 1]; k--) {
+            short swap = hits[k];
+            hits[k] = hits[k - 1];
+            hits[k - 1] = swap;
+        }
+    }
+    int damage = 0;
+    for (int j = 0; j < count; j++) {
+        if (entities->kind[hits[j]] == ENTITY_PICKUP) {
+            score->total += 1;
+        } else {
+            damage++;
+            if (score->total > 0) {
+                score->total -= 1;
+            }
+        }
+        score->lap = (score->total / 3) + 1;
+        entity_despawn(entities, hits[j]);
+    }
+    entities->dragon_damage = damage;
+}
+
+/* move every entity's animation on */
+void entities_animate(struct Entities* entities) {
+    unsigned char* frame = entities->frame;
+    unsigned char* counter = entities->counter;
+    const unsigned char* kind = entities->kind;
+
+    for (int i = 0; i < entities->count; i++) {
+        const struct EntityKindInfo* info = &entity_kinds[kind[i]];
+        if (++counter[i] >= info->animation_delay) {
+            counter[i] = 0;
+            if (++frame[i] >= info->frames) {
+                frame[i] = 0;
+            }
+        }
+    }
+}
+
+/* write every entity into its sprite, and hide the sprites of any that have
+ * gone since the last sync */
+void entities_sync(struct Entities* entities, struct Oam* oam) {
+    struct Sprite* sprite = &oam->sprites[entities->first_sprite];
+    const int* x = entities->x;
+    const int* y = entities->y;
+    const unsigned char* kind = entities->kind;
+    const unsigned char* frame = entities->frame;
+
+    for (int i = 0; i < entities->count; i++) {
+        const struct EntityKindInfo* info = &entity_kinds[kind[i]];
+        sprite[i].attribute0 = ((y[i] >> 8) & 0xff) | (1 << 13) | (info->shape << 14);
+        sprite[i].attribute1 = ((x[i] >> 8) & 0x1ff) | (info->horizontal_flip << 12) |
+            (info->vertical_flip << 13) | (info->size << 14);
+        sprite[i].attribute2 = info->tiles[frame[i]];
+    }
+    for (int i = entities->count; i < entities->shown; i++) {
+        sprite[i].attribute0 = SCREEN_HEIGHT;
+        sprite[i].attribute1 = SCREEN_WIDTH;
+    }
+    entities->shown = entities->count;
+}
+
+/////////////Game
+
+/* bump this whenever struct Game changes shape, so old snapshots get refused */
+#define GAME_STATE_VERSION 7
+
+/* everything the game is made of, kept in one block of plain data with no
+ * pointers into itself. that makes a snapshot a fixed-size copy, and the hash
+ * a single pass over its words */
+struct Game {
+    /* GAME_STATE_VERSION when the block was made */
+    unsigned int version;
+
+    /* the number of frames stepped so far */
+    int frames;
+
+    /* how far the ground layer has scrolled, in pixels */
+    int xscroll;
+
+    /* the next column of a streamed level to unpack, 0 on a fixed map.
+     * the columns themselves are in the streamer's ring, which a restore
+     * does not touch, so level_streamer_sync() unpacks them again to match */
+    int ground_next;
+
+    struct Dragon dragon;
+    struct Score score;
+
+    /* the enemies, obstacles and pickups */
+    struct Entities entities;
+
+    /* the shadow sprite table */
+    struct Oam oam;
+
+    /* the map the dragon collides against. this points outside the block,
+     * into ROM or at a streamed level's ring, so it is the same in every
+     * copy, and it comes last so the hash can leave it out */
+    const struct Tilemap* ground;
+};
+
+/* the hash covers every word before the ground pointer */
+#define GAME_HASHED_WORDS (offsetof(struct Game, ground) / 4)
+
+/* set up a fresh game on the given ground map */
+void game_init(struct Game* game, const struct Tilemap* ground) {
+    /* zero the whole block first so the padding hashes the same everywhere */
+    unsigned int* words = (unsigned int*) game;
+    for (unsigned int i = 0; i < sizeof(struct Game) / 4; i++) {
+        words[i] = 0;
+    }
+    game->version = GAME_STATE_VERSION;
+
+    /* clear all the sprites first so the dragon gets sprite 0 */
+    sprite_clear(&game->oam);
+
+    /* create the dragon */
+    dragon_init(&game->dragon, &game->oam);
+
+    /* create the score */
+    score_init(&game->score, &game->oam);
+
+    /* keep sprites for the entities */
+    entities_init(&game->entities, &game->oam);
+
+    /* set initial scroll to 1 */
+    game->xscroll = 1;
+
+    game->ground = ground;
+    game->frames = 0;
+}
+
+/* advance the game one frame given the buttons held down (BUTTON_ bits set
+ * for pressed buttons), returns whether the dragon is still alive */
+int game_step(struct Game* game, unsigned short keys) {
+    if (!game->dragon.alive) {
+        return 0;
+    }
+
+    /*scroll continuously*/
+    game->xscroll++;
+
+    /* update the dragon */
+    GAME_ZONE_BEGIN(PROFILE_DRAGON_UPDATE);
+    dragon_update(&game->dragon, &game->score, &game->oam, game->xscroll, game->ground);
+    GAME_ZONE_END(PROFILE_DRAGON_UPDATE);
+    /* update the score */
+    GAME_ZONE_BEGIN(PROFILE_SCORE_UPDATE);
+    score_update(&game->score, &game->dragon, &game->oam, game->xscroll, game->ground);
+    GAME_ZONE_END(PROFILE_SCORE_UPDATE);
+
+    /* run the entity passes */
+    GAME_ZONE_BEGIN(PROFILE_ENTITY_SPAWN);
+    entities_spawn(&game->entities);
+    GAME_ZONE_END(PROFILE_ENTITY_SPAWN);
+    GAME_ZONE_BEGIN(PROFILE_ENTITY_MOVE);
+    entities_move(&game->entities);
+    GAME_ZONE_END(PROFILE_ENTITY_MOVE);
+    GAME_ZONE_BEGIN(PROFILE_ENTITY_COLLIDE);
+    entities_grid(&game->entities);
+    entities_collide(&game->entities);
+    entities_hit_dragon(&game->entities, &game->dragon, &game->score);
+    GAME_ZONE_END(PROFILE_ENTITY_COLLIDE);
+    GAME_ZONE_BEGIN(PROFILE_ENTITY_ANIMATE);
+    entities_animate(&game->entities);
+    GAME_ZONE_END(PROFILE_ENTITY_ANIMATE);
+    GAME_ZONE_BEGIN(PROFILE_ENTITY_SYNC);
+    entities_sync(&game->entities, &game->oam);
+    GAME_ZONE_END(PROFILE_ENTITY_SYNC);
+
+    /* check if they're flapping*/
+    if (keys & BUTTON_A) {
+        flap(&game->dragon, &game->oam);
+    }
+
+    game->frames++;
+    return game->dragon.alive;
+}
+
+/* take a snapshot of a game */
+void game_save(struct Game* snapshot, const struct Game* game) {
+    *snapshot = *game;
+}
+
+/* put a game back the way a snapshot has it, returns 0 and leaves the game
+ * alone if the snapshot was made by a different version */
+int game_restore(struct Game* game, const struct Game* snapshot) {
+    if (snapshot->version != GAME_STATE_VERSION) {
+        return 0;
+    }
+    *game = *snapshot;
+    return 1;
+}
+
+/* hash the whole game state a word at a time, for checking two runs of the
+ * same inputs or two consoles have not drifted apart. four lanes run side by
+ * side so the multiplies do not all wait on each other */
+#define GAME_HASH_MIX(lane, word) \
+    lane = (lane ^ (word)) * 0x9e3779b1u; \
+    lane ^= lane >> 15
+
+unsigned int game_hash(const struct Game* game) {
+    const unsigned int* words = (const unsigned int*) game;
+    unsigned int a = 2166136261u, b = 0x85ebca6bu, c = 0xc2b2ae35u, d = 0x27d4eb2fu;
+    unsigned int i = 0;
+    for (; i + 4 <= GAME_HASHED_WORDS; i += 4) {
+        GAME_HASH_MIX(a, words[i]);
+        GAME_HASH_MIX(b, words[i + 1]);
+        GAME_HASH_MIX(c, words[i + 2]);
+        GAME_HASH_MIX(d, words[i + 3]);
+    }
+    for (; i < GAME_HASHED_WORDS; i++) {
+        GAME_HASH_MIX(a, words[i]);
+    }
+
+    /* fold the lanes together */
+    GAME_HASH_MIX(a, b);
+    GAME_HASH_MIX(a, c);
+    GAME_HASH_MIX(a, d);
+    return a;
+}
@@ -0,0 +1,305 @@
+/* ghost.h
+ * the best run so far, kept in the cartridge's SRAM and flown again beside
+ * the dragon as a see-through ghost.
+ *
+ * SRAM only takes byte reads and writes, and slowly. it holds two slots,
+ * one with the best run in and one for the run being played. a slot is a
+ * GhostHeader and then the run's keys, a bit a frame for A, which is all
+ * game_step() looks at, from the low bit of each byte up. the header goes
+ * in after every key byte and its checksum covers the keys, so a slot whose
+ * write never finished does not load. of the slots that load, the one with
+ * the highest sequence is the best.
+ *
+ * the keys are packed in work RAM as the run is played and a background
+ * task writes them out a slice at a time, a byte every 8 frames, so no
+ * frame ever waits on SRAM. when the dragon goes down the run is kept only
+ * if it beats the best, with the last of its keys and then its header going
+ * out the same way.
+ *
+ * the ghost is a dragon of his own with a sprite table of his own, stepped
+ * with dragon_update() and flap() against the same ground at the same
+ * scroll, reading the best run's keys back from SRAM a bit a frame. only
+ * the ground can bring the dragon down, so he flies just as he did, for one
+ * dragon_update() a frame, and goes once he is down or his keys run out.
+ *
+ * this needs game.h */
+
+#define GHOST_MAGIC "PHGH"
+
+/* two slots of 16K */
+#define GHOST_SLOTS 2
+#define GHOST_SLOT_BYTES 0x4000
+
+/* the most bytes written to SRAM in one background slice */
+#define GHOST_SLICE_BYTES 64
+
+struct GhostHeader {
+    char magic[4];
+
+    /* GAME_STATE_VERSION when the run was played, since a run is only
+     * worth flying again under the same rules */
+    unsigned int version;
+
+    /* which run is newer, the length and the score */
+    unsigned int sequence;
+    unsigned int frames;
+    int total;
+
+    /* over the keys, then the header up to here */
+    unsigned int checksum;
+};
+
+#define GHOST_KEY_BYTES (GHOST_SLOT_BYTES - (int) sizeof(struct GhostHeader))
+#define GHOST_MAX_FRAMES (GHOST_KEY_BYTES * 8)
+
+/* how this run's save is going */
+enum GhostSaveState {
+    GHOST_RECORDING,    /* being played, writing keys out as they fill */
+    GHOST_KEEPING,      /* down and better, writing the rest and the header */
+    GHOST_SAVED,        /* in SRAM for next time */
+    GHOST_DROPPED,      /* not better, or too long to keep */
+};
+
+struct Ghost {
+    volatile unsigned char* sram;
+
+    /* the best run in SRAM, or -1 if there is none */
+    int best_slot;
+    struct GhostHeader best;
+
+    /* this run: its slot, its keys, how many of them have been written and
+     * the checksum of those */
+    int slot;
+    int state;
+    int cleared;
+    unsigned int frames;
+    int total;
+    unsigned int written;
+    unsigned int checksum;
+    unsigned char keys[GHOST_KEY_BYTES];
+
+    /* the ghost, where his keys start in SRAM and how many there are */
+    struct Dragon dragon;
+    struct Score score;
+    struct Oam oam;
+    unsigned int play_keys;
+    unsigned int play_frames;
+    unsigned int played;
+    int showing;
+
+    /* bytes written to SRAM, the slices they took and the most in one */
+    unsigned int bytes;
+    unsigned int slices;
+    unsigned int worst;
+};
+
+/* one byte more of an FNV-1a hash */
+unsigned int ghost_hash(unsigned int hash, unsigned char byte) {
+    return (hash ^ byte) * 16777619u;
+}
+
+#define GHOST_HASH_START 2166136261u
+
+/* where a slot starts in SRAM, and its keys after the header */
+unsigned int ghost_slot_offset(int slot) {
+    return slot * GHOST_SLOT_BYTES;
+}
+
+unsigned int ghost_keys_offset(int slot) {
+    return ghost_slot_offset(slot) + sizeof(struct GhostHeader);
+}
+
+/* the checksum of a header's own fields, on top of its keys' */
+unsigned int ghost_header_hash(unsigned int hash, const struct GhostHeader* header) {
+    const unsigned char* bytes = (const unsigned char*) header;
+    for (unsigned int i = 0; i < offsetof(struct GhostHeader, checksum); i++) {
+        hash = ghost_hash(hash, bytes[i]);
+    }
+    return hash;
+}
+
+/* read a slot's header, returns 1 if it holds a whole run played under
+ * these rules */
+int ghost_slot_load(const struct Ghost* ghost, int slot, struct GhostHeader* header) {
+    unsigned char* bytes = (unsigned char*) header;
+    unsigned int at = ghost_slot_offset(slot);
+    for (unsigned int i = 0; i < sizeof(*header); i++) {
+        bytes[i] = ghost->sram[at + i];
+    }
+    for (int i = 0; i < 4; i++) {
+        if (header->magic[i] != GHOST_MAGIC[i]) {
+            return 0;
+        }
+    }
+    if (header->version != GAME_STATE_VERSION ||
+            header->frames == 0 || header->frames > GHOST_MAX_FRAMES) {
+        return 0;
+    }
+    unsigned int hash = GHOST_HASH_START;
+    unsigned int keys = ghost_keys_offset(slot);
+    for (unsigned int i = 0; i < (header->frames + 7) / 8; i++) {
+        hash = ghost_hash(hash, ghost->sram[keys + i]);
+    }
+    return ghost_header_hash(hash, header) == header->checksum;
+}
+
+/* get the ghost ready to fly the best run from the start */
+void ghost_start(struct Ghost* ghost) {
+    sprite_clear(&ghost->oam);
+    dragon_init(&ghost->dragon, &ghost->oam);
+    score_init(&ghost->score, &ghost->oam);
+    ghost->played = 0;
+    ghost->showing = ghost->best_slot >= 0;
+    ghost->play_keys = ghost->showing ? ghost_keys_offset(ghost->best_slot) : 0;
+    ghost->play_frames = ghost->showing ? ghost->best.frames : 0;
+}
+
+/* find the best run in SRAM, start recording this one into the other slot,
+ * and have the ghost fly the best */
+void ghost_init(struct Ghost* ghost, volatile unsigned char* sram) {
+    ghost->sram = sram;
+    ghost->best_slot = -1;
+    for (int slot = 0; slot < GHOST_SLOTS; slot++) {
+        struct GhostHeader header;
+        if (ghost_slot_load(ghost, slot, &header) &&
+                (ghost->best_slot < 0 || header.sequence > ghost->best.sequence)) {
+            ghost->best_slot = slot;
+            ghost->best = header;
+        }
+    }
+
+    ghost->slot = ghost->best_slot < 0 ? 0 : (ghost->best_slot + 1) % GHOST_SLOTS;
+    ghost->state = GHOST_RECORDING;
+    ghost->cleared = 0;
+    ghost->frames = 0;
+    ghost->total = 0;
+    ghost->written = 0;
+    ghost->checksum = GHOST_HASH_START;
+    for (int i = 0; i < GHOST_KEY_BYTES; i++) {
+        ghost->keys[i] = 0;
+    }
+    ghost->bytes = 0;
+    ghost->slices = 0;
+    ghost->worst = 0;
+    ghost_start(ghost);
+}
+
+/* note the keys of a frame of this run, returns 1 if that filled a byte
+ * there is to write */
+int ghost_record(struct Ghost* ghost, unsigned short keys) {
+    if (ghost->state != GHOST_RECORDING) {
+        return 0;
+    }
+    if (ghost->frames >= GHOST_MAX_FRAMES) {
+        ghost->state = GHOST_DROPPED;
+        return 0;
+    }
+    if (keys & BUTTON_A) {
+        ghost->keys[ghost->frames >> 3] |= 1 << (ghost->frames & 7);
+    }
+    ghost->frames++;
+    return (ghost->frames & 7) == 0;
+}
+
+/* the run is over: keep it if it beats the best. returns 1 if there is
+ * saving to do */
+int ghost_finish(struct Ghost* ghost, int total) {
+    if (ghost->state != GHOST_RECORDING) {
+        return 0;
+    }
+    ghost->total = total;
+    const struct GhostHeader* best = &ghost->best;
+    int better = ghost->best_slot < 0 || total > best->total ||
+        (total == best->total && ghost->frames > best->frames);
+    ghost->state = better && ghost->frames ? GHOST_KEEPING : GHOST_DROPPED;
+    return ghost->state == GHOST_KEEPING;
+}
+
+/* write one slice of the run to SRAM, returns nonzero while there is more */
+int ghost_save(struct Ghost* ghost) {
+    if (ghost->state != GHOST_RECORDING && ghost->state != GHOST_KEEPING) {
+        return 0;
+    }
+    volatile unsigned char* sram = ghost->sram;
+    int budget = GHOST_SLICE_BYTES;
+
+    /* whatever was in the slot before stops loading before its keys are
+     * written over */
+    if (!ghost->cleared) {
+        unsigned int at = ghost_slot_offset(ghost->slot);
+        for (int i = 0; i < 4; i++) {
+            sram[at + i] = 0;
+        }
+        ghost->cleared = 1;
+        budget -= 4;
+    }
+
+    /* the bytes filled so far, or every byte once the run is being kept */
+    unsigned int ready = ghost->state == GHOST_KEEPING ? (ghost->frames + 7) / 8 : ghost->frames / 8;
+    unsigned int keys = ghost_keys_offset(ghost->slot);
+    while (ghost->written < ready && budget > 0) {
+        unsigned char byte = ghost->keys[ghost->written];
+        sram[keys + ghost->written] = byte;
+        ghost->checksum = ghost_hash(ghost->checksum, byte);
+        ghost->written++;
+        budget--;
+    }
+
+    /* the header last of all, in a slice of its own */
+    int more = ghost->written < ready;
+    if (!more && ghost->state == GHOST_KEEPING) {
+        if (budget < (int) sizeof(struct GhostHeader)) {
+            more = 1;
+        } else {
+            struct GhostHeader header;
+            for (int i = 0; i < 4; i++) {
+                header.magic[i] = GHOST_MAGIC[i];
+            }
+            header.version = GAME_STATE_VERSION;
+            header.sequence = ghost->best_slot < 0 ? 1 : ghost->best.sequence + 1;
+            header.frames = ghost->frames;
+            header.total = ghost->total;
+            header.checksum = ghost_header_hash(ghost->checksum, &header);
+            const unsigned char* bytes = (const unsigned char*) &header;
+            unsigned int at = ghost_slot_offset(ghost->slot);
+            for (unsigned int i = 0; i < sizeof(header); i++) {
+                sram[at + i] = bytes[i];
+            }
+            budget -= sizeof(header);
+            ghost->best = header;
+            ghost->best_slot = ghost->slot;
+            ghost->state = GHOST_SAVED;
+        }
+    }
+
+    unsigned int used = GHOST_SLICE_BYTES - budget;
+    ghost->bytes += used;
+    ghost->slices++;
+    if (used > ghost->worst) {
+        ghost->worst = used;
+    }
+    return more;
+}
+
+/* fly the ghost on a frame, after the game has stepped to the given
+ * scroll */
+void ghost_step(struct Ghost* ghost, int xscroll, const struct Tilemap* map) {
+    if (!ghost->showing) {
+        return;
+    }
+    unsigned int played = ghost->played;
+    int flapping = (ghost->sram[ghost->play_keys + (played >> 3)] >> (played & 7)) & 1;
+    dragon_update(&ghost->dragon, &ghost->score, &ghost->oam, xscroll, map);
+    if (flapping) {
+        flap(&ghost->dragon, &ghost->oam);
+    }
+    ghost->played = played + 1;
+    if (!ghost->dragon.alive || ghost->played >= ghost->play_frames) {
+        ghost->showing = 0;
+    }
+}
+
+/* the ghost's sprite, in his own table, or 0 once he has gone */
+const struct Sprite* ghost_sprite(const struct Ghost* ghost) {
+    return ghost->showing ? &ghost->oam.sprites[ghost->dragon.sprite] : 0;
+}
@@ -0,0 +1,155 @@
+/* input.h
+ * the keypad, read once a frame. input_latch() is called at the same point
+ * in every frame, in vblank straight after the sprites go out, and works out
+ * which keys went down and came up since the frame before. the keypad
+ * interrupt can also stamp the moment a watched key goes down, so the time
+ * from a press to the sprites that show it can be measured in scanlines.
+ *
+ * this uses the interrupt registers from link.h and the cycle counter from
+ * profile.h */
+
+/* the button register holds the bits which indicate whether each button has
+ * been pressed, with a 0 for pressed */
+volatile unsigned short* buttons = (volatile unsigned short*) 0x04000130;
+
+/* the keypad interrupt control register */
+volatile unsigned short* keypad_control = (volatile unsigned short*) 0x4000132;
+
+/* keypad control flags, and all ten keys */
+#define KEYPAD_IRQ 0x4000
+#define KEYPAD_ALL 0x3ff
+
+/* the keypad bit in the interrupt registers */
+#define INTERRUPT_KEYPAD 0x1000
+
+struct Input {
+    /* keys down at this latch and the last one, with a 1 for down */
+    unsigned short held;
+    unsigned short previous;
+
+    /* keys that went down and came up between the two */
+    unsigned short pressed;
+    unsigned short released;
+
+    /* the keys the interrupt watches, and the cycle count at the latch */
+    unsigned short watched;
+    unsigned int latched_at;
+
+    /* the cycle count when a watched key went down, set by the interrupt */
+    volatile unsigned int press_at;
+    volatile int stamped;
+
+    /* a press on its way to the screen, and when it started */
+    int tracking;
+    unsigned int track_start;
+
+    /* press to sprites committed, in scanlines: the last, the worst and the
+     * total over all presses. missed counts taps that came and went between
+     * two latches, so never reached the game */
+    unsigned int latency;
+    unsigned int worst_latency;
+    unsigned int total_latency;
+    unsigned int presses;
+    unsigned int missed;
+};
+
+struct Input input;
+
+/* arm the keypad interrupt to go off when any watched key goes down */
+void input_arm() {
+    *keypad_control = KEYPAD_IRQ | input.watched;
+}
+
+/* get ready, stamping presses of the given keys with the keypad interrupt,
+ * or none if watched is 0 */
+void input_init(unsigned short watched) {
+    input.held = 0;
+    input.previous = 0;
+    input.pressed = 0;
+    input.released = 0;
+    input.watched = watched;
+    input.stamped = 0;
+    input.tracking = 0;
+    input.latency = 0;
+    input.worst_latency = 0;
+    input.total_latency = 0;
+    input.presses = 0;
+    input.missed = 0;
+
+    if (watched) {
+        input_arm();
+        *interrupt_enable |= INTERRUPT_KEYPAD;
+        *interrupt_master = 1;
+    } else {
+        *keypad_control = 0;
+    }
+}
+
+/* the keypad interrupt. it keeps going off for as long as the key is held,
+ * so it turns itself off until the next latch finds the keys up again */
+void input_interrupt() {
+    if (!input.stamped) {
+        input.press_at = profile_cycles();
+        input.stamped = 1;
+    }
+    *keypad_control = 0;
+}
+
+/* read the keypad and work out what changed since the last latch */
+void input_latch() {
+    /* keep the interrupt out while the stamp is looked at */
+    *interrupt_master = 0;
+    input.previous = input.held;
+    input.held = ~*buttons & KEYPAD_ALL;
+    input.latched_at = profile_cycles();
+    int stamped = input.stamped;
+    unsigned int press_at = input.press_at;
+    input.stamped = 0;
+    if (input.watched && !(input.held & input.watched)) {
+        input_arm();
+    }
+    *interrupt_master = 1;
+
+    input.pressed = input.held & ~input.previous;
+    input.released = input.previous & ~input.held;
+
+    /* follow a watched press through to the screen, from when the
+     * interrupt saw it go down if it did, or else from now */
+    if (input.pressed & input.watched) {
+        input.tracking = 1;
+        input.track_start = stamped ? press_at : input.latched_at;
+    } else if (stamped && !(input.held & input.watched)) {
+        input.missed++;
+    }
+}
+
+/* the sprites for this frame have gone out, so a press latched last frame
+ * is now on screen */
+void input_committed() {
+    if (!input.tracking) {
+        return;
+    }
+    input.tracking = 0;
+    input.latency = (profile_cycles() - input.track_start) / CYCLES_PER_SCANLINE;
+    input.total_latency += input.latency;
+    input.presses++;
+    if (input.latency > input.worst_latency) {
+        input.worst_latency = input.latency;
+    }
+}
+
+/* log the press to screen latency */
+void input_report() {
+    char line[128];
+    char* end = debug_append(line, "input: latency ");
+    end = debug_append_number(end, input.latency);
+    end = debug_append(end, " worst ");
+    end = debug_append_number(end, input.worst_latency);
+    end = debug_append(end, " avg ");
+    end = debug_append_number(end, input.presses ? input.total_latency / input.presses : 0);
+    end = debug_append(end, " scanlines, presses ");
+    end = debug_append_number(end, input.presses);
+    end = debug_append(end, " missed ");
+    debug_append_number(end, input.missed);
+    debug_print(line);
+}
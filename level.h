@@ -0,0 +1,259 @@
+/* level.h
+ * levels longer than a screen block, kept in ROM as compressed columns and
+ * streamed in as the ground scrolls.
+ *
+ * a level is a run of columns 32 tiles tall, each one packed on its own and
+ * found through a column index, so any column can be unpacked without the
+ * ones before it, and columns that come out the same share their bytes. a
+ * column is a list of runs going down it, each a byte holding the run's
+ * length less one in its low 5 bits, then the map entry: one byte if the
+ * top bit of the run byte is clear, or two, low byte first, if it is set.
+ * mklevel in the tools writes them.
+ *
+ * the streamer keeps the 64 columns around the screen in a ring, the same
+ * width as a 64x32 pair of screen blocks, so column c of the level is
+ * column c & 63 of both the ring and the screen, and the background's own
+ * wrap at 512 pixels lines up with it. the ring is a Tilemap the dragon
+ * collides against, so the collision data moves along with the picture.
+ *
+ * each update unpacks columns until it is LEVEL_AHEAD columns past the left
+ * of the screen, but no more than LEVEL_COLUMNS_PER_UPDATE of them, so the
+ * cost of a frame stays bounded however long the level is. only if it has
+ * fallen so far behind that a column on the screen is missing does it go
+ * over, and that is counted. unpacked columns wait to be written into the
+ * screen blocks in vblank, a 2 byte store a tile as a column is not one
+ * run of memory. past its last column the level starts again from the
+ * first, as the shipped map does.
+ *
+ * the ring is outside the game's block, but which columns it holds only
+ * depends on the next one to unpack, and the game keeps that in its
+ * ground_next. when a restored game's differs from the streamer's, the
+ * columns that changed are unpacked again before anything else, in any
+ * order since each column stands alone.
+ *
+ * this needs game.h for the Tilemap and the Game */
+
+/* the height of a level, and the width of the ring and the screen blocks */
+#define LEVEL_ROWS 32
+#define LEVEL_RING 64
+
+/* how far past the left of the screen the ring is kept filled, in columns.
+ * the screen shows 31, and the rest of the ring behind it keeps the columns
+ * a rollback might scroll back to */
+#define LEVEL_AHEAD 40
+
+/* the most columns one update unpacks, unless the screen needs more */
+#define LEVEL_COLUMNS_PER_UPDATE 2
+
+/* the most unpacked columns that can be waiting for vblank */
+#define LEVEL_PENDING 8
+
+/* the run byte */
+#define LEVEL_RUN_LENGTH 0x1f
+#define LEVEL_RUN_WIDE 0x80
+
+/* a level as it is kept in ROM */
+struct Level {
+    /* the packed columns, where each starts in them, and how many */
+    const unsigned char* data;
+    const unsigned int* index;
+    int width;
+};
+
+struct LevelStreamer {
+    const struct Level* level;
+
+    /* the columns around the screen, a row of LEVEL_RING at a time, what
+     * is in each of them, and the map the game collides against, which
+     * points at both */
+    unsigned short ring[LEVEL_ROWS * LEVEL_RING];
+    struct TileColumn known[LEVEL_RING];
+    struct Tilemap map;
+
+    /* the next level column to unpack, counting on past the level's width
+     * as the ground goes round */
+    int next;
+
+    /* ring columns unpacked but not yet written to the screen, and
+     * whether more changed than that at once so all of them have to go */
+    unsigned char pending[LEVEL_PENDING];
+    int pending_count;
+    int refill;
+
+    /* columns unpacked on the last update, the most on any update and the
+     * total, the packed bytes read, and updates that had to go over the
+     * limit because the screen had caught up */
+    int columns;
+    int worst;
+    unsigned int total;
+    unsigned int bytes;
+    unsigned int late;
+};
+
+/* unpack one column of a level into dest, a tile every stride entries.
+ * returns the packed bytes it took */
+int level_column_unpack(const struct Level* level, int column, unsigned short* dest, int stride) {
+    const unsigned char* start = level->data + level->index[column];
+    const unsigned char* p = start;
+    int row = 0;
+    while (row < LEVEL_ROWS) {
+        unsigned char run = *p++;
+        unsigned short entry = *p++;
+        if (run & LEVEL_RUN_WIDE) {
+            entry |= *p++ << 8;
+        }
+        int length = (run & LEVEL_RUN_LENGTH) + 1;
+        if (length > LEVEL_ROWS - row) {
+            length = LEVEL_ROWS - row;
+        }
+        while (length--) {
+            dest[row++ * stride] = entry;
+        }
+    }
+    return p - start;
+}
+
+/* unpack the next column into the ring, and put it on the list for the
+ * screen. returns 0 if the list is full, unless the whole ring is going
+ * anyway */
+int level_streamer_unpack(struct LevelStreamer* streamer) {
+    if (streamer->pending_count >= LEVEL_PENDING && !streamer->refill) {
+        return 0;
+    }
+    int slot = streamer->next & (LEVEL_RING - 1);
+    int column = streamer->next % streamer->level->width;
+    streamer->bytes += level_column_unpack(streamer->level, column, streamer->ring + slot, LEVEL_RING);
+    tilemap_column(&streamer->map, slot);
+    if (!streamer->refill) {
+        streamer->pending[streamer->pending_count++] = slot;
+    }
+    streamer->next++;
+    return 1;
+}
+
+/* put the ring back the way it is when next is the next column to unpack,
+ * queueing the slots that change for the screen */
+void level_streamer_seek(struct LevelStreamer* streamer, int next) {
+    /* the ring holds the LEVEL_RING columns before next, so only those it
+     * does not hold already need unpacking */
+    int first, last;
+    if (next < streamer->next) {
+        first = next - LEVEL_RING;
+        last = streamer->next - LEVEL_RING < next ? streamer->next - LEVEL_RING : next;
+    } else {
+        first = next - LEVEL_RING > streamer->next ? next - LEVEL_RING : streamer->next;
+        last = next;
+    }
+    for (int column = first; column < last; column++) {
+        int slot = column & (LEVEL_RING - 1);
+        if (column < 0) {
+            /* before the start of the level, where the ring starts out empty */
+            for (int row = 0; row < LEVEL_ROWS; row++) {
+                streamer->ring[row * LEVEL_RING + slot] = 0;
+            }
+        } else {
+            streamer->bytes += level_column_unpack(streamer->level, column % streamer->level->width,
+                    streamer->ring + slot, LEVEL_RING);
+        }
+        tilemap_column(&streamer->map, slot);
+        if (streamer->pending_count < LEVEL_PENDING) {
+            streamer->pending[streamer->pending_count++] = slot;
+        } else {
+            streamer->refill = 1;
+        }
+    }
+    streamer->next = next;
+}
+
+/* bring the ring to where the game is in the level, after it has been
+ * restored from a snapshot. call before stepping a restored game */
+void level_streamer_sync(struct LevelStreamer* streamer, const struct Game* game) {
+    if (game->ground_next != streamer->next) {
+        level_streamer_seek(streamer, game->ground_next);
+    }
+}
+
+/* move the columns on for the game's scroll, and keep its place in the
+ * level. returns how many were unpacked */
+int level_streamer_update(struct LevelStreamer* streamer, struct Game* game) {
+    level_streamer_sync(streamer, game);
+
+    int left = game->xscroll >> 3;
+    int want = left + LEVEL_AHEAD;
+
+    /* the last column any of the screen shows */
+    int needed = left + SCREEN_WIDTH / 8;
+
+    int columns = 0;
+    while (streamer->next <= want) {
+        if (columns >= LEVEL_COLUMNS_PER_UPDATE && streamer->next > needed) {
+            break;
+        }
+        if (!level_streamer_unpack(streamer)) {
+            break;
+        }
+        columns++;
+    }
+    if (columns > LEVEL_COLUMNS_PER_UPDATE) {
+        streamer->late++;
+    }
+    streamer->columns = columns;
+    streamer->total += columns;
+    if (columns > streamer->worst) {
+        streamer->worst = columns;
+    }
+    game->ground_next = streamer->next;
+    return columns;
+}
+
+/* write the waiting columns into a pair of screen blocks, the left 32
+ * columns in the first and the right 32 in the second. call in vblank */
+void level_streamer_commit(struct LevelStreamer* streamer, volatile unsigned short* screen) {
+    int count = streamer->refill ? LEVEL_RING : streamer->pending_count;
+    for (int i = 0; i < count; i++) {
+        int slot = streamer->refill ? i : streamer->pending[i];
+        volatile unsigned short* dest = screen + (slot >> 5) * 32 * 32 + (slot & 31);
+        const unsigned short* source = streamer->ring + slot;
+        for (int row = 0; row < LEVEL_ROWS; row++) {
+            dest[row * 32] = source[row * LEVEL_RING];
+        }
+    }
+    streamer->pending_count = 0;
+    streamer->refill = 0;
+}
+
+/* start streaming a level for the game, filling the ring and the screen
+ * straight away, and have the game collide against it */
+void level_streamer_init(struct LevelStreamer* streamer, const struct Level* level,
+        volatile unsigned short* screen, struct Game* game) {
+    int xscroll = game->xscroll;
+    streamer->level = level;
+    for (int i = 0; i < LEVEL_ROWS * LEVEL_RING; i++) {
+        streamer->ring[i] = 0;
+    }
+    streamer->map.tiles = streamer->ring;
+    streamer->map.width = LEVEL_RING;
+    streamer->map.height = LEVEL_ROWS;
+    streamer->map.columns = streamer->known;
+    tilemap_columns(&streamer->map);
+    streamer->next = (xscroll >> 3) + LEVEL_AHEAD - LEVEL_RING + 1;
+    if (streamer->next < 0) {
+        streamer->next = 0;
+    }
+    streamer->pending_count = 0;
+    streamer->refill = 0;
+    while (streamer->next <= (xscroll >> 3) + LEVEL_AHEAD) {
+        level_streamer_unpack(streamer);
+        if (streamer->pending_count == LEVEL_PENDING) {
+            level_streamer_commit(streamer, screen);
+        }
+    }
+    level_streamer_commit(streamer, screen);
+    streamer->columns = 0;
+    streamer->worst = 0;
+    streamer->total = 0;
+    streamer->bytes = 0;
+    streamer->late = 0;
+    game->ground = &streamer->map;
+    game->ground_next = streamer->next;
+}
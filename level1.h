@@ -0,0 +1,270 @@
+/* created by mklevel */
+
+#define level1_width 512
+
+const unsigned int level1_index [] = {
+    0, 10, 40, 70, 80, 96, 114, 132, 0, 0, 70, 148, 
+    70, 158, 182, 70, 148, 0, 70, 148, 0, 70, 148, 0, 
+    210, 220, 252, 210, 0, 70, 0, 0, 278, 286, 316, 346, 
+    354, 362, 354, 362, 278, 278, 346, 354, 346, 278, 370, 400, 
+    354, 278, 346, 354, 278, 346, 354, 278, 362, 430, 460, 362, 
+    278, 346, 278, 278, 278, 490, 520, 346, 354, 362, 354, 362, 
+    278, 278, 346, 354, 346, 278, 550, 582, 354, 278, 346, 354, 
+    278, 346, 354, 278, 362, 354, 614, 644, 278, 346, 278, 278, 
+    278, 346, 674, 704, 354, 362, 354, 362, 278, 278, 346, 354, 
+    346, 278, 346, 346, 734, 766, 346, 354, 278, 346, 354, 278, 
+    362, 354, 278, 798, 828, 346, 278, 278, 278, 346, 278, 858, 
+    888, 362, 354, 362, 278, 278, 346, 354, 346, 278, 346, 346, 
+    918, 316, 346, 354, 278, 346, 354, 278, 362, 354, 278, 948, 
+    980, 346, 278, 278, 278, 1012, 1046, 346, 354, 362, 354, 362, 
+    278, 278, 346, 1080, 1110, 278, 346, 346, 354, 278, 346, 354, 
+    278, 346, 354, 1140, 1174, 354, 278, 362, 278, 346, 278, 278, 
+    278, 1208, 1242, 346, 354, 362, 354, 362, 278, 278, 346, 1276, 
+    1308, 278, 346, 346, 354, 278, 346, 354, 278, 346, 354, 1340, 
+    1370, 354, 278, 362, 278, 346, 278, 278, 278, 346, 1400, 1432, 
+    354, 362, 354, 362, 278, 278, 346, 354, 346, 278, 346, 346, 
+    1464, 1494, 346, 354, 278, 346, 354, 278, 362, 354, 278, 362, 
+    278, 346, 278, 278, 278, 346, 278, 1524, 1556, 362, 354, 362, 
+    278, 278, 346, 354, 346, 278, 346, 346, 1464, 1494, 346, 354, 
+    278, 346, 354, 278, 362, 354, 278, 798, 828, 346, 278, 278, 
+    278, 346, 1588, 1620, 354, 362, 354, 362, 278, 278, 346, 354, 
+    1652, 1684, 346, 346, 354, 278, 346, 354, 278, 346, 354, 1716, 
+    1750, 354, 278, 362, 278, 346, 278, 278, 278, 346, 1784, 582, 
+    354, 362, 354, 362, 278, 278, 346, 354, 346, 614, 1816, 346, 
+    354, 278, 346, 354, 278, 346, 354, 278, 1846, 1878, 278, 362, 
+    278, 346, 278, 278, 278, 346, 278, 1910, 1942, 362, 354, 362, 
+    278, 278, 346, 354, 346, 278, 346, 1974, 2006, 278, 346, 354, 
+    278, 346, 354, 278, 362, 2038, 2072, 362, 278, 346, 278, 278, 
+    278, 346, 2106, 2140, 354, 362, 354, 362, 278, 278, 346, 354, 
+    346, 278, 346, 286, 2174, 278, 346, 354, 278, 346, 354, 278, 
+    362, 354, 278, 2204, 766, 346, 278, 278, 278, 2236, 2266, 346, 
+    354, 362, 354, 362, 278, 278, 346, 354, 346, 278, 2296, 2328, 
+    354, 278, 346, 354, 278, 346, 354, 278, 2360, 888, 278, 362, 
+    278, 346, 278, 278, 278, 346, 2390, 2328, 354, 362, 354, 362, 
+    278, 278, 346, 354, 346, 2422, 1308, 346, 354, 278, 346, 354, 
+    278, 346, 354, 278, 362, 354, 2422, 2454, 278, 346, 278, 278, 
+    278, 346, 2486, 2518, 354, 362, 354, 362, 278, 278, 346, 354, 
+    346, 278, 346, 346, 1464, 1494, 346, 354, 278, 346, 354, 278, 
+    362, 354, 278, 2550, 2582, 346, 278, 278
+};
+
+const unsigned char level1_data [] = {
+    0x00, 0x16, 0x10, 0x41, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0c, 0x06, 0x41, 
+    0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 
+    0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x0d, 0x06, 0x41, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x16, 
+    0x10, 0x41, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x16, 0x0d, 0x41, 
+    0x00, 0x22, 0x00, 0x2d, 0x00, 0x38, 0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 
+    0x00, 0x16, 0x0c, 0x41, 0x00, 0x18, 0x00, 0x23, 0x00, 0x2e, 0x00, 0x39, 
+    0x00, 0x06, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x16, 0x0c, 0x41, 0x00, 0x19, 
+    0x00, 0x24, 0x00, 0x2f, 0x00, 0x3a, 0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 
+    0x00, 0x16, 0x0d, 0x41, 0x00, 0x25, 0x00, 0x30, 0x00, 0x3b, 0x00, 0x06, 
+    0x00, 0x11, 0x0b, 0x41, 0x00, 0x16, 0x10, 0x41, 0x00, 0x06, 0x00, 0x10, 
+    0x0b, 0x41, 0x00, 0x0e, 0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x04, 0x0e, 0x00, 0x05, 0x00, 0x10, 
+    0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x01, 0x0f, 0x00, 0x02, 0x01, 0x0f, 
+    0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x16, 0x10, 0x41, 0x00, 0x06, 
+    0x00, 0x11, 0x0b, 0x41, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0c, 0x05, 0x41, 
+    0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 
+    0x00, 0x0b, 0x00, 0x0f, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 0x01, 0x02, 
+    0x01, 0x0f, 0x00, 0x02, 0x01, 0x0e, 0x00, 0x02, 0x00, 0x05, 0x00, 0x10, 
+    0x0b, 0x41, 0x11, 0x41, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0c, 0x06, 0x41, 0x00, 0x03, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 
+    0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0d, 
+    0x06, 0x41, 0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x11, 0x41, 
+    0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x11, 0x41, 0x00, 0x06, 0x00, 0x10, 
+    0x0b, 0x41, 0x11, 0x41, 0x00, 0x06, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0c, 0x06, 0x41, 0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 
+    0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0d, 0x06, 0x41, 0x00, 0x04, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0c, 0x06, 0x41, 
+    0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x06, 
+    0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0d, 0x06, 0x41, 0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x0c, 0x06, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x05, 
+    0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x0d, 0x06, 0x41, 
+    0x00, 0x04, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 
+    0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0d, 0x05, 0x41, 
+    0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x11, 
+    0x0b, 0x41, 0x00, 0x01, 0x00, 0x0c, 0x06, 0x41, 0x00, 0x03, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0d, 
+    0x06, 0x41, 0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x06, 0x00, 0x11, 
+    0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x0c, 0x06, 0x41, 0x00, 0x03, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 
+    0x00, 0x0d, 0x06, 0x41, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x11, 
+    0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0c, 0x05, 0x41, 
+    0x00, 0x03, 0x00, 0x0e, 0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 0x00, 0x0f, 
+    0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0c, 0x06, 0x41, 
+    0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x06, 0x00, 0x11, 0x0b, 0x41, 
+    0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0d, 0x06, 0x41, 0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0c, 0x06, 0x41, 0x00, 0x03, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 
+    0x00, 0x0d, 0x06, 0x41, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0c, 0x06, 0x41, 0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x06, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x0d, 0x05, 0x41, 
+    0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 
+    0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0c, 0x04, 0x41, 0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x11, 
+    0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0d, 0x04, 0x41, 0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 
+    0x00, 0x0c, 0x06, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0d, 0x06, 0x41, 0x00, 0x04, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x0c, 0x04, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x0d, 
+    0x04, 0x41, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x06, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0c, 0x04, 0x41, 0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0d, 0x04, 0x41, 0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 
+    0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 
+    0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x0d, 0x05, 0x41, 
+    0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x0c, 0x06, 0x41, 
+    0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x10, 
+    0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x0d, 0x06, 0x41, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x06, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0c, 
+    0x05, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 
+    0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x0c, 0x06, 0x41, 0x00, 0x03, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x0d, 
+    0x06, 0x41, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 
+    0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x0d, 0x05, 0x41, 
+    0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x06, 
+    0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x0c, 0x05, 0x41, 
+    0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 
+    0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 
+    0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0d, 
+    0x05, 0x41, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x0c, 0x04, 0x41, 0x00, 0x03, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 
+    0x00, 0x0f, 0x00, 0x0d, 0x04, 0x41, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x06, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0c, 
+    0x05, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 
+    0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0d, 0x06, 0x41, 0x00, 0x04, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0c, 0x05, 0x41, 
+    0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x06, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x06, 0x00, 0x10, 
+    0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 
+    0x00, 0x0f, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0c, 0x05, 0x41, 
+    0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x11, 
+    0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x0c, 0x04, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x0d, 0x04, 0x41, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0c, 0x04, 0x41, 
+    0x00, 0x03, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 
+    0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0d, 0x04, 0x41, 0x00, 0x04, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x11, 
+    0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0d, 0x06, 0x41, 
+    0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x06, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x06, 
+    0x00, 0x11, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x0c, 0x06, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x0b, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x0d, 0x06, 0x41, 0x00, 0x04, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 
+    0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 
+    0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0d, 
+    0x05, 0x41, 0x00, 0x04, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x0c, 0x06, 0x41, 
+    0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x06, 0x00, 0x11, 
+    0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 
+    0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x01, 
+    0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x0c, 0x05, 0x41, 0x00, 0x03, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0f, 0x00, 0x02, 
+    0x00, 0x0f, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x06, 0x00, 0x11, 
+    0x0b, 0x41, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0c, 0x05, 0x41, 
+    0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41, 0x00, 0x0b, 
+    0x00, 0x0f, 0x00, 0x02, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x05, 0x00, 0x11, 0x0b, 0x41, 0x00, 0x01, 0x00, 0x0c, 0x05, 0x41, 
+    0x00, 0x03, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 
+    0x00, 0x01, 0x00, 0x0e, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x06, 0x00, 0x11, 
+    0x0b, 0x41, 0x00, 0x0b, 0x00, 0x0d, 0x05, 0x41, 0x00, 0x04, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x02, 0x00, 0x0f, 
+    0x00, 0x02, 0x00, 0x0f, 0x00, 0x05, 0x00, 0x10, 0x0b, 0x41
+};
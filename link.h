@@ -0,0 +1,151 @@
+/* link.h
+ * the link cable transport for netplay. the serial port runs in multiplayer
+ * mode, where each transfer swaps one 16 bit word between the consoles.
+ * player 0 is the parent and starts a transfer every frame, and when it is
+ * done the serial interrupt goes off on both consoles. the handler takes in
+ * the word the other side sent and loads the next one of ours to go out */
+
+/* the serial registers */
+volatile unsigned short* serial_multi = (volatile unsigned short*) 0x4000120;
+volatile unsigned short* serial_control = (volatile unsigned short*) 0x4000128;
+volatile unsigned short* serial_send = (volatile unsigned short*) 0x400012a;
+volatile unsigned short* serial_mode = (volatile unsigned short*) 0x4000134;
+
+/* the interrupt enable and master enable registers */
+volatile unsigned short* interrupt_enable = (volatile unsigned short*) 0x4000200;
+volatile unsigned short* interrupt_master = (volatile unsigned short*) 0x4000208;
+
+/* serial control flags for multiplayer mode */
+#define SERIAL_115200 0x3
+#define SERIAL_READY 0x8
+#define SERIAL_ERROR 0x40
+#define SERIAL_START 0x80
+#define SERIAL_MULTIPLAYER 0x2000
+#define SERIAL_IRQ 0x4000
+
+/* the serial bit in the interrupt registers */
+#define INTERRUPT_SERIAL 0x80
+
+/* what a console with nothing to say sends, and what is read from a
+ * console that is not there */
+#define LINK_IDLE 0xffff
+
+/* the size of each queue, a power of two */
+#define LINK_QUEUE 32
+
+struct Link {
+    /* which player this console is, 0 is the parent */
+    int player;
+
+    /* our words waiting to go out, after the one in the send register */
+    unsigned short outgoing[LINK_QUEUE];
+    volatile unsigned int out_head, out_tail;
+
+    /* whether the send register holds one of our words yet to go */
+    volatile int loaded;
+
+    /* the other side's words, filled by the interrupt handler */
+    unsigned short incoming[LINK_QUEUE];
+    volatile unsigned int in_head, in_tail;
+
+    /* transfers done, transfers that failed, and words lost to full queues */
+    volatile unsigned int transfers, errors, dropped;
+};
+
+struct Link link;
+
+/* put the serial port in multiplayer mode and turn on its interrupt */
+void link_init() {
+    link.out_head = link.out_tail = 0;
+    link.in_head = link.in_tail = 0;
+    link.loaded = 0;
+    link.transfers = link.errors = link.dropped = 0;
+
+    /* bit 15 of the mode register clear picks the serial modes */
+    *serial_mode = 0;
+    *serial_control = SERIAL_MULTIPLAYER | SERIAL_115200;
+    *serial_control |= SERIAL_IRQ;
+    *serial_send = LINK_IDLE;
+    link.player = 0;
+
+    *interrupt_enable |= INTERRUPT_SERIAL;
+    *interrupt_master = 1;
+}
+
+/* whether every console on the cable is there. the player number is only
+ * known once they are, so it is read here */
+int link_connected() {
+    if (!(*serial_control & SERIAL_READY)) {
+        return 0;
+    }
+    link.player = (*serial_control >> 4) & 3;
+    return 1;
+}
+
+/* the serial interrupt: a transfer has finished */
+void link_interrupt() {
+    if (*serial_control & SERIAL_ERROR) {
+        /* leave our word loaded so it goes again next transfer */
+        link.errors++;
+        return;
+    }
+    link.transfers++;
+
+    /* keep what the other console sent, if it said anything */
+    unsigned short word = serial_multi[link.player ^ 1];
+    if (word != LINK_IDLE) {
+        if (link.in_head - link.in_tail < LINK_QUEUE) {
+            link.incoming[link.in_head % LINK_QUEUE] = word;
+            link.in_head++;
+        } else {
+            link.dropped++;
+        }
+    }
+
+    /* load the next word of ours, or idle if there is none */
+    if (link.out_head != link.out_tail) {
+        *serial_send = link.outgoing[link.out_tail % LINK_QUEUE];
+        link.out_tail++;
+        link.loaded = 1;
+    } else {
+        *serial_send = LINK_IDLE;
+        link.loaded = 0;
+    }
+}
+
+/* the transport's send, with the interrupt held off while we look at the
+ * send register */
+void link_send(void* context, unsigned short word) {
+    (void) context;
+    *interrupt_master = 0;
+    if (!link.loaded) {
+        *serial_send = word;
+        link.loaded = 1;
+    } else if (link.out_head - link.out_tail < LINK_QUEUE) {
+        link.outgoing[link.out_head % LINK_QUEUE] = word;
+        link.out_head++;
+    } else {
+        link.dropped++;
+    }
+    *interrupt_master = 1;
+}
+
+/* the transport's receive */
+int link_receive(void* context, unsigned short* word) {
+    (void) context;
+    if (link.in_head == link.in_tail) {
+        return 0;
+    }
+    *word = link.incoming[link.in_tail % LINK_QUEUE];
+    link.in_tail++;
+    return 1;
+}
+
+/* called once a frame, the parent starts a transfer if one is not going */
+void link_service() {
+    if (link.player == 0 && !(*serial_control & SERIAL_START)) {
+        *serial_control |= SERIAL_START;
+    }
+}
+
+struct Transport link_transport = {0, link_send, link_receive};
@@ -0,0 +1,293 @@
+/* masks.h
+ * generated by mkmasks from dragon.h and background.h */
+
+/* one bit per pixel, bit 0 the leftmost, set where a pixel is drawn */
+#define DRAGON_MASK_FRAMES 17
+#define TILE_MASK_COUNT 66
+
+const unsigned short dragon_masks[DRAGON_MASK_FRAMES][32] = {
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0x1fee, 0x7fee, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
+     0x7fff, 0x3fff, 0x1fff, 0x1fff, 0x3fff, 0x1fff, 0x0ffe, 0x03f8,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xffff, 0xffff, 0xffff, 0xffff, 0xff1f, 0xff7f, 0xffff, 0xffff,
+     0x3fff, 0x1fff, 0x0ffe, 0x03f8, 0xe07f, 0xf03f, 0xf81f, 0xf81f,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xff1f, 0xff7f, 0xffff, 0xffff, 0xffff, 0xffff, 0xfeff, 0xf8ff,
+     0xe07f, 0xf03f, 0xf81f, 0xf81f, 0xf83f, 0xf81f, 0xf80f, 0xf803,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xffff, 0xffff, 0xfeff, 0xf8ff, 0x7fff, 0x3fff, 0x1fff, 0x1fff,
+     0xf83f, 0xf81f, 0xf80f, 0xf803, 0x3fe0, 0x7ff0, 0x7ff8, 0xfff8,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0x7fff, 0x3fff, 0x1fff, 0x1fff, 0x3fff, 0x1fff, 0x0ffe, 0x03f8,
+     0x3fe0, 0x7ff0, 0x7ff8, 0xfff8, 0xfff8, 0xfff8, 0xfff8, 0xfff8,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0x3fff, 0x1fff, 0x0ffe, 0x03f8, 0xe07f, 0xf03f, 0xf81f, 0xf81f,
+     0xfff8, 0xfff8, 0xfff8, 0xfff8, 0xfc3f, 0xfc7f, 0xfc7f, 0xfcff,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xe07f, 0xf03f, 0xf81f, 0xf81f, 0xf83f, 0xf81f, 0xf80f, 0xf803,
+     0xfc3f, 0xfc7f, 0xfc7f, 0xfcff, 0xfcff, 0xf8ff, 0xf0ff, 0xf0ff,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xf83f, 0xf81f, 0xf80f, 0xf803, 0x3fe0, 0x7ff0, 0x7ff8, 0xfff8,
+     0xfcff, 0xf8ff, 0xf0ff, 0xf0ff, 0x3ffc, 0x7ffc, 0x7ffc, 0x7ffc,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0x3fe0, 0x7ff0, 0x7ff8, 0xfff8, 0xfff8, 0xfff8, 0xfff8, 0xfff8,
+     0x3ffc, 0x7ffc, 0x7ffc, 0x7ffc, 0x3ffc, 0x3ff8, 0x1ff0, 0x07f0,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xfff8, 0xfff8, 0xfff8, 0xfff8, 0xfc3f, 0xfc7f, 0xfc7f, 0xfcff,
+     0x3ffc, 0x3ff8, 0x1ff0, 0x07f0, 0xff3f, 0xff7f, 0xff7f, 0xff7f,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xfc3f, 0xfc7f, 0xfc7f, 0xfcff, 0xfcff, 0xf8ff, 0xf0ff, 0xf0ff,
+     0xff3f, 0xff7f, 0xff7f, 0xff7f, 0xff3f, 0xff3f, 0xff1f, 0xff07,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xfcff, 0xf8ff, 0xf0ff, 0xf0ff, 0x3ffc, 0x7ffc, 0x7ffc, 0x7ffc,
+     0xff3f, 0xff3f, 0xff1f, 0xff07, 0xffff, 0xffff, 0xffff, 0xffff,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0x3ffc, 0x7ffc, 0x7ffc, 0x7ffc, 0x3ffc, 0x3ff8, 0x1ff0, 0x07f0,
+     0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0x3ffc, 0x3ff8, 0x1ff0, 0x07f0, 0xff3f, 0xff7f, 0xff7f, 0xff7f,
+     0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xff3f, 0xff7f, 0xff7f, 0xff7f, 0xff3f, 0xff3f, 0xff1f, 0xff07,
+     0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xff3f, 0xff3f, 0xff1f, 0xff07, 0xffff, 0xffff, 0xffff, 0xffff,
+     0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+     0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
+     0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
+     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
+};
+
+const unsigned short dragon_cover[DRAGON_MASK_FRAMES][64] = {
+    {0x01b, 0x05b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x0ff, 0x0ff, 0x0ff, 0x0ff, 0x0fb, 0x0fb, 0x1fb,
+     0x03f, 0x0ff, 0x0ff, 0x0ff, 0x0ff, 0x1ff, 0x1ff, 0x1fb,
+     0x03f, 0x0ff, 0x0ff, 0x0ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x0ff, 0x0ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x0ff, 0x0ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x0bf, 0x0ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe,
+     0x03f, 0x0bf, 0x0bf, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1fe},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1df, 0x1df, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb, 0x1fb,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb, 0x1fb,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb, 0x1fb,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb, 0x1fb,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+    {0x01b, 0x09b, 0x0db, 0x0db, 0x0db, 0x0d9, 0x0d9, 0x0d9,
+     0x03f, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1f9, 0x1f9, 0x1f9,
+     0x03f, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb, 0x1f9,
+     0x03f, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb, 0x1fb,
+     0x03f, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb, 0x1fb,
+     0x03f, 0x13f, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb, 0x1fb,
+     0x03f, 0x13f, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb, 0x1fb,
+     0x03f, 0x13f, 0x17f, 0x1ff, 0x1ff, 0x1fb, 0x1fb, 0x1fb},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1bf, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1bf, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1bf, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1bf, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x0ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb,
+     0x03f, 0x0ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb,
+     0x03f, 0x0ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb,
+     0x03f, 0x0ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fb, 0x1fb,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+    {0x01b, 0x05b, 0x0db, 0x0db, 0x0db, 0x0da, 0x0d8, 0x0d8,
+     0x03f, 0x0ff, 0x0ff, 0x0ff, 0x0fb, 0x0fa, 0x1f8, 0x1f8,
+     0x03f, 0x0ff, 0x0ff, 0x0ff, 0x1fb, 0x1fa, 0x1f8, 0x1f8,
+     0x03f, 0x0ff, 0x0ff, 0x1ff, 0x1ff, 0x1fa, 0x1f8, 0x1f8,
+     0x03f, 0x0ff, 0x0ff, 0x1ff, 0x1ff, 0x1fe, 0x1f8, 0x1f8,
+     0x03f, 0x0bf, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1f8, 0x1f8,
+     0x03f, 0x0bf, 0x1ff, 0x1ff, 0x1fe, 0x1fe, 0x1f8, 0x1f8,
+     0x03f, 0x0bf, 0x1bf, 0x1fe, 0x1fe, 0x1fe, 0x1f8, 0x1f8},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe, 0x1fe,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe, 0x1fe,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe, 0x1fe,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe, 0x1fe},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+    {0x01b, 0x09b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0da, 0x0da,
+     0x03f, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe,
+     0x03f, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe,
+     0x03f, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe,
+     0x03f, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe,
+     0x03f, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe,
+     0x03f, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe,
+     0x03f, 0x1bf, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1bf, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe,
+     0x03f, 0x1bf, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe,
+     0x03f, 0x1bf, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe,
+     0x03f, 0x1bf, 0x1bf, 0x1ff, 0x1ff, 0x1ff, 0x1fe, 0x1fe},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+    {0x01b, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db, 0x0db,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff,
+     0x03f, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff, 0x1ff},
+};
+
+const unsigned char tile_masks[TILE_MASK_COUNT][8] = {
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+};
+
+const unsigned char tile_full[TILE_MASK_COUNT] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 0
+};
@@ -0,0 +1,181 @@
+/* memory.h
+ * where things live in memory, and two allocators that never call malloc.
+ *
+ * the GBA has 32K of IWRAM on a 32 bit bus with no wait states, and 256K of
+ * EWRAM on a 16 bit bus with two. anything touched every frame - the game
+ * state, the stack, ARM code - belongs in IWRAM, and big buffers only looked
+ * at now and then go in EWRAM. the macros below put a variable or function
+ * in one or the other, using the section names from devkitARM's linker
+ * script: .bss is IWRAM, .sbss is EWRAM bss and .ewram is EWRAM data.
+ *
+ * an arena hands out memory from a fixed buffer by moving a pointer along it
+ * and gives it all back at once. the frame arena is reset every frame, for
+ * scratch work that does not outlive the frame. a block pool hands out
+ * blocks of one size from a fixed buffer, with the free ones kept in a list
+ * threaded through the blocks themselves.
+ *
+ * both keep a high-water mark and count the requests they had to turn down,
+ * so the sizes can be tuned from the log. nothing in here touches the
+ * hardware, so the host tools can use it too */
+
+#ifdef PHLAPU_HOST
+#define IWRAM_CODE
+#define EWRAM_DATA
+#define EWRAM_BSS
+#else
+/* code in IWRAM is called through a register, as it is too far from ROM
+ * for a plain branch to reach. it is built as ARM rather than thumb, as the
+ * 32 bit bus fetches a whole ARM instruction at once */
+#ifdef __arm__
+#define IWRAM_CODE __attribute__((section(".iwram"), long_call, target("arm")))
+#else
+#define IWRAM_CODE __attribute__((section(".iwram"), long_call))
+#endif
+#define EWRAM_DATA __attribute__((section(".ewram")))
+#define EWRAM_BSS __attribute__((section(".sbss")))
+#endif
+
+/* the sizes of the two work RAMs */
+#define IWRAM_SIZE 0x8000
+#define EWRAM_SIZE 0x40000
+
+/* everything an arena or pool hands out is aligned to a word, so DMA can
+ * copy it 32 bits at a time */
+#define MEMORY_ALIGN 4
+
+/////////////Arena
+
+struct Arena {
+    const char* name;
+    unsigned char* base;
+    unsigned int size;
+
+    /* bytes handed out since the last reset, and the most there have been */
+    unsigned int used;
+    unsigned int high;
+
+    /* requests that did not fit */
+    unsigned int failures;
+};
+
+/* set an arena up over a buffer of the given size */
+void arena_init(struct Arena* arena, const char* name, void* base, unsigned int size) {
+    arena->name = name;
+    arena->base = (unsigned char*) base;
+    arena->size = size & ~(MEMORY_ALIGN - 1);
+    arena->used = 0;
+    arena->high = 0;
+    arena->failures = 0;
+}
+
+/* take some bytes from an arena, returns 0 if there are not enough left */
+void* arena_alloc(struct Arena* arena, unsigned int bytes) {
+    bytes = (bytes + MEMORY_ALIGN - 1) & ~(MEMORY_ALIGN - 1);
+    if (bytes > arena->size - arena->used) {
+        arena->failures++;
+        return 0;
+    }
+    void* p = arena->base + arena->used;
+    arena->used += bytes;
+    if (arena->used > arena->high) {
+        arena->high = arena->used;
+    }
+    return p;
+}
+
+/* where the arena is up to, and going back there, freeing everything taken
+ * since. marks have to be gone back to in the reverse order they were made */
+unsigned int arena_mark(const struct Arena* arena) {
+    return arena->used;
+}
+void arena_release(struct Arena* arena, unsigned int mark) {
+    if (mark < arena->used) {
+        arena->used = mark;
+    }
+}
+
+/* give everything back */
+void arena_reset(struct Arena* arena) {
+    arena->used = 0;
+}
+
+/////////////Block pools
+
+/* the end of the free list */
+#define BLOCK_NONE 0xffff
+
+struct BlockPool {
+    const char* name;
+    unsigned char* blocks;
+    unsigned int block_size;
+    int capacity;
+
+    /* the first free block, each free block holds the index of the next */
+    unsigned short free;
+
+    /* blocks handed out now, the most there have been, and requests made
+     * while every block was out */
+    int used;
+    int high;
+    unsigned int failures;
+};
+
+/* set a pool up over a buffer of the given size, which is split into as
+ * many blocks as fit. blocks are at least a word and rounded up to one */
+void block_pool_init(struct BlockPool* pool, const char* name, void* base,
+        unsigned int size, unsigned int block_size) {
+    if (block_size < MEMORY_ALIGN) {
+        block_size = MEMORY_ALIGN;
+    }
+    block_size = (block_size + MEMORY_ALIGN - 1) & ~(MEMORY_ALIGN - 1);
+
+    pool->name = name;
+    pool->blocks = (unsigned char*) base;
+    pool->block_size = block_size;
+    pool->capacity = (int) (size / block_size);
+    if (pool->capacity > BLOCK_NONE) {
+        pool->capacity = BLOCK_NONE;
+    }
+    pool->used = 0;
+    pool->high = 0;
+    pool->failures = 0;
+
+    /* string every block onto the free list in order */
+    for (int i = 0; i < pool->capacity; i++) {
+        *(unsigned short*) (pool->blocks + i * block_size) =
+            i + 1 < pool->capacity ? i + 1 : BLOCK_NONE;
+    }
+    pool->free = pool->capacity ? 0 : BLOCK_NONE;
+}
+
+/* take a block, returns 0 if they are all out */
+void* block_alloc(struct BlockPool* pool) {
+    if (pool->free == BLOCK_NONE) {
+        pool->failures++;
+        return 0;
+    }
+    unsigned char* block = pool->blocks + pool->free * pool->block_size;
+    pool->free = *(unsigned short*) block;
+    pool->used++;
+    if (pool->used > pool->high) {
+        pool->high = pool->used;
+    }
+    return block;
+}
+
+/* give a block back */
+void block_free(struct BlockPool* pool, void* block) {
+    unsigned int index = (unsigned int) ((unsigned char*) block - pool->blocks) / pool->block_size;
+    *(unsigned short*) block = pool->free;
+    pool->free = index;
+    pool->used--;
+}
+
+/* the index of a block, and the block at an index. indices are what should
+ * be kept in the game state, as they stay the same in a snapshot */
+int block_index(const struct BlockPool* pool, const void* block) {
+    return (int) ((unsigned int) ((const unsigned char*) block - pool->blocks) / pool->block_size);
+}
+void* block_at(const struct BlockPool* pool, int index) {
+    return pool->blocks + index * pool->block_size;
+}
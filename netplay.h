@@ -0,0 +1,252 @@
+/* netplay.h
+ * two player head-to-head over a link, kept in step with rollback. both
+ * dragons fly the same map and both are simulated on each console. every
+ * frame the local keys go out to the other side, and the remote keys are
+ * guessed to be whatever they last were. when the real keys turn up and do
+ * not match the guess, the match is put back the way it was on that frame
+ * and stepped forward again with the right keys, all before this frame is
+ * shown.
+ *
+ * the link itself sits behind struct Transport, so the GBA can use the
+ * serial port and the host tools an in-process loopback */
+
+/* the furthest back a rollback can go, in frames, a power of two. a console
+ * that gets this far ahead of what it has heard from the other one waits */
+#define NETPLAY_WINDOW 16
+
+/* keys are kept for twice the window, as the other side can be a window
+ * ahead of us while we are a window ahead of what we have heard */
+#define NETPLAY_INPUTS (2 * NETPLAY_WINDOW)
+
+/* a message is one frame's keys from one side, packed into 16 bits so it
+ * fits a single multiplayer serial transfer: 9 bits of keys (everything but
+ * L) and the low 6 bits of the frame number. 6 bits is enough to tell the
+ * frame apart, as it is always within NETPLAY_INPUTS of the first frame we
+ * are still waiting for */
+#define NETPLAY_KEYS 0x1ff
+#define NETPLAY_FRAME_SHIFT 10
+#define NETPLAY_FRAME_MASK 0x3f
+
+/* sent when there is nothing to say. it can never be a real message, as
+ * bit 9 of a real one is always clear */
+#define NETPLAY_IDLE 0xffff
+
+/* something that carries 16 bit messages to the other console, in order */
+struct Transport {
+    void* context;
+    void (*send)(void* context, unsigned short message);
+
+    /* returns whether there was a message waiting */
+    int (*receive)(void* context, unsigned short* message);
+};
+
+/* the two players' games, side by side */
+struct Match {
+    struct Game players[2];
+};
+
+void match_init(struct Match* match, const struct Tilemap* ground) {
+    game_init(&match->players[0], ground);
+    game_init(&match->players[1], ground);
+}
+
+/* step both games a frame, returns whether either dragon is still alive */
+int match_step(struct Match* match, const unsigned short keys[2]) {
+    int alive = game_step(&match->players[0], keys[0]);
+    alive |= game_step(&match->players[1], keys[1]);
+    return alive;
+}
+
+void match_save(struct Match* snapshot, const struct Match* match) {
+    game_save(&snapshot->players[0], &match->players[0]);
+    game_save(&snapshot->players[1], &match->players[1]);
+}
+
+void match_restore(struct Match* match, const struct Match* snapshot) {
+    game_restore(&match->players[0], &snapshot->players[0]);
+    game_restore(&match->players[1], &snapshot->players[1]);
+}
+
+unsigned int match_hash(const struct Match* match) {
+    return game_hash(&match->players[0]) * 31 + game_hash(&match->players[1]);
+}
+
+struct Netplay {
+    /* which player this console is, 0 or 1 */
+    int local;
+    struct Transport* transport;
+
+    /* the match as we best know it */
+    struct Match match;
+
+    /* the next frame to step */
+    int frame;
+
+    /* the remote keys are known for every frame before this one */
+    int confirmed;
+
+    /* the remote keys for the frame before confirmed, which is the guess
+     * for every frame we have not heard about */
+    unsigned short last_remote;
+
+    /* each player's keys by frame, and which frame's remote keys each slot
+     * really holds */
+    unsigned short keys[2][NETPLAY_INPUTS];
+    int known[NETPLAY_INPUTS];
+
+    /* the remote keys each recent frame was stepped with */
+    unsigned short used[NETPLAY_WINDOW];
+
+    /* the first frame that was stepped with a wrong guess, or -1 */
+    int rollback;
+
+    /* the match at the start of each recent frame */
+    struct Match snapshots[NETPLAY_WINDOW];
+
+    /* optional cycle counter to time the rollbacks with */
+    unsigned int (*clock)();
+
+    /* how it has gone: frames spent waiting, rollbacks done, the frames the
+     * last and worst ones went back, the frames stepped again in all, and the
+     * cycles the last and worst ones took */
+    unsigned int stalls;
+    unsigned int rollbacks;
+    int depth;
+    int worst_depth;
+    unsigned int resimulated;
+    unsigned int cycles;
+    unsigned int worst_cycles;
+};
+
+void netplay_init(struct Netplay* np, int local, struct Transport* transport,
+        const struct Tilemap* ground) {
+    np->local = local;
+    np->transport = transport;
+    match_init(&np->match, ground);
+    np->frame = 0;
+    np->confirmed = 0;
+    np->last_remote = 0;
+    for (int i = 0; i < NETPLAY_INPUTS; i++) {
+        np->keys[0][i] = 0;
+        np->keys[1][i] = 0;
+        np->known[i] = -1;
+    }
+    np->rollback = -1;
+    np->clock = 0;
+    np->stalls = 0;
+    np->rollbacks = 0;
+    np->depth = 0;
+    np->worst_depth = 0;
+    np->resimulated = 0;
+    np->cycles = 0;
+    np->worst_cycles = 0;
+}
+
+/* the remote keys for a frame, or the guess if they have not come yet */
+unsigned short netplay_remote_keys(const struct Netplay* np, int frame) {
+    int slot = frame % NETPLAY_INPUTS;
+    return np->known[slot] == frame ? np->keys[!np->local][slot] : np->last_remote;
+}
+
+/* take in every message that has arrived, noting any wrong guesses */
+void netplay_receive(struct Netplay* np) {
+    unsigned short message;
+    while (np->transport->receive(np->transport->context, &message)) {
+        if (message == NETPLAY_IDLE) {
+            continue;
+        }
+
+        /* work the whole frame number out from its low bits */
+        int low = message >> NETPLAY_FRAME_SHIFT;
+        int frame = np->confirmed + ((low - np->confirmed) & NETPLAY_FRAME_MASK);
+        unsigned short keys = message & NETPLAY_KEYS;
+        int slot = frame % NETPLAY_INPUTS;
+        np->keys[!np->local][slot] = keys;
+        np->known[slot] = frame;
+
+        /* a frame already stepped with other keys has to be done again */
+        if (frame < np->frame && np->used[frame % NETPLAY_WINDOW] != keys &&
+                (np->rollback < 0 || frame < np->rollback)) {
+            np->rollback = frame;
+        }
+    }
+
+    /* move past every frame that is now known */
+    while (np->known[np->confirmed % NETPLAY_INPUTS] == np->confirmed) {
+        np->last_remote = np->keys[!np->local][np->confirmed % NETPLAY_INPUTS];
+        np->confirmed++;
+    }
+}
+
+/* step the match one frame with the keys we have for it */
+void netplay_advance(struct Netplay* np) {
+    int frame = np->frame;
+    unsigned short keys[2];
+    keys[np->local] = np->keys[np->local][frame % NETPLAY_INPUTS];
+    keys[!np->local] = netplay_remote_keys(np, frame);
+    np->used[frame % NETPLAY_WINDOW] = keys[!np->local];
+
+    match_save(&np->snapshots[frame % NETPLAY_WINDOW], &np->match);
+    match_step(&np->match, keys);
+    np->frame++;
+}
+
+/* go back to the first wrongly guessed frame and step up to now again */
+void netplay_resimulate(struct Netplay* np) {
+    if (np->rollback < 0) {
+        return;
+    }
+    unsigned int start = np->clock ? np->clock() : 0;
+    int end = np->frame;
+
+    match_restore(&np->match, &np->snapshots[np->rollback % NETPLAY_WINDOW]);
+    np->frame = np->rollback;
+    np->rollback = -1;
+    np->depth = end - np->frame;
+    while (np->frame < end) {
+        netplay_advance(np);
+    }
+
+    np->rollbacks++;
+    np->resimulated += np->depth;
+    if (np->depth > np->worst_depth) {
+        np->worst_depth = np->depth;
+    }
+    if (np->clock) {
+        np->cycles = np->clock() - start;
+        if (np->cycles > np->worst_cycles) {
+            np->worst_cycles = np->cycles;
+        }
+    }
+}
+
+/* whether the match is over for this console: our dragon is down, and so
+ * is the other one in keys we have all heard rather than guessed at. a
+ * dragon goes down on the last frame his game steps, so that is known once
+ * confirmed has got past it. until then the other console may still need
+ * our keys to get on, so they have to keep going out */
+int netplay_over(const struct Netplay* np) {
+    const struct Game* local = &np->match.players[np->local];
+    const struct Game* remote = &np->match.players[!np->local];
+    return !local->dragon.alive && !remote->dragon.alive && remote->frames <= np->confirmed;
+}
+
+/* run one frame with the given local keys. returns 1 if the match moved on
+ * a frame, or 0 if it is waiting to hear from the other side */
+int netplay_update(struct Netplay* np, unsigned short keys) {
+    netplay_receive(np);
+    netplay_resimulate(np);
+
+    if (np->frame - np->confirmed >= NETPLAY_WINDOW) {
+        np->stalls++;
+        return 0;
+    }
+
+    /* send our keys for this frame and step it */
+    keys &= NETPLAY_KEYS;
+    np->keys[np->local][np->frame % NETPLAY_INPUTS] = keys;
+    np->transport->send(np->transport->context,
+            (unsigned short) (((np->frame & NETPLAY_FRAME_MASK) << NETPLAY_FRAME_SHIFT) | keys));
+    netplay_advance(np);
+    return 1;
+}
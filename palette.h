@@ -0,0 +1,330 @@
+/* palette.h
+ * fades, hit flashes and colour cycling, done by working out new palettes
+ * and copying them into palette memory in vblank. the palettes in ROM are
+ * never changed, each bank keeps a copy with its colour cycles applied and
+ * blends that towards a fade colour and then a flash colour into the copy
+ * that goes out. that copy is only needed until the vblank copies it, so it
+ * is taken from the frame's scratch arena rather than kept in the bank.
+ *
+ * the blending is done two colours at a time. a 15 bit BGR colour has 5 bits
+ * each of red, green and blue, so with two colours in a 32 bit word each
+ * channel of both can be pulled out into the low bits of the two halves and
+ * blended with one multiply. a channel times a level of up to 32 fits in 10
+ * bits, well inside its half, so the halves never spill into each other.
+ * the blend runs from IWRAM as ARM code, where it is quickest.
+ *
+ * a bank is only worked out again on frames something about it changed,
+ * and only up to the last colour its palette uses, so a palette sitting
+ * still costs nothing. each frame's blended words are counted, next to the
+ * cycles the profiler gives the palette zone.
+ *
+ * this needs memory.h for the IWRAM section and the arena, and dmaqueue.h
+ * for the uploads */
+
+/* a bank is 256 colours, copied as 128 words */
+#define PALETTE_COLORS 256
+#define PALETTE_WORDS (PALETTE_COLORS / 2)
+
+/* the most colour cycles one bank can have */
+#define PALETTE_CYCLES_MAX 4
+
+/* how far a blend can go, 0 is the palette as it is and 32 is all the way
+ * to the other colour. fades step in 1/256ths of a level */
+#define PALETTE_LEVELS 32
+#define PALETTE_FADE_ONE 256
+
+/* the three channels of two colours, each moved down to the bottom of its
+ * half of the word */
+#define PALETTE_CHANNEL 0x001f001f
+
+/* some colours to fade to */
+#define PALETTE_BLACK 0x0000
+#define PALETTE_WHITE 0x7fff
+
+/* a run of colours that rotates one place every so many vblanks */
+struct PaletteCycle {
+    unsigned char first;
+    unsigned char count;
+    unsigned char delay;
+    unsigned char counter;
+    unsigned char phase;
+};
+
+struct PaletteBank {
+    /* the palette as drawn, and where it goes in palette memory */
+    const unsigned short* source;
+    unsigned short* hardware;
+
+    /* how many words of it are worth working on, up to its last colour */
+    int words;
+
+    /* the palette with its cycles applied */
+    unsigned int cycled[PALETTE_WORDS];
+
+    /* the fade's colour, where it is and where it is going, in 1/256ths of
+     * a level, and how far it moves each vblank */
+    unsigned short fade_color;
+    int fade_level;
+    int fade_target;
+    int fade_step;
+
+    /* the flash's colour, its level now, and how much it drops each vblank */
+    unsigned short flash_color;
+    int flash_level;
+    int flash_decay;
+
+    struct PaletteCycle cycles[PALETTE_CYCLES_MAX];
+    int cycle_count;
+
+    /* whether the cycled copy or the blends have to be worked out again */
+    int recycle;
+    int dirty;
+};
+
+/* the background and sprite banks */
+enum PaletteBankId {
+    PALETTE_BG,
+    PALETTE_SPRITES,
+    PALETTE_BANKS
+};
+
+struct Palettes {
+    struct PaletteBank banks[PALETTE_BANKS];
+
+    /* words blended on the last update, the most on any update, and the
+     * total, with the banks sent and the ones the queue or the arena
+     * turned down */
+    int blended;
+    int worst;
+    unsigned int total;
+    unsigned int uploads;
+    unsigned int dropped;
+};
+
+/* blend words of packed colour pairs towards one colour by level/32 */
+IWRAM_CODE void palette_blend(unsigned int* dest, const unsigned int* source, int words,
+        unsigned short color, int level) {
+    unsigned int pair = color | ((unsigned int) color << 16);
+    unsigned int tr = pair & PALETTE_CHANNEL;
+    unsigned int tg = (pair >> 5) & PALETTE_CHANNEL;
+    unsigned int tb = (pair >> 10) & PALETTE_CHANNEL;
+    unsigned int keep = PALETTE_LEVELS - level;
+    tr *= level;
+    tg *= level;
+    tb *= level;
+    for (int i = 0; i < words; i++) {
+        unsigned int w = source[i];
+        unsigned int r = ((w & PALETTE_CHANNEL) * keep + tr) >> 5;
+        unsigned int g = (((w >> 5) & PALETTE_CHANNEL) * keep + tg) >> 5;
+        unsigned int b = (((w >> 10) & PALETTE_CHANNEL) * keep + tb) >> 5;
+        dest[i] = (r & PALETTE_CHANNEL) | ((g & PALETTE_CHANNEL) << 5) | ((b & PALETTE_CHANNEL) << 10);
+    }
+}
+
+/* take on a palette from ROM, with no effects on it */
+void palette_bank_init(struct PaletteBank* bank, const unsigned short* source, unsigned short* hardware) {
+    bank->source = source;
+    bank->hardware = hardware;
+
+    /* the colours past the last one drawn with are never seen */
+    int last = 0;
+    for (int c = 0; c < PALETTE_COLORS; c++) {
+        if (source[c]) {
+            last = c;
+        }
+    }
+    bank->words = last / 2 + 1;
+
+    bank->fade_color = PALETTE_BLACK;
+    bank->fade_level = 0;
+    bank->fade_target = 0;
+    bank->fade_step = 0;
+    bank->flash_color = PALETTE_WHITE;
+    bank->flash_level = 0;
+    bank->flash_decay = 0;
+    bank->cycle_count = 0;
+    bank->recycle = 1;
+    bank->dirty = 0;
+}
+
+void palettes_init(struct Palettes* palettes, const unsigned short* bg_source, unsigned short* bg_hardware,
+        const unsigned short* sprite_source, unsigned short* sprite_hardware) {
+    palette_bank_init(&palettes->banks[PALETTE_BG], bg_source, bg_hardware);
+    palette_bank_init(&palettes->banks[PALETTE_SPRITES], sprite_source, sprite_hardware);
+    palettes->blended = 0;
+    palettes->worst = 0;
+    palettes->total = 0;
+    palettes->uploads = 0;
+    palettes->dropped = 0;
+}
+
+/* fade a bank towards a colour, reaching level (0 to 32) after the given
+ * number of vblanks. fading to level 0 brings the palette back */
+void palette_fade(struct PaletteBank* bank, unsigned short color, int level, int vblanks) {
+    if (level != 0) {
+        bank->fade_color = color;
+    }
+    bank->fade_target = level * PALETTE_FADE_ONE;
+    if (vblanks < 1) {
+        bank->fade_level = bank->fade_target;
+        bank->fade_step = 0;
+        bank->dirty = 1;
+        return;
+    }
+    int distance = bank->fade_target - bank->fade_level;
+    bank->fade_step = distance / vblanks;
+    if (bank->fade_step == 0) {
+        bank->fade_step = distance < 0 ? -1 : 1;
+    }
+}
+
+/* whether a bank's fade has got where it was going */
+int palette_fade_done(const struct PaletteBank* bank) {
+    return bank->fade_level == bank->fade_target;
+}
+
+/* the level a blend is at now, 0 to 32 */
+int palette_fade_level(const struct PaletteBank* bank) {
+    return bank->fade_level / PALETTE_FADE_ONE;
+}
+
+/* flash a bank to a colour at a level, dying away over the given number
+ * of vblanks. a weaker flash does not cut short a stronger one */
+void palette_flash(struct PaletteBank* bank, unsigned short color, int level, int vblanks) {
+    if (level <= bank->flash_level) {
+        return;
+    }
+    bank->flash_color = color;
+    bank->flash_level = level;
+    bank->flash_decay = vblanks < 1 ? level : (level + vblanks - 1) / vblanks;
+    bank->dirty = 1;
+}
+
+/* rotate count colours from first one place every delay vblanks. returns
+ * the cycle's index, or -1 if there is no room */
+int palette_cycle_add(struct PaletteBank* bank, int first, int count, int delay) {
+    if (bank->cycle_count >= PALETTE_CYCLES_MAX || count < 2 || first + count > PALETTE_COLORS) {
+        return -1;
+    }
+    struct PaletteCycle* cycle = &bank->cycles[bank->cycle_count];
+    cycle->first = first;
+    cycle->count = count;
+    cycle->delay = delay < 1 ? 1 : delay;
+    cycle->counter = 0;
+    cycle->phase = 0;
+    if (first + count > bank->words * 2) {
+        bank->words = (first + count + 1) / 2;
+    }
+    return bank->cycle_count++;
+}
+
+/* move a bank's cycles, fade and flash on a vblank, noting what changed */
+void palette_bank_step(struct PaletteBank* bank) {
+    for (int i = 0; i < bank->cycle_count; i++) {
+        struct PaletteCycle* cycle = &bank->cycles[i];
+        if (++cycle->counter < cycle->delay) {
+            continue;
+        }
+        cycle->counter = 0;
+        if (++cycle->phase >= cycle->count) {
+            cycle->phase = 0;
+        }
+        bank->recycle = 1;
+    }
+
+    if (bank->fade_level != bank->fade_target) {
+        int before = bank->fade_level / PALETTE_FADE_ONE;
+        bank->fade_level += bank->fade_step;
+        if ((bank->fade_step > 0 && bank->fade_level > bank->fade_target) ||
+                (bank->fade_step < 0 && bank->fade_level < bank->fade_target)) {
+            bank->fade_level = bank->fade_target;
+        }
+        if (bank->fade_level / PALETTE_FADE_ONE != before) {
+            bank->dirty = 1;
+        }
+    }
+
+    if (bank->flash_level > 0) {
+        bank->flash_level -= bank->flash_decay;
+        if (bank->flash_level < 0) {
+            bank->flash_level = 0;
+        }
+        bank->dirty = 1;
+    }
+}
+
+/* work out the cycled copy of a bank from ROM */
+void palette_bank_recycle(struct PaletteBank* bank) {
+    unsigned short* cycled = (unsigned short*) bank->cycled;
+    for (int c = 0; c < bank->words * 2; c++) {
+        cycled[c] = bank->source[c];
+    }
+    for (int i = 0; i < bank->cycle_count; i++) {
+        const struct PaletteCycle* cycle = &bank->cycles[i];
+        int from = cycle->phase;
+        for (int c = 0; c < cycle->count; c++) {
+            cycled[cycle->first + c] = bank->source[cycle->first + from];
+            if (++from >= cycle->count) {
+                from = 0;
+            }
+        }
+    }
+}
+
+/* move every bank on a vblank, queueing the ones that changed with their
+ * blends on top in memory from the arena, which has to last until the queue
+ * is flushed. returns the words blended */
+int palettes_update(struct Palettes* palettes, struct DmaQueue* queue, struct Arena* scratch) {
+    int blended = 0;
+    for (int b = 0; b < PALETTE_BANKS; b++) {
+        struct PaletteBank* bank = &palettes->banks[b];
+        palette_bank_step(bank);
+        if (bank->recycle) {
+            palette_bank_recycle(bank);
+            bank->recycle = 0;
+            bank->dirty = 1;
+        }
+        if (!bank->dirty) {
+            continue;
+        }
+        unsigned int* out = arena_alloc(scratch, bank->words * 4);
+        if (!out) {
+            palettes->dropped++;
+            continue;
+        }
+
+        /* the fade goes on first and the flash over it, and a level of 0
+         * is only a copy */
+        const unsigned int* from = bank->cycled;
+        int fade = palette_fade_level(bank);
+        int flash = bank->flash_level;
+        if (fade > 0) {
+            palette_blend(out, from, bank->words, bank->fade_color, fade);
+            from = out;
+            blended += bank->words;
+        }
+        if (flash > 0) {
+            palette_blend(out, from, bank->words, bank->flash_color, flash);
+            from = out;
+            blended += bank->words;
+        }
+        if (from != out) {
+            for (int i = 0; i < bank->words; i++) {
+                out[i] = from[i];
+            }
+        }
+
+        if (dma_queue_push(queue, bank->hardware, out, bank->words * 4)) {
+            palettes->uploads++;
+            bank->dirty = 0;
+        } else {
+            palettes->dropped++;
+        }
+    }
+    palettes->blended = blended;
+    palettes->total += blended;
+    if (blended > palettes->worst) {
+        palettes->worst = blended;
+    }
+    return blended;
+}
@@ -0,0 +1,206 @@
+/* particles.h
+ * puffs, sparks and debris: short lived 8x8 sprites that fly off, fall and
+ * go out. they are only for show, so they live outside the game state and
+ * never change a hash, a snapshot or a rollback.
+ *
+ * the pool holds every particle's fields an array each, with the live ones
+ * packed at the front like the entities. the update, built as ARM and kept
+ * in IWRAM, moves every particle on in 1/256 pixels in one straight pass,
+ * then a second takes out the ones that have run out of life or left the
+ * screen and writes the rest into a run of sprites in the table that goes
+ * out in vblank, so a burst of 64 lands in one stretch of OAM. sprites left
+ * over from the frame before are hidden.
+ *
+ * particles bypass the sprite cache: their tiles are drawn at boot from the
+ * 1 bit shapes in the kind table and stay in VRAM.
+ *
+ * this needs game.h for the sprites and memory.h for the IWRAM section */
+
+/* the most particles alive at once, one sprite each */
+#define PARTICLE_CAPACITY 64
+
+/* a particle tile is 8x8 at a byte a pixel, two 32 byte tile numbers */
+#define PARTICLE_TILE_BYTES 64
+
+enum ParticleKindId {
+    PARTICLE_PUFF,      /* a breath of air blown back by a flap */
+    PARTICLE_SPARK,     /* a glint thrown off when a point is scored */
+    PARTICLE_DEBRIS,    /* the pieces when the dragon goes down */
+    PARTICLE_KINDS
+};
+
+/* what every particle of a kind has in common */
+struct ParticleKind {
+    /* the speed it starts at, in 1/256 pixels a frame, and how far either
+     * way of that it is thrown */
+    short xvel, yvel;
+    short spread;
+
+    /* added to yvel every frame */
+    short gravity;
+
+    /* the frames it lasts, and up to how many more */
+    unsigned char life;
+    unsigned char life_spread;
+
+    /* its shape, a byte a row with the high bit on the left, and the colour
+     * from the sprite palette it is drawn in */
+    unsigned char shape[8];
+    unsigned char color;
+};
+
+const struct ParticleKind particle_kinds[PARTICLE_KINDS] = {
+    /* puff: white, drifting back and a little up */
+    {-320, -96, 96, 0, 10, 8,
+        {0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00}, 3},
+    /* spark: yellow, out every way and falling slowly */
+    {0, -128, 320, 12, 20, 12,
+        {0x00, 0x00, 0x10, 0x38, 0x10, 0x00, 0x00, 0x00}, 10},
+    /* debris: red, flung hard and falling fast */
+    {-64, -384, 512, 28, 40, 24,
+        {0x00, 0x00, 0x18, 0x3c, 0x3c, 0x18, 0x00, 0x00}, 6},
+};
+
+struct Particles {
+    int count;
+
+    /* position on screen and speed, in 1/256 pixels */
+    int x[PARTICLE_CAPACITY];
+    int y[PARTICLE_CAPACITY];
+    short xvel[PARTICLE_CAPACITY];
+    short yvel[PARTICLE_CAPACITY];
+    short gravity[PARTICLE_CAPACITY];
+
+    /* frames left, and the tile number it shows */
+    unsigned char life[PARTICLE_CAPACITY];
+    unsigned short tile[PARTICLE_CAPACITY];
+
+    /* the tile number of the first kind's tile */
+    int first_tile;
+
+    /* sprites written on the last update, so the extra ones can be hidden */
+    int shown;
+
+    /* the state of the random throws */
+    unsigned int random;
+
+    /* particles moved on the last update and in all, the most alive at
+     * once, and the ones a full pool turned down */
+    int updated;
+    unsigned int total;
+    int high;
+    unsigned int dropped;
+};
+
+void particles_init(struct Particles* particles, int first_tile) {
+    particles->count = 0;
+    particles->first_tile = first_tile;
+    particles->shown = 0;
+    particles->random = 0x6d2b79f5;
+    particles->updated = 0;
+    particles->total = 0;
+    particles->high = 0;
+    particles->dropped = 0;
+}
+
+/* draw every kind's tile, one after another, into dest */
+void particle_tiles_build(unsigned char* dest) {
+    for (int k = 0; k < PARTICLE_KINDS; k++) {
+        const struct ParticleKind* kind = &particle_kinds[k];
+        for (int row = 0; row < 8; row++) {
+            for (int column = 0; column < 8; column++) {
+                int set = (kind->shape[row] >> (7 - column)) & 1;
+                *dest++ = set ? kind->color : 0;
+            }
+        }
+    }
+}
+
+/* a random number from -range to range */
+int particle_throw(struct Particles* particles, int range) {
+    unsigned int r = particles->random;
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    particles->random = r;
+    return (int) (r % (2 * range + 1)) - range;
+}
+
+/* throw out up to count particles of a kind from screen pixel x, y.
+ * returns how many there was room for */
+int particles_burst(struct Particles* particles, int kind_id, int x, int y, int count) {
+    const struct ParticleKind* kind = &particle_kinds[kind_id];
+    int room = PARTICLE_CAPACITY - particles->count;
+    if (count > room) {
+        particles->dropped += count - room;
+        count = room;
+    }
+    for (int n = 0; n < count; n++) {
+        int i = particles->count++;
+        particles->x[i] = x << 8;
+        particles->y[i] = y << 8;
+        particles->xvel[i] = kind->xvel + particle_throw(particles, kind->spread);
+        particles->yvel[i] = kind->yvel + particle_throw(particles, kind->spread);
+        particles->gravity[i] = kind->gravity;
+        particles->life[i] = kind->life + (particle_throw(particles, kind->life_spread) + kind->life_spread) / 2;
+        particles->tile[i] = particles->first_tile + kind_id * (PARTICLE_TILE_BYTES / 32);
+    }
+    if (particles->count > particles->high) {
+        particles->high = particles->count;
+    }
+    return count;
+}
+
+/* move every particle on a frame and write the live ones into the sprites
+ * from out on, returns how many are left.
+ *
+ * the fields are reached through particles each time rather than through
+ * pointers to the arrays: the sprites are shorts like most of the fields,
+ * so through plain pointers every write to a sprite could have changed a
+ * field, and the compiler would read them all again */
+IWRAM_CODE int particles_update(struct Particles* particles, struct Sprite* out) {
+    int updated = particles->count;
+    int n = particles->count;
+
+    /* move them all on first, the whole pool so the loop has a fixed
+     * length and nothing to branch on. the ones past count are thrown
+     * away, and a burst sets every field before one is used */
+    for (int i = 0; i < PARTICLE_CAPACITY; i++) {
+        particles->x[i] += particles->xvel[i];
+        particles->y[i] += particles->yvel[i];
+        particles->yvel[i] += particles->gravity[i];
+        particles->life[i]--;
+    }
+
+    /* then take out the ones that have run out of life or left the screen,
+     * the last one, already moved, taking the place of each, and write the
+     * rest into their sprites */
+    int i = 0;
+    while (i < n) {
+        int sx = particles->x[i] >> 8, sy = particles->y[i] >> 8;
+        if (particles->life[i] == 0 || sx < -8 || sx >= SCREEN_WIDTH || sy < -8 || sy >= SCREEN_HEIGHT) {
+            n--;
+            particles->x[i] = particles->x[n];
+            particles->y[i] = particles->y[n];
+            particles->xvel[i] = particles->xvel[n];
+            particles->yvel[i] = particles->yvel[n];
+            particles->gravity[i] = particles->gravity[n];
+            particles->life[i] = particles->life[n];
+            particles->tile[i] = particles->tile[n];
+            continue;
+        }
+        out[i].attribute0 = (sy & 0xff) | (1 << 13);
+        out[i].attribute1 = sx & 0x1ff;
+        out[i].attribute2 = particles->tile[i];
+        i++;
+    }
+    for (i = n; i < particles->shown; i++) {
+        out[i].attribute0 = SCREEN_HEIGHT;
+        out[i].attribute1 = SCREEN_WIDTH;
+    }
+    particles->count = n;
+    particles->shown = n;
+    particles->updated = updated;
+    particles->total += updated;
+    return n;
+}
@@ -0,0 +1,203 @@
+/* profile.h
+ * cycle counting for the GBA build. timers 2 and 3 are cascaded into one 32
+ * bit counter running at the full 16.78 MHz, and named zones add up how many
+ * cycles were spent inside them each frame. the results go out through the
+ * mGBA debug log, and the zone table sits in memory where a harness can read
+ * it back */
+
+/* the timer registers, each timer has a 16 bit count and a control word */
+volatile unsigned short* timer2_data = (volatile unsigned short*) 0x4000108;
+volatile unsigned short* timer2_control = (volatile unsigned short*) 0x400010a;
+volatile unsigned short* timer3_data = (volatile unsigned short*) 0x400010c;
+volatile unsigned short* timer3_control = (volatile unsigned short*) 0x400010e;
+
+/* timer control flags */
+#define TIMER_ENABLE 0x80
+#define TIMER_CASCADE 0x4
+
+/* there are 280896 cycles in one frame, 1232 in one scanline */
+#define CYCLES_PER_FRAME 280896
+#define CYCLES_PER_SCANLINE 1232
+
+/* the mGBA debug registers, these do nothing on real hardware */
+volatile unsigned short* debug_enable = (volatile unsigned short*) 0x4fff780;
+volatile unsigned short* debug_flags = (volatile unsigned short*) 0x4fff700;
+volatile char* debug_string = (volatile char*) 0x4fff600;
+
+/* the places we time */
+enum ProfileZoneId {
+    PROFILE_GAME_STEP,
+    PROFILE_AUTOPILOT,
+    PROFILE_NETPLAY,
+    PROFILE_ENTITY_SPAWN,
+    PROFILE_ENTITY_MOVE,
+    PROFILE_ENTITY_COLLIDE,
+    PROFILE_ENTITY_ANIMATE,
+    PROFILE_ENTITY_SYNC,
+    PROFILE_SPRITE_CACHE,
+    PROFILE_PALETTE,
+    PROFILE_LEVEL_STREAM,
+    PROFILE_PARTICLES,
+    PROFILE_TILE_LOOKUP,
+    PROFILE_DRAGON_UPDATE,
+    PROFILE_SCORE_UPDATE,
+    PROFILE_SPRITE_UPDATE,
+    PROFILE_SETUP_BACKGROUND,
+    PROFILE_GHOST,
+    PROFILE_AFFINE,
+    PROFILE_COUNT
+};
+
+/* what one zone has added up */
+struct ProfileZone {
+    const char* name;
+
+    /* the cycle count when the zone was entered */
+    unsigned int start;
+
+    /* cycles spent so far this frame, and in the last whole frame */
+    unsigned int frame;
+    unsigned int last;
+
+    /* the worst frame seen and the total over all frames */
+    unsigned int worst;
+    unsigned int total;
+
+    /* how many times the zone has been entered */
+    unsigned int calls;
+};
+
+struct ProfileZone profile_zones[PROFILE_COUNT] = {
+    {.name = "game_step"},
+    {.name = "autopilot"},
+    {.name = "netplay"},
+    {.name = "entity spawn"},
+    {.name = "entity move"},
+    {.name = "entity collide"},
+    {.name = "entity animate"},
+    {.name = "entity sync"},
+    {.name = "sprite cache"},
+    {.name = "palette"},
+    {.name = "level stream"},
+    {.name = "particles"},
+    {.name = "tile_lookup"},
+    {.name = "dragon_update"},
+    {.name = "score_update"},
+    {.name = "sprite_update_all"},
+    {.name = "setup_background"},
+    {.name = "ghost"},
+    {.name = "affine"},
+};
+
+/* the number of frames profiled so far */
+unsigned int profile_frames = 0;
+
+/* start the counter running */
+void profile_init() {
+    *timer2_control = 0;
+    *timer3_control = 0;
+    *timer2_data = 0;
+    *timer3_data = 0;
+    *timer3_control = TIMER_ENABLE | TIMER_CASCADE;
+    *timer2_control = TIMER_ENABLE;
+
+    /* turn the emulator's debug log on if there is one */
+    *debug_enable = 0xc0de;
+}
+
+/* read the 32 bit cycle counter */
+unsigned int profile_cycles() {
+    unsigned short high = *timer3_data;
+    unsigned short low = *timer2_data;
+
+    /* if the low half wrapped while we read it, read it again */
+    unsigned short again = *timer3_data;
+    if (again != high) {
+        high = again;
+        low = *timer2_data;
+    }
+    return (high << 16) | low;
+}
+
+/* enter and leave a zone */
+void profile_begin(enum ProfileZoneId id) {
+    profile_zones[id].start = profile_cycles();
+}
+void profile_end(enum ProfileZoneId id) {
+    struct ProfileZone* zone = &profile_zones[id];
+    zone->frame += profile_cycles() - zone->start;
+    zone->calls++;
+}
+
+/* close off a frame, moving this frame's counts into last and worst */
+void profile_frame() {
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        struct ProfileZone* zone = &profile_zones[i];
+        zone->last = zone->frame;
+        zone->total += zone->frame;
+        if (zone->frame > zone->worst) {
+            zone->worst = zone->frame;
+        }
+        zone->frame = 0;
+    }
+    profile_frames++;
+}
+
+/* write a line to the emulator's debug log */
+void debug_print(const char* str) {
+    int i = 0;
+    while (str[i] && i < 255) {
+        debug_string[i] = str[i];
+        i++;
+    }
+    debug_string[i] = '\0';
+
+    /* level 3 is info, 0x100 sends it */
+    *debug_flags = 3 | 0x100;
+}
+
+/* append a string or a number to a line being built, returns the new end */
+char* debug_append(char* end, const char* str) {
+    while (*str) {
+        *end++ = *str++;
+    }
+    *end = '\0';
+    return end;
+}
+char* debug_append_number(char* end, unsigned int value) {
+    char digits[10];
+    int count = 0;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    while (count) {
+        *end++ = digits[--count];
+    }
+    *end = '\0';
+    return end;
+}
+
+/* the line a benchmark build logs once its replay is over */
+#define BENCH_DONE "bench done"
+
+/* log every zone's last, worst and average cycles per frame, and what one
+ * call costs on average. cyclebench in the tools reads these lines back */
+void profile_report() {
+    char line[128];
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        struct ProfileZone* zone = &profile_zones[i];
+        char* end = debug_append(line, zone->name);
+        end = debug_append(end, ": last ");
+        end = debug_append_number(end, zone->last);
+        end = debug_append(end, " worst ");
+        end = debug_append_number(end, zone->worst);
+        end = debug_append(end, " avg ");
+        end = debug_append_number(end, profile_frames ? zone->total / profile_frames : 0);
+        end = debug_append(end, " calls ");
+        end = debug_append_number(end, zone->calls);
+        end = debug_append(end, " per call ");
+        debug_append_number(end, zone->calls ? zone->total / zone->calls : 0);
+        debug_print(line);
+    }
+}
@@ -0,0 +1,223 @@
+/* scheduler.h
+ * the work of a frame, split into tasks. each task belongs to a phase and
+ * has a priority and a deadline, counted in cycles from the start of the
+ * vblank before it:
+ *
+ *   TASK_VBLANK      runs straight after the vblank wait, and has to be done
+ *                    before the screen starts drawing again: the copies to
+ *                    video memory, scrolling and the sprite table
+ *   TASK_FRAME       runs once a frame after that, and has to be done before
+ *                    the next vblank: stepping the game and queueing what it
+ *                    changed
+ *   TASK_BACKGROUND  only runs when it has been woken, in slices, in
+ *                    whatever is left of the frame once the frame tasks are
+ *                    done, and picks up where it left off the next frame
+ *
+ * within a phase the higher priority goes first. a task that finishes past
+ * its deadline is counted as a miss rather than stopped, so the log shows
+ * which ones run long. a background slice is only started if the worst one
+ * that task has taken still fits before the frame's end, less a margin, so
+ * background work gives way to the next frame instead of making it late.
+ *
+ * a background task's run function does one bounded slice of work and
+ * returns nonzero while there is more to do. the other phases ignore what
+ * theirs return. with no clock everything runs and nothing is timed, which
+ * is what the host tools use when they only want the order */
+
+/* the most tasks */
+#define SCHEDULER_TASKS 16
+
+/* a frame is 228 scanlines of 1232 cycles, the last 68 of them vblank */
+#define SCHEDULER_FRAME_CYCLES 280896
+#define SCHEDULER_VBLANK_CYCLES (68 * 1232)
+
+/* how far short of the next vblank background slices stop by default */
+#define SCHEDULER_MARGIN (8 * 1232)
+
+enum TaskPhase {
+    TASK_VBLANK,
+    TASK_FRAME,
+    TASK_BACKGROUND,
+    TASK_PHASES
+};
+
+struct Task {
+    const char* name;
+    int (*run)(void* data);
+    void* data;
+
+    unsigned char phase;
+    unsigned char priority;
+
+    /* whether a background task has work waiting */
+    unsigned char pending;
+
+    /* cycles from the start of vblank it has to be done by */
+    unsigned int deadline;
+
+    /* times it has run (slices, for background tasks), times it finished
+     * late, and the cycles its last and worst run took */
+    unsigned int runs;
+    unsigned int misses;
+    unsigned int last;
+    unsigned int worst;
+};
+
+struct Scheduler {
+    struct Task tasks[SCHEDULER_TASKS];
+    int count;
+
+    /* task indices, by phase and then priority */
+    unsigned char order[SCHEDULER_TASKS];
+
+    /* optional cycle counter, and when the last vblank started on it */
+    unsigned int (*clock)();
+    unsigned int vblank_start;
+
+    /* background slices stop this many cycles short of the next vblank */
+    unsigned int margin;
+
+    /* frames run, misses over all tasks, cycles left over at the end of the
+     * last frame's background, and frames whose background work had to
+     * wait for the next one */
+    unsigned int frames;
+    unsigned int misses;
+    unsigned int idle;
+    unsigned int deferred;
+};
+
+void scheduler_init(struct Scheduler* scheduler, unsigned int (*clock)()) {
+    scheduler->count = 0;
+    scheduler->clock = clock;
+    scheduler->vblank_start = clock ? clock() : 0;
+    scheduler->margin = SCHEDULER_MARGIN;
+    scheduler->frames = 0;
+    scheduler->misses = 0;
+    scheduler->idle = 0;
+    scheduler->deferred = 0;
+}
+
+/* the deadline a phase's tasks get unless they ask for another */
+unsigned int scheduler_phase_deadline(int phase) {
+    return phase == TASK_VBLANK ? SCHEDULER_VBLANK_CYCLES : SCHEDULER_FRAME_CYCLES;
+}
+
+/* add a task, with a deadline of 0 meaning the end of its phase. returns
+ * the task's index, or -1 if there is no room */
+int scheduler_add(struct Scheduler* scheduler, const char* name, int phase, int priority,
+        unsigned int deadline, int (*run)(void* data), void* data) {
+    if (scheduler->count >= SCHEDULER_TASKS || phase < 0 || phase >= TASK_PHASES) {
+        return -1;
+    }
+    int id = scheduler->count++;
+    struct Task* task = &scheduler->tasks[id];
+    task->name = name;
+    task->run = run;
+    task->data = data;
+    task->phase = phase;
+    task->priority = priority;
+    task->pending = 0;
+    task->deadline = deadline ? deadline : scheduler_phase_deadline(phase);
+    task->runs = 0;
+    task->misses = 0;
+    task->last = 0;
+    task->worst = 0;
+
+    /* slot it in after everything that goes before it */
+    int at = id;
+    while (at > 0) {
+        const struct Task* before = &scheduler->tasks[scheduler->order[at - 1]];
+        if (before->phase < phase || (before->phase == phase && before->priority >= priority)) {
+            break;
+        }
+        scheduler->order[at] = scheduler->order[at - 1];
+        at--;
+    }
+    scheduler->order[at] = id;
+    return id;
+}
+
+/* give a background task work to do */
+void scheduler_wake(struct Scheduler* scheduler, int id) {
+    if (id >= 0 && id < scheduler->count) {
+        scheduler->tasks[id].pending = 1;
+    }
+}
+
+/* cycles since the last vblank started */
+unsigned int scheduler_elapsed(const struct Scheduler* scheduler) {
+    return scheduler->clock ? scheduler->clock() - scheduler->vblank_start : 0;
+}
+
+/* run a task once, timing it and checking it against its deadline */
+int scheduler_run_task(struct Scheduler* scheduler, struct Task* task) {
+    unsigned int start = scheduler_elapsed(scheduler);
+    int more = task->run(task->data);
+    unsigned int end = scheduler_elapsed(scheduler);
+    task->runs++;
+    task->last = end - start;
+    if (task->last > task->worst) {
+        task->worst = task->last;
+    }
+    if (end > task->deadline) {
+        task->misses++;
+        scheduler->misses++;
+    }
+    return more;
+}
+
+/* run every task of a phase, in order */
+void scheduler_run_phase(struct Scheduler* scheduler, int phase) {
+    for (int i = 0; i < scheduler->count; i++) {
+        struct Task* task = &scheduler->tasks[scheduler->order[i]];
+        if (task->phase == phase) {
+            scheduler_run_task(scheduler, task);
+        }
+    }
+}
+
+/* call straight after the vblank wait: note when vblank began, and run the
+ * vblank tasks */
+void scheduler_vblank(struct Scheduler* scheduler) {
+    if (scheduler->clock) {
+        scheduler->vblank_start = scheduler->clock();
+    }
+    scheduler_run_phase(scheduler, TASK_VBLANK);
+}
+
+/* run background slices for as long as the frame has room for them,
+ * highest priority first */
+void scheduler_background(struct Scheduler* scheduler) {
+    unsigned int limit = SCHEDULER_FRAME_CYCLES - scheduler->margin;
+    int waiting = 0;
+    for (int i = 0; i < scheduler->count; i++) {
+        struct Task* task = &scheduler->tasks[scheduler->order[i]];
+        if (task->phase != TASK_BACKGROUND) {
+            continue;
+        }
+        while (task->pending) {
+            if (scheduler->clock && scheduler_elapsed(scheduler) + task->worst > limit) {
+                waiting = 1;
+                break;
+            }
+            task->pending = scheduler_run_task(scheduler, task) != 0;
+
+            /* with no clock to go by, one slice a frame */
+            if (!scheduler->clock) {
+                waiting |= task->pending;
+                break;
+            }
+        }
+    }
+
+    unsigned int elapsed = scheduler_elapsed(scheduler);
+    scheduler->idle = elapsed < limit ? limit - elapsed : 0;
+    scheduler->deferred += waiting;
+    scheduler->frames++;
+}
+
+/* run the frame tasks, then whatever background work fits after them */
+void scheduler_frame(struct Scheduler* scheduler) {
+    scheduler_run_phase(scheduler, TASK_FRAME);
+    scheduler_background(scheduler);
+}
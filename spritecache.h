@@ -0,0 +1,147 @@
+/* spritecache.h
+ * sprite tiles streamed into VRAM as they are needed. the game picks a
+ * sprite's picture by its tile offset into the sprite sheet in ROM, as if
+ * the whole sheet were in VRAM. instead a small pool of slots in sprite VRAM
+ * holds the frames shown lately, and sprite_cache_stream() rewrites each
+ * shown sprite's tile number to the slot holding its frame. a frame not in
+ * a slot is copied into the one shown least recently, through the vblank
+ * DMA queue, so it is there when the sprites go out. that way many kinds of
+ * animated sprite can share sprite VRAM, as only what is on screen has to be
+ * in it.
+ *
+ * the rewrite goes into a separate sprite table, so the game state keeps
+ * its sheet offsets and snapshots and hashes are the same either way. only
+ * 8x8 and 16x16 256 colour sprites, the only sizes the game uses, go
+ * through the cache, other sizes are passed through as they are.
+ *
+ * this needs game.h for the sprite table and dmaqueue.h for the uploads */
+
+/* the number of slots, and the size of each: one 16x16 256 colour frame,
+ * eight 32 byte tile numbers. an 8x8 frame only fills the first quarter */
+#define SPRITE_CACHE_SLOTS 12
+#define SPRITE_SLOT_BYTES 256
+#define SPRITE_SLOT_TILES (SPRITE_SLOT_BYTES / 32)
+
+/* a frame is known by its tile offset into the sheet and whether it is a
+ * 16x16 one, so offsets up to 128 can be cached */
+#define SPRITE_CACHE_KEYS 256
+#define SPRITE_CACHE_NONE 0xff
+
+struct SpriteCache {
+    /* the sprite sheet, and where slot 0 is in VRAM and which tile number
+     * it is */
+    const unsigned char* sheet;
+    unsigned char* vram;
+    int first_tile;
+
+    /* the slot each frame is in, and the frame in each slot */
+    unsigned char slot_of[SPRITE_CACHE_KEYS];
+    unsigned short key[SPRITE_CACHE_SLOTS];
+
+    /* the frame each slot was last shown on, and the frame now */
+    unsigned int shown[SPRITE_CACHE_SLOTS];
+    unsigned int now;
+
+    /* lookups that found their frame in a slot and ones that had to upload
+     * it, and sprites hidden because every slot was in use this frame */
+    unsigned int hits;
+    unsigned int misses;
+    unsigned int overflows;
+};
+
+/* set up an empty cache whose slots start at the given place in VRAM, with
+ * the given tile number */
+void sprite_cache_init(struct SpriteCache* cache, const unsigned char* sheet,
+        unsigned char* vram, int first_tile) {
+    cache->sheet = sheet;
+    cache->vram = vram;
+    cache->first_tile = first_tile;
+    for (int k = 0; k < SPRITE_CACHE_KEYS; k++) {
+        cache->slot_of[k] = SPRITE_CACHE_NONE;
+    }
+    for (int s = 0; s < SPRITE_CACHE_SLOTS; s++) {
+        cache->key[s] = SPRITE_CACHE_KEYS;
+        cache->shown[s] = 0;
+    }
+    cache->now = 1;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->overflows = 0;
+}
+
+/* the tile number of a frame, given its offset into the sheet and whether
+ * it is 16x16, uploading it if it is not in a slot. returns -1 if every
+ * slot has already been shown this frame */
+int sprite_cache_tile(struct SpriteCache* cache, int offset, int big, struct DmaQueue* queue) {
+    unsigned int key = ((unsigned int) offset << 1) | big;
+    if (key >= SPRITE_CACHE_KEYS) {
+        return -1;
+    }
+    int slot = cache->slot_of[key];
+    if (slot != SPRITE_CACHE_NONE) {
+        cache->hits++;
+        cache->shown[slot] = cache->now;
+        return cache->first_tile + slot * SPRITE_SLOT_TILES;
+    }
+
+    /* take the slot shown longest ago, as long as it was not this frame */
+    slot = 0;
+    for (int s = 1; s < SPRITE_CACHE_SLOTS; s++) {
+        if (cache->shown[s] < cache->shown[slot]) {
+            slot = s;
+        }
+    }
+    if (cache->shown[slot] == cache->now) {
+        cache->overflows++;
+        return -1;
+    }
+    unsigned char* dest = cache->vram + slot * SPRITE_SLOT_BYTES;
+    if (!dma_queue_push(queue, dest, cache->sheet + offset * 32, big ? 256 : 64)) {
+        cache->overflows++;
+        return -1;
+    }
+    cache->misses++;
+    if (cache->key[slot] < SPRITE_CACHE_KEYS) {
+        cache->slot_of[cache->key[slot]] = SPRITE_CACHE_NONE;
+    }
+    cache->key[slot] = key;
+    cache->slot_of[key] = slot;
+    cache->shown[slot] = cache->now;
+    return cache->first_tile + slot * SPRITE_SLOT_TILES;
+}
+
+/* whether a sprite is off the screen, where the game parks sprites it is
+ * not using. a sprite wraps round at 256 down and 512 across */
+int sprite_hidden(const struct Sprite* sprite) {
+    int y = sprite->attribute0 & 0xff;
+    int x = sprite->attribute1 & 0x1ff;
+    return (y >= SCREEN_HEIGHT && y <= 256 - 16) || (x >= SCREEN_WIDTH && x <= 512 - 16);
+}
+
+/* copy the game's sprites into the table that goes out this vblank,
+ * pointing each shown 8x8 or 16x16 one at the slot holding its frame */
+void sprite_cache_stream(struct SpriteCache* cache, const struct Oam* oam,
+        struct Sprite* out, struct DmaQueue* queue) {
+    cache->now++;
+    for (int i = 0; i < NUM_SPRITES; i++) {
+        const struct Sprite* sprite = &oam->sprites[i];
+        out[i] = *sprite;
+        if (sprite_hidden(sprite)) {
+            continue;
+        }
+
+        /* shape square, and size 8x8 or 16x16 */
+        int shape = sprite->attribute0 >> 14;
+        int size = sprite->attribute1 >> 14;
+        if (shape != 0 || size > 1) {
+            continue;
+        }
+        int tile = sprite_cache_tile(cache, sprite->attribute2 & 0x3ff, size, queue);
+        if (tile < 0) {
+            out[i].attribute0 = SCREEN_HEIGHT;
+            out[i].attribute1 = SCREEN_WIDTH;
+            continue;
+        }
+        out[i].attribute2 = (sprite->attribute2 & 0xfc00) | tile;
+    }
+}
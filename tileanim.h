@@ -0,0 +1,118 @@
+/* tileanim.h
+ * background tiles that animate by having their pixels replaced. every cell
+ * of a map that uses a tile shows the same pixels from the char block, so
+ * swapping in a tile's next frame animates all of those cells with one 64
+ * byte copy, however many there are. nothing in the maps changes.
+ *
+ * each animation steps through up to TILE_ANIM_FRAMES frames of a tile on
+ * its own delay, and a tile is only copied on the vblanks its frame changes,
+ * through the vblank DMA queue. frames can come from ROM, or be built at
+ * boot from the tile's own pixels with tile_anim_recolour().
+ *
+ * this needs dmaqueue.h for the uploads */
+
+/* the most animations, and the most frames each */
+#define TILE_ANIM_MAX 8
+#define TILE_ANIM_FRAMES 4
+
+/* a 256 colour tile is 8x8 bytes */
+#define TILE_BYTES 64
+
+struct TileAnimation {
+    /* which tile of the char block it replaces */
+    unsigned short tile;
+
+    /* how many frames, how many vblanks each shows for, and the pixels of
+     * each */
+    unsigned char frame_count;
+    unsigned char delay;
+    const unsigned char* frames[TILE_ANIM_FRAMES];
+
+    /* the frame showing and vblanks until the next one */
+    unsigned char frame;
+    unsigned char counter;
+};
+
+struct TileAnimator {
+    /* where tile 0 of the char block is */
+    unsigned char* char_block;
+
+    struct TileAnimation animations[TILE_ANIM_MAX];
+    int count;
+
+    /* tiles copied on the last update, the most on any update, and the
+     * total, along with updates whose copies the queue turned down */
+    int uploads;
+    int worst;
+    unsigned int total;
+    unsigned int dropped;
+};
+
+void tile_animator_init(struct TileAnimator* animator, unsigned char* char_block) {
+    animator->char_block = char_block;
+    animator->count = 0;
+    animator->uploads = 0;
+    animator->worst = 0;
+    animator->total = 0;
+    animator->dropped = 0;
+}
+
+/* animate a tile through the given frames, each shown for delay vblanks.
+ * returns the animation's index, or -1 if there is no room */
+int tile_animator_add(struct TileAnimator* animator, int tile, const unsigned char** frames,
+        int frame_count, int delay) {
+    if (animator->count >= TILE_ANIM_MAX || frame_count < 1 || frame_count > TILE_ANIM_FRAMES) {
+        return -1;
+    }
+    struct TileAnimation* animation = &animator->animations[animator->count];
+    animation->tile = tile;
+    animation->frame_count = frame_count;
+    animation->delay = delay < 1 ? 1 : delay;
+    for (int f = 0; f < frame_count; f++) {
+        animation->frames[f] = frames[f];
+    }
+    animation->frame = 0;
+    animation->counter = 0;
+    return animator->count++;
+}
+
+/* move every animation on a vblank, queueing the tiles whose frame changed */
+void tile_animator_update(struct TileAnimator* animator, struct DmaQueue* queue) {
+    int uploads = 0;
+    for (int i = 0; i < animator->count; i++) {
+        struct TileAnimation* animation = &animator->animations[i];
+        if (++animation->counter < animation->delay) {
+            continue;
+        }
+        animation->counter = 0;
+        if (++animation->frame >= animation->frame_count) {
+            animation->frame = 0;
+        }
+        if (dma_queue_push(queue, animator->char_block + animation->tile * TILE_BYTES,
+                    animation->frames[animation->frame], TILE_BYTES)) {
+            uploads++;
+        } else {
+            animator->dropped++;
+        }
+    }
+    animator->uploads = uploads;
+    animator->total += uploads;
+    if (uploads > animator->worst) {
+        animator->worst = uploads;
+    }
+}
+
+/* build a frame from a tile's pixels with two colours swapped round, or
+ * with one changed to the other if both_ways is 0 */
+void tile_anim_recolour(unsigned char* dest, const unsigned char* tile,
+        unsigned char from, unsigned char to, int both_ways) {
+    for (int i = 0; i < TILE_BYTES; i++) {
+        unsigned char pixel = tile[i];
+        if (pixel == from) {
+            pixel = to;
+        } else if (both_ways && pixel == to) {
+            pixel = from;
+        }
+        dest[i] = pixel;
+    }
+}
@@ -0,0 +1,241 @@
+/* affinebench.c
+ * checks the affine tables for the title and the end screen against the
+ * same views worked out in floating point, then shows what building them
+ * costs.
+ *
+ *   gcc -O2 -o affinebench tools/affinebench.c
+ *
+ *   affinebench [-f frames] [-o dir]
+ *
+ * the title is built for the given number of frames (1024 by default) and
+ * the end screen for its zoom and a while after. on every line of every
+ * table, where the first and last pixels land in the map has to be within
+ * two texels of the true turn and scale, and the table the flip hands over
+ * has to be the one just built. a view built twice has to be skipped the
+ * second time, and the end screen has to stop building once it is still.
+ *
+ * then it times building tables of the title, with and without its ripple,
+ * a table a frame, and prints the time a table and a line. the ROM logs
+ * the same in cycles, as "affine:".
+ *
+ * with -o it draws every 32nd frame of the title and every 8th of the zoom
+ * over the back layer into the directory, as title-N.ppm and end-N.ppm */
+
+#define PHLAPU_HOST
+#include "../memory.h"
+#include "../game.h"
+#include "../affine.h"
+#include "../score.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "ppu.h"
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* the most a line's ends can be off, in 1/256 texels */
+#define TOLERANCE (2 * 256)
+
+#define PI 3.14159265358979323846
+
+/* the sine of a step round of 256 by its series, so the check owes
+ * nothing to the table it is checking */
+static double exact_sine(int step) {
+    double a = 2 * PI * ((step & (AFFINE_TURN - 1)) - AFFINE_TURN / 2) / AFFINE_TURN;
+    double term = a, sum = a;
+    for (int n = 1; n < 12; n++) {
+        term *= -a * a / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    /* a half turn back from where it started */
+    return -sum;
+}
+
+static double distance(double a, double b) {
+    return a > b ? a - b : b - a;
+}
+
+/* where a pixel of a view lands in the map, in 1/256 texels, worked out
+ * with no tables */
+static void exact(const struct AffineView* view, int line, int x, double* tx, double* ty) {
+    double scale = view->scale + view->ripple * exact_sine(view->phase + line * AFFINE_RIPPLE_STEP);
+    double sine = exact_sine(view->angle), cosine = exact_sine(view->angle + AFFINE_TURN / 4);
+    double dx = x - view->screen_x, dy = line - view->screen_y;
+    *tx = view->center_x * 256.0 + scale * (cosine * dx + sine * dy);
+    *ty = view->center_y * 256.0 + scale * (-sine * dx + cosine * dy);
+}
+
+/* check a table against its view, returns the worst error or -1 if the
+ * table is broken */
+static double check(const struct AffineLine* lines, const struct AffineView* view) {
+    double worst = 0;
+    for (int i = 0; i < AFFINE_LINES; i++) {
+        const struct AffineLine* line = &lines[i];
+        if (line->pc != -line->pb || line->pd != line->pa) {
+            return -1;
+        }
+        for (int x = 0; x < SCREEN_WIDTH; x += SCREEN_WIDTH - 1) {
+            double tx, ty;
+            exact(view, i, x, &tx, &ty);
+            double ex = distance(line->x + (double) line->pa * x, tx);
+            double ey = distance(line->y + (double) line->pc * x, ty);
+            worst = ex > worst ? ex : worst;
+            worst = ey > worst ? ey : worst;
+        }
+    }
+    return worst;
+}
+
+/* draw the page from a table of lines the way the hardware walks it: from
+ * each line's start by pa and pc a pixel, with nothing past the edges */
+static void draw_affine(const struct Ppu* ppu, struct PpuFrame* frame, const unsigned char* map, int size,
+        const struct AffineLine* lines) {
+    int tiles = (int) sizeof(background_data) / 64;
+    int edge = size * 8 * 256;
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        int tx = lines[y].x, ty = lines[y].y;
+        for (int x = 0; x < SCREEN_WIDTH; x++, tx += lines[y].pa, ty += lines[y].pc) {
+            if (tx < 0 || ty < 0 || tx >= edge || ty >= edge) {
+                continue;
+            }
+            int mx = tx >> 8, my = ty >> 8;
+            int tile = map[(my >> 3) * size + (mx >> 3)];
+            if (tile >= tiles) {
+                continue;
+            }
+            int index = background_data[tile * 64 + (my & 7) * 8 + (mx & 7)];
+            if (index) {
+                memcpy(frame->rgb[y][x], ppu->bg[index], 3);
+            }
+        }
+    }
+}
+
+static struct Ppu ppu;
+static struct AffineTable table;
+
+/* the page packed as the ROM packs it into VRAM */
+static unsigned short packed[score_width * score_height / 2];
+
+static int write_frame(const char* dir, const char* name, int frame, const struct AffineLine* lines) {
+    static struct PpuFrame picture;
+    char path[512];
+    ppu_draw_background(&ppu, &picture, layer0map, layer0map_width, layer0map_height, 0, 0);
+    draw_affine(&ppu, &picture, (const unsigned char*) packed, score_width, lines);
+    snprintf(path, sizeof(path), "%s/%s-%d.ppm", dir, name, frame);
+    if (ppu_write_ppm(&picture, path) != 0) {
+        fprintf(stderr, "affinebench: cannot write %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+/* build a view, flip to it and check it, returns the error or -1 */
+static double build_and_check(const struct AffineView* view) {
+    affine_build(&table, view);
+    return check(affine_flip(&table), view);
+}
+
+/* time building the title a table a frame, with or without its ripple */
+static double time_title(int frames, int ripple) {
+    struct AffineView view;
+    affine_init(&table);
+    double start = now_seconds();
+    for (int f = 0; f < frames; f++) {
+        affine_title_view(&view, f);
+        if (!ripple) {
+            view.ripple = 0;
+        }
+        affine_build(&table, &view);
+        affine_flip(&table);
+    }
+    return (now_seconds() - start) / frames;
+}
+
+int main(int argc, char** argv) {
+    int frames = 1024;
+    const char* dir = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            dir = argv[++i];
+        } else {
+            frames = 0;
+            break;
+        }
+    }
+    if (frames <= 0) {
+        fprintf(stderr, "usage: affinebench [-f frames] [-o dir]\n");
+        return 2;
+    }
+    ppu_init(&ppu);
+    affine_map_pack(packed, score, score_width * score_height);
+
+    /* the title, every frame a new view */
+    struct AffineView view;
+    double worst = 0;
+    affine_init(&table);
+    for (int f = 0; f < frames; f++) {
+        affine_title_view(&view, f);
+        double error = build_and_check(&view);
+        if (error < 0 || error > TOLERANCE) {
+            fprintf(stderr, "affinebench: title frame %d is %.0f/256 texels out\n", f, error);
+            return 1;
+        }
+        worst = error > worst ? error : worst;
+        if (dir && f % 32 == 0 && write_frame(dir, "title", f, table.lines[table.front]) != 0) {
+            return 1;
+        }
+    }
+
+    /* the same view again needs no building */
+    unsigned int builds = table.builds;
+    const struct AffineLine* shown = affine_flip(&table);
+    affine_build(&table, &view);
+    if (table.builds != builds || affine_flip(&table) != shown) {
+        fprintf(stderr, "affinebench: the same view was built again\n");
+        return 1;
+    }
+
+    /* the end screen, which has to stop building once it is still */
+    affine_init(&table);
+    int settle = AFFINE_ZOOM_FRAMES + 16;
+    for (int f = 0; f < settle; f++) {
+        affine_zoom_view(&view, f);
+        double error = build_and_check(&view);
+        if (error < 0 || error > TOLERANCE) {
+            fprintf(stderr, "affinebench: end screen frame %d is %.0f/256 texels out\n", f, error);
+            return 1;
+        }
+        worst = error > worst ? error : worst;
+        if (dir && (f % 8 == 0 || f == AFFINE_ZOOM_FRAMES) &&
+                write_frame(dir, "end", f, table.lines[table.front]) != 0) {
+            return 1;
+        }
+    }
+    if (table.builds != AFFINE_ZOOM_FRAMES + 1) {
+        fprintf(stderr, "affinebench: the end screen built %u tables, wanted %d\n", table.builds,
+                AFFINE_ZOOM_FRAMES + 1);
+        return 1;
+    }
+    const struct AffineLine* still = table.lines[table.front];
+    if (still[0].pa != AFFINE_ONE || still[0].pb != 0 || still[0].x != 0 || still[0].y != 0) {
+        fprintf(stderr, "affinebench: the end screen did not come to rest on the page as it is\n");
+        return 1;
+    }
+    printf("%d title and %d end screen tables, worst %.0f/256 texels out, %u skipped once still\n",
+            frames, settle, worst, table.skips);
+
+    int timed = frames * 64;
+    double rippled = time_title(timed, 1);
+    double flat = time_title(timed, 0);
+    printf("title with ripple %.0f ns a table, %.1f ns a line\n", rippled * 1e9, rippled * 1e9 / AFFINE_LINES);
+    printf("title without     %.0f ns a table, %.1f ns a line\n", flat * 1e9, flat * 1e9 / AFFINE_LINES);
+    return 0;
+}
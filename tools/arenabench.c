@@ -0,0 +1,192 @@
+/* arenabench.c
+ * checks the arena and block pool in memory.h, and measures them against
+ * malloc and free doing the same work.
+ *
+ *   gcc -O2 -o arenabench tools/arenabench.c
+ *
+ *   arenabench [frames]
+ *
+ * each frame takes a run of scratch buffers of mixed sizes and hands them
+ * all back, the way the frame arena is used, and takes and gives back
+ * blocks in a shuffled order, the way a pool is. every buffer is filled and
+ * checked, so any two handed out over each other are caught. it runs the
+ * given number of frames (100000 by default), then prints the time per
+ * allocation each way and the high-water marks */
+
+#define PHLAPU_HOST
+#include "../memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* scratch buffers taken each frame, and the sizes they come in */
+#define SCRATCH_PER_FRAME 24
+static const unsigned int scratch_sizes[] = {6, 16, 30, 64, 100, 128};
+#define SCRATCH_SIZES ((int) (sizeof(scratch_sizes) / sizeof(scratch_sizes[0])))
+
+/* the pool's blocks, and how many are out at most */
+#define BLOCK_SIZE 24
+#define BLOCK_COUNT 64
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* fill a buffer with its tag, and check nothing else wrote over it */
+static void fill(void* p, unsigned int bytes, unsigned char tag) {
+    memset(p, tag, bytes);
+}
+static int intact(const void* p, unsigned int bytes, unsigned char tag) {
+    const unsigned char* b = p;
+    for (unsigned int i = 0; i < bytes; i++) {
+        if (b[i] != tag) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 100000;
+    if (frames <= 0) {
+        fprintf(stderr, "usage: arenabench [frames]\n");
+        return 2;
+    }
+
+    static unsigned int frame_memory[2048 / 4];
+    static unsigned int block_memory[BLOCK_SIZE * BLOCK_COUNT / 4];
+    struct Arena arena;
+    struct BlockPool pool;
+    arena_init(&arena, "frame", frame_memory, sizeof(frame_memory));
+    block_pool_init(&pool, "blocks", block_memory, sizeof(block_memory), BLOCK_SIZE);
+    if (pool.capacity != BLOCK_COUNT) {
+        fprintf(stderr, "arenabench: the pool has %d blocks, not %d\n", pool.capacity, BLOCK_COUNT);
+        return 1;
+    }
+
+    /* the same sizes and orders for every way of doing it */
+    unsigned int sizes[SCRATCH_PER_FRAME];
+    int order[BLOCK_COUNT];
+    unsigned int r = 1;
+    for (int i = 0; i < SCRATCH_PER_FRAME; i++) {
+        r ^= r << 13;
+        r ^= r >> 17;
+        r ^= r << 5;
+        sizes[i] = scratch_sizes[r % SCRATCH_SIZES];
+    }
+    for (int i = 0; i < BLOCK_COUNT; i++) {
+        order[i] = i;
+    }
+    for (int i = BLOCK_COUNT - 1; i > 0; i--) {
+        r ^= r << 13;
+        r ^= r >> 17;
+        r ^= r << 5;
+        int j = r % (i + 1);
+        int swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+    }
+
+    /* check a frame's worth of each first, tagging every buffer */
+    void* scratch[SCRATCH_PER_FRAME];
+    for (int i = 0; i < SCRATCH_PER_FRAME; i++) {
+        scratch[i] = arena_alloc(&arena, sizes[i]);
+        if (!scratch[i] || ((unsigned long) scratch[i] & (MEMORY_ALIGN - 1))) {
+            fprintf(stderr, "arenabench: scratch %d is missing or unaligned\n", i);
+            return 1;
+        }
+        fill(scratch[i], sizes[i], (unsigned char) i);
+    }
+    void* blocks[BLOCK_COUNT];
+    for (int i = 0; i < BLOCK_COUNT; i++) {
+        blocks[i] = block_alloc(&pool);
+        if (!blocks[i] || block_at(&pool, block_index(&pool, blocks[i])) != blocks[i]) {
+            fprintf(stderr, "arenabench: block %d is missing or misplaced\n", i);
+            return 1;
+        }
+        fill(blocks[i], BLOCK_SIZE, (unsigned char) (0x80 + i));
+    }
+    for (int i = 0; i < SCRATCH_PER_FRAME; i++) {
+        if (!intact(scratch[i], sizes[i], (unsigned char) i)) {
+            fprintf(stderr, "arenabench: scratch %d was written over\n", i);
+            return 1;
+        }
+    }
+    for (int i = 0; i < BLOCK_COUNT; i++) {
+        if (!intact(blocks[i], BLOCK_SIZE, (unsigned char) (0x80 + i))) {
+            fprintf(stderr, "arenabench: block %d was written over\n", i);
+            return 1;
+        }
+    }
+    if (block_alloc(&pool) || pool.failures != 1) {
+        fprintf(stderr, "arenabench: a full pool still handed out a block\n");
+        return 1;
+    }
+    for (int i = 0; i < BLOCK_COUNT; i++) {
+        block_free(&pool, blocks[order[i]]);
+    }
+    arena_reset(&arena);
+
+    /* then time them, touching one word of each so the work is not dropped */
+    double start = now_seconds();
+    for (int f = 0; f < frames; f++) {
+        arena_reset(&arena);
+        for (int i = 0; i < SCRATCH_PER_FRAME; i++) {
+            scratch[i] = arena_alloc(&arena, sizes[i]);
+            *(volatile unsigned char*) scratch[i] = (unsigned char) i;
+        }
+    }
+    double arena_time = now_seconds() - start;
+
+    start = now_seconds();
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < SCRATCH_PER_FRAME; i++) {
+            scratch[i] = malloc(sizes[i]);
+            *(volatile unsigned char*) scratch[i] = (unsigned char) i;
+        }
+        for (int i = 0; i < SCRATCH_PER_FRAME; i++) {
+            free(scratch[i]);
+        }
+    }
+    double scratch_malloc_time = now_seconds() - start;
+
+    start = now_seconds();
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < BLOCK_COUNT; i++) {
+            blocks[i] = block_alloc(&pool);
+            *(volatile unsigned char*) blocks[i] = (unsigned char) i;
+        }
+        for (int i = 0; i < BLOCK_COUNT; i++) {
+            block_free(&pool, blocks[order[i]]);
+        }
+    }
+    double pool_time = now_seconds() - start;
+
+    start = now_seconds();
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < BLOCK_COUNT; i++) {
+            blocks[i] = malloc(BLOCK_SIZE);
+            *(volatile unsigned char*) blocks[i] = (unsigned char) i;
+        }
+        for (int i = 0; i < BLOCK_COUNT; i++) {
+            free(blocks[order[i]]);
+        }
+    }
+    double block_malloc_time = now_seconds() - start;
+
+    double scratch_count = (double) frames * SCRATCH_PER_FRAME;
+    double block_count = (double) frames * BLOCK_COUNT;
+    printf("%d frames\n\n", frames);
+    printf("            ns/alloc  malloc ns/alloc\n");
+    printf("arena       %8.2f  %15.2f\n", 1e9 * arena_time / scratch_count,
+            1e9 * scratch_malloc_time / scratch_count);
+    printf("block pool  %8.2f  %15.2f\n\n", 1e9 * pool_time / block_count,
+            1e9 * block_malloc_time / block_count);
+    printf("%s arena: high %u of %u, failed %u\n", arena.name, arena.high, arena.size, arena.failures);
+    printf("%s pool: high %d of %d, failed %u\n", pool.name, pool.high, pool.capacity, pool.failures);
+    return 0;
+}
@@ -0,0 +1,158 @@
+/* autopilotbench.c
+ * measures how often the autopilot survives against how much searching it
+ * is allowed to do.
+ *
+ *   gcc -O2 -pthread -o autopilotbench tools/autopilotbench.c
+ *
+ *   autopilotbench [-j N] [--maps N] [--seed S] [--frames N] [budget...]
+ *
+ * each node budget (16 to 4096 by default) is run against the shipped map
+ * and a number of generated ones for a fixed number of frames. for each
+ * budget it prints the share of runs that survived to the end, the mean
+ * frames survived, and the nodes and host time the search took per frame.
+ * runs go across all cores on the work-stealing pool */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../autopilot.h"
+
+#include <time.h>
+
+#include "maps.h"
+#include "pool.h"
+
+/* one run of the autopilot on one map with one budget */
+struct Run {
+    int budget;
+    int map;
+
+    /* results */
+    int frames;
+    int alive;
+    unsigned int nodes;
+    unsigned int worst_nodes;
+    unsigned int depth;
+    double seconds;
+};
+
+struct Bench {
+    struct Tilemap* maps;
+    struct Run* runs;
+    int frames;
+};
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void bench_job(void* arg, int index, int worker) {
+    struct Bench* b = arg;
+    struct Run* run = &b->runs[index];
+    struct Autopilot* ap = malloc(sizeof(struct Autopilot));
+    struct Game game;
+    (void) worker;
+
+    autopilot_init(ap, run->budget);
+    game_init(&game, &b->maps[run->map]);
+
+    double spent = 0;
+    run->worst_nodes = 0;
+    run->depth = 0;
+    for (run->frames = 0; run->frames < b->frames; run->frames++) {
+        double start = now_seconds();
+        int flapping = autopilot_decide(ap, &game);
+        spent += now_seconds() - start;
+
+        if (ap->nodes > (int) run->worst_nodes) {
+            run->worst_nodes = ap->nodes;
+        }
+        run->depth += ap->reached;
+        if (!game_step(&game, flapping ? BUTTON_A : 0)) {
+            run->frames++;
+            break;
+        }
+    }
+    run->alive = game.dragon.alive;
+    run->nodes = ap->total_nodes;
+    run->seconds = spent;
+    free(ap);
+}
+
+int main(int argc, char** argv) {
+    int threads = pool_cores();
+    int map_count = 32;
+    unsigned int seed = 1;
+    int frames = 1800;
+    int budgets[32];
+    int budget_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--maps") == 0 && i + 1 < argc) {
+            map_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int) strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && budget_count < 32) {
+            budgets[budget_count++] = atoi(argv[i]);
+        } else {
+            fprintf(stderr, "usage: autopilotbench [-j N] [--maps N] [--seed S] "
+                    "[--frames N] [budget...]\n");
+            return 2;
+        }
+    }
+    if (budget_count == 0) {
+        for (int b = 16; b <= 4096; b *= 2) {
+            budgets[budget_count++] = b;
+        }
+    }
+
+    /* the shipped map first, then the generated ones */
+    struct Bench bench;
+    int maps = map_count + 1;
+    bench.maps = malloc(sizeof(struct Tilemap) * maps);
+    bench.maps[0] = ground_tilemap;
+    for (int i = 1; i < maps; i++) {
+        generate_map(seed + i - 1, &bench.maps[i]);
+    }
+    bench.frames = frames;
+
+    int count = budget_count * maps;
+    bench.runs = calloc(count, sizeof(struct Run));
+    for (int i = 0; i < count; i++) {
+        bench.runs[i].budget = budgets[i / maps];
+        bench.runs[i].map = i % maps;
+    }
+
+    struct Pool* pool = calloc(1, sizeof(struct Pool));
+    pool_run(pool, threads, count, bench_job, &bench);
+
+    printf("%d maps, %d frames each, %d threads\n\n", maps, frames, pool->threads);
+    printf("budget  survived  mean frames  nodes/frame  worst nodes  mean depth  us/frame\n");
+    for (int b = 0; b < budget_count; b++) {
+        int survived = 0;
+        unsigned long long total_frames = 0, nodes = 0, depth = 0;
+        unsigned int worst = 0;
+        double seconds = 0;
+        for (int m = 0; m < maps; m++) {
+            struct Run* run = &bench.runs[b * maps + m];
+            survived += run->alive;
+            total_frames += run->frames;
+            nodes += run->nodes;
+            depth += run->depth;
+            seconds += run->seconds;
+            if (run->worst_nodes > worst) {
+                worst = run->worst_nodes;
+            }
+        }
+        printf("%6d  %7.1f%%  %11.1f  %11.1f  %11u  %10.1f  %8.2f\n", budgets[b],
+                100.0 * survived / maps, (double) total_frames / maps,
+                (double) nodes / total_frames, worst, (double) depth / total_frames,
+                1e6 * seconds / total_frames);
+    }
+    return 0;
+}
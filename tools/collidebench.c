@@ -0,0 +1,123 @@
+/* collidebench.c
+ * measures the entity broad phase against testing every pair, for entity
+ * counts well past what the game itself spawns.
+ *
+ *   gcc -O2 -o collidebench tools/collidebench.c
+ *
+ *   collidebench [--frames N] [count...]
+ *
+ * for each count (16 to 1024 by default) the screen is kept filled with that
+ * many entities, moved with the game's own passes for the given number of
+ * frames (600 by default). each frame the overlapping pairs are found both
+ * ways and must agree. it prints the pairs the broad phase tested against
+ * all pairs, and the time per frame each way */
+
+#define ENTITY_CAPACITY 1024
+
+#define PHLAPU_HOST
+#include "../game.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* bring on entities of random kinds until there are count of them, at
+ * random places across the screen or at the right edge */
+static void fill(struct Entities* entities, int count, int anywhere) {
+    while (entities->count < count) {
+        unsigned int r = entities_random(entities);
+        enum EntityKind kind = (enum EntityKind) ((r >> 8) % ENTITY_KINDS);
+        const struct EntityKindInfo* info = &entity_kinds[kind];
+        int y = info->top + (int) ((r >> 16) % (unsigned int) (info->bottom - info->top + 1));
+        int i = entity_spawn(entities, kind, y);
+        if (anywhere) {
+            entity_unlink(entities, i);
+            entities->x[i] = (int) (entities_random(entities) % (SCREEN_WIDTH + 16) - 16) << 8;
+            entity_link(entities, i, entity_cell(entities->x[i]));
+        }
+    }
+}
+
+/* count the overlapping pairs by testing every one */
+static int brute_force(const struct Entities* entities) {
+    int overlaps = 0;
+    for (int a = 0; a < entities->count; a++) {
+        for (int b = a + 1; b < entities->count; b++) {
+            overlaps += entities_overlap(entities, a, b);
+        }
+    }
+    return overlaps;
+}
+
+int main(int argc, char** argv) {
+    int frames = 600;
+    int counts[32];
+    int count_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && count_count < 32) {
+            counts[count_count] = atoi(argv[i]);
+            if (counts[count_count] < 1 || counts[count_count] > ENTITY_CAPACITY) {
+                fprintf(stderr, "collidebench: counts go from 1 to %d\n", ENTITY_CAPACITY);
+                return 2;
+            }
+            count_count++;
+        } else {
+            fprintf(stderr, "usage: collidebench [--frames N] [count...]\n");
+            return 2;
+        }
+    }
+    if (count_count == 0) {
+        for (int n = 16; n <= ENTITY_CAPACITY; n *= 2) {
+            counts[count_count++] = n;
+        }
+    }
+
+    static struct Entities entities;
+    int failed = 0;
+    printf("%d frames each\n\n", frames);
+    printf("entities  all pairs  tested  overlapping  broad ns/frame  every pair ns/frame  speedup\n");
+    for (int n = 0; n < count_count; n++) {
+        entities_init(&entities, 0);
+        fill(&entities, counts[n], 1);
+
+        double broad = 0, brute = 0;
+        long long tested = 0, overlapping = 0, pairs = 0;
+        for (int frame = 0; frame < frames; frame++) {
+            entities_move(&entities);
+            fill(&entities, counts[n], 0);
+
+            double start = now_seconds();
+            int expected = brute_force(&entities);
+            double middle = now_seconds();
+            entities_grid(&entities);
+            entities_collide(&entities);
+            double end = now_seconds();
+
+            brute += middle - start;
+            broad += end - middle;
+            tested += entities.candidates;
+            overlapping += entities.overlaps;
+            pairs += (long long) entities.count * (entities.count - 1) / 2;
+            if (entities.overlaps != expected) {
+                fprintf(stderr, "collidebench: %d entities, frame %d: broad phase found %d "
+                        "overlaps, every pair %d\n", counts[n], frame, entities.overlaps, expected);
+                failed = 1;
+            }
+        }
+        printf("%8d  %9.1f  %6.1f  %11.1f  %14.1f  %19.1f  %6.1fx\n", counts[n],
+                (double) pairs / frames, (double) tested / frames,
+                (double) overlapping / frames, 1e9 * broad / frames, 1e9 * brute / frames,
+                broad > 0 ? brute / broad : 0.0);
+    }
+    return failed;
+}
@@ -0,0 +1,188 @@
+/* corpus.c
+ * packs replays into a corpus file and looks inside one.
+ *
+ *   gcc -O2 -o corpus tools/corpus.c
+ *
+ *   corpus pack <corpus> <replay|dir>...        add replays, making it if need be
+ *   corpus info [--scan] <corpus>               what is in it
+ *   corpus unpack <corpus> <entry> <replay>     write one back out on its own
+ *
+ * pack checks every replay unpacks the same before it is added. info prints
+ * how many replays and frames there are and the bytes they take, next to
+ * what they take as files of their own; with --scan it also reads every
+ * key of every replay straight from the mapping, as a farm would, and
+ * prints how fast that went. the layout is in corpus.h */
+
+#define PHLAPU_HOST
+#include "../game.h"
+
+#include <time.h>
+
+#include "replay.h"
+#include "corpus.h"
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* the bytes a replay takes as a file of its own */
+static unsigned long long replay_file_size(unsigned int frames, unsigned int flags) {
+    return sizeof(struct ReplayHeader) + 2ull * frames + (flags & REPLAY_FRAME_HASHES ? 4ull * frames : 0);
+}
+
+static int cmd_pack(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: corpus pack <corpus> <replay|dir>...\n");
+        return 2;
+    }
+    char** paths;
+    int count = replay_collect(argv + 3, argc - 3, &paths);
+    struct Replay* replays = calloc(count + 1, sizeof(struct Replay));
+    for (int i = 0; i < count; i++) {
+        if (replay_load(&replays[i], paths[i]) != 0) {
+            fprintf(stderr, "corpus: cannot load %s\n", paths[i]);
+            return 2;
+        }
+
+        /* pack it on its own first, and make sure it comes back */
+        struct CorpusRecord record;
+        corpus_record_of(&replays[i], &record);
+        unsigned char* packed = malloc(corpus_record_size(&record));
+        corpus_pack(&replays[i], packed);
+        struct CorpusReplay view;
+        corpus_view((const struct CorpusRecord*) packed, &view);
+        for (unsigned int f = 0; f < record.frames; f++) {
+            if (corpus_keys(&view, f) != replays[i].keys[f]) {
+                fprintf(stderr, "corpus: %s frame %u does not pack the same\n", paths[i], f);
+                return 1;
+            }
+        }
+        free(packed);
+    }
+    if (corpus_append(argv[2], replays, count) != 0) {
+        fprintf(stderr, "corpus: cannot add to %s\n", argv[2]);
+        return 1;
+    }
+
+    struct Corpus corpus;
+    if (corpus_open(&corpus, argv[2]) != 0) {
+        fprintf(stderr, "corpus: cannot map %s after adding to it\n", argv[2]);
+        return 1;
+    }
+    printf("added %d replays to %s, %u in all, %llu bytes\n", count, argv[2], corpus.count,
+            corpus.header->size);
+    corpus_close(&corpus);
+    for (int i = 0; i < count; i++) {
+        replay_free(&replays[i]);
+        free(paths[i]);
+    }
+    free(paths);
+    free(replays);
+    return 0;
+}
+
+static int cmd_info(int argc, char** argv) {
+    int scan = argc == 4 && strcmp(argv[2], "--scan") == 0;
+    if (argc != 3 + scan) {
+        fprintf(stderr, "usage: corpus info [--scan] <corpus>\n");
+        return 2;
+    }
+    const char* path = argv[2 + scan];
+    struct Corpus corpus;
+    if (corpus_open(&corpus, path) != 0) {
+        fprintf(stderr, "corpus: cannot map %s\n", path);
+        return 2;
+    }
+
+    unsigned long long frames = 0, as_files = 0, hashed = 0;
+    unsigned int masks = 0;
+    for (unsigned int i = 0; i < corpus.count; i++) {
+        struct CorpusReplay replay;
+        if (corpus_get(&corpus, i, &replay) != 0) {
+            fprintf(stderr, "corpus: replay %u runs past the end of %s\n", i, path);
+            return 1;
+        }
+        frames += replay.record->frames;
+        as_files += replay_file_size(replay.record->frames, replay.record->flags);
+        hashed += replay.hashes != NULL;
+        masks |= replay.record->mask;
+    }
+    unsigned long long size = corpus.header->size;
+    printf("%s: %u replays, %llu frames, %llu with frame hashes, buttons 0x%03x\n",
+            path, corpus.count, frames, hashed, masks);
+    printf("%llu bytes, %.1f a replay, %llu as files of their own (%.1f%%)",
+            size, corpus.count ? (double) size / corpus.count : 0, as_files,
+            as_files ? 100.0 * size / as_files : 0);
+    if (corpus.size > size) {
+        printf(", %llu bytes past the index ignored", (unsigned long long) corpus.size - size);
+    }
+    printf("\n");
+
+    if (scan) {
+        /* read every key in place, twice, timing the second when the pages
+         * are in */
+        unsigned int sink = 0;
+        double seconds = 0;
+        for (int pass = 0; pass < 2; pass++) {
+            double start = now_seconds();
+            for (unsigned int i = 0; i < corpus.count; i++) {
+                struct CorpusReplay replay;
+                if (corpus_get(&corpus, i, &replay) != 0) {
+                    continue;
+                }
+                for (unsigned int f = 0; f < replay.record->frames; f++) {
+                    sink += corpus_keys(&replay, f);
+                }
+            }
+            seconds = now_seconds() - start;
+        }
+        printf("scan: %.0f frames/s, %.1f MB/s of corpus (%u)\n", frames / seconds,
+                size / seconds / 1e6, sink & 1);
+    }
+    corpus_close(&corpus);
+    return 0;
+}
+
+static int cmd_unpack(int argc, char** argv) {
+    if (argc != 5) {
+        fprintf(stderr, "usage: corpus unpack <corpus> <entry> <replay>\n");
+        return 2;
+    }
+    struct Corpus corpus;
+    if (corpus_open(&corpus, argv[2]) != 0) {
+        fprintf(stderr, "corpus: cannot map %s\n", argv[2]);
+        return 2;
+    }
+    struct CorpusReplay packed;
+    if (corpus_get(&corpus, (unsigned int) atoi(argv[3]), &packed) != 0) {
+        fprintf(stderr, "corpus: %s has no replay %s\n", argv[2], argv[3]);
+        return 2;
+    }
+    struct Replay replay;
+    corpus_unpack(&packed, &replay);
+    if (replay_save(&replay, argv[4]) != 0) {
+        fprintf(stderr, "corpus: cannot write %s\n", argv[4]);
+        return 1;
+    }
+    replay_free(&replay);
+    corpus_close(&corpus);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "pack") == 0) {
+        return cmd_pack(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "info") == 0) {
+        return cmd_info(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "unpack") == 0) {
+        return cmd_unpack(argc, argv);
+    }
+    fprintf(stderr, "usage: corpus pack <corpus> <replay|dir>...\n"
+            "       corpus info [--scan] <corpus>\n"
+            "       corpus unpack <corpus> <entry> <replay>\n");
+    return 2;
+}
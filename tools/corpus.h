@@ -0,0 +1,320 @@
+/* corpus.h
+ * many replays packed into one file, read in place through mmap.
+ *
+ * a corpus file is a CorpusHeader, then the replays one after another, then
+ * an index of where each starts, 8 bytes an entry. a replay is a
+ * CorpusRecord holding its length and golden values, then its keys packed
+ * down to the buttons it ever presses: with the record's mask holding
+ * those buttons, each frame takes one bit for each, in the order of the
+ * mask's bits, frame after frame from the low bit of each 32 bit word up.
+ * a replay that only ever presses A takes a bit a frame. if the record has
+ * REPLAY_FRAME_HASHES set, one game_hash() a frame follows. everything is
+ * little endian and 4 byte aligned.
+ *
+ * adding replays writes them after everything already in the file, then a
+ * new index with the old entries and the new, and last of all the header
+ * pointing at it, so a corpus is never left without a good index. the old
+ * index stays behind as a few dead bytes. the header also keeps the size of
+ * the file as of that index, and anything past it, from an add that never
+ * finished, is ignored.
+ *
+ * reading maps the whole file and hands out CorpusReplay views into the
+ * mapping, so a scan of the corpus touches only the pages it reads and no
+ * replay is ever copied out. replay.h is for the replays each in a file of
+ * their own, and is needed for the flags and to add them */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CORPUS_MAGIC "PHCP"
+#define CORPUS_VERSION 1
+
+struct CorpusHeader {
+    char magic[4];
+    unsigned int version;
+
+    /* the number of replays and where their index starts */
+    unsigned int count;
+    unsigned int reserved;
+    unsigned long long index_offset;
+
+    /* the file's size when the index was written */
+    unsigned long long size;
+};
+
+struct CorpusRecord {
+    /* the number of frames, REPLAY_ flags and the buttons ever pressed */
+    unsigned int frames;
+    unsigned int flags;
+    unsigned int mask;
+
+    /* golden values, as in a ReplayHeader */
+    unsigned int end_frame;
+    unsigned int end_hash;
+    int end_total;
+    int end_alive;
+
+    unsigned int reserved;
+};
+
+/* a corpus mapped into memory */
+struct Corpus {
+    const unsigned char* base;
+    size_t size;
+    const struct CorpusHeader* header;
+    const unsigned long long* index;
+    unsigned int count;
+};
+
+/* one replay as it sits in the mapping */
+struct CorpusReplay {
+    const struct CorpusRecord* record;
+    const unsigned int* keys;
+    const unsigned int* hashes;
+
+    /* bits a frame, and the buttons they stand for, lowest first */
+    int bits;
+    unsigned short buttons[16];
+};
+
+/* words of packed keys for a replay, with one more so a frame that runs
+ * over the end of a word can always read the next */
+static inline unsigned int corpus_key_words(unsigned int frames, unsigned int mask) {
+    return (frames * __builtin_popcount(mask) + 31) / 32 + 1;
+}
+
+/* the bytes one replay takes in a corpus */
+static inline size_t corpus_record_size(const struct CorpusRecord* record) {
+    size_t size = sizeof(struct CorpusRecord) + 4 * corpus_key_words(record->frames, record->mask);
+    if (record->flags & REPLAY_FRAME_HASHES) {
+        size += 4 * (size_t) record->frames;
+    }
+    return size;
+}
+
+/* map a corpus, returns 0 on success */
+static inline int corpus_open(struct Corpus* corpus, const char* path) {
+    memset(corpus, 0, sizeof(*corpus));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(struct CorpusHeader)) {
+        close(fd);
+        return -1;
+    }
+    void* base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+    corpus->base = base;
+    corpus->size = st.st_size;
+    const struct CorpusHeader* h = base;
+    if (memcmp(h->magic, CORPUS_MAGIC, 4) != 0 || h->version != CORPUS_VERSION || h->size > (unsigned long long) st.st_size ||
+            h->index_offset + 8ull * h->count > h->size || h->index_offset % 8 != 0) {
+        munmap(base, st.st_size);
+        memset(corpus, 0, sizeof(*corpus));
+        return -1;
+    }
+    corpus->header = h;
+    corpus->index = (const unsigned long long*) (corpus->base + h->index_offset);
+    corpus->count = h->count;
+
+    /* the scans go through it in order */
+    madvise(base, st.st_size, MADV_SEQUENTIAL);
+    return 0;
+}
+
+static inline void corpus_close(struct Corpus* corpus) {
+    if (corpus->base) {
+        munmap((void*) corpus->base, corpus->size);
+    }
+    memset(corpus, 0, sizeof(*corpus));
+}
+
+/* whether a file starts like a corpus, to tell one from a replay */
+static inline int corpus_sniff(const char* path) {
+    char magic[4] = {0};
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return 0;
+    }
+    int read = fread(magic, 1, 4, f) == 4;
+    fclose(f);
+    return read && memcmp(magic, CORPUS_MAGIC, 4) == 0;
+}
+
+/* point a view at a packed record wherever it is */
+static inline void corpus_view(const struct CorpusRecord* record, struct CorpusReplay* replay) {
+    replay->record = record;
+    replay->keys = (const unsigned int*) (record + 1);
+    replay->hashes = record->flags & REPLAY_FRAME_HASHES ?
+        replay->keys + corpus_key_words(record->frames, record->mask) : NULL;
+    replay->bits = 0;
+    for (int b = 0; b < 16; b++) {
+        if (record->mask & (1 << b)) {
+            replay->buttons[replay->bits++] = 1 << b;
+        }
+    }
+}
+
+/* point a view at one replay, returns 0 if it lies inside the file */
+static inline int corpus_get(const struct Corpus* corpus, unsigned int i, struct CorpusReplay* replay) {
+    if (i >= corpus->count) {
+        return -1;
+    }
+    unsigned long long at = corpus->index[i];
+    if (at % 4 != 0 || at + sizeof(struct CorpusRecord) > corpus->header->size) {
+        return -1;
+    }
+    const struct CorpusRecord* record = (const struct CorpusRecord*) (corpus->base + at);
+    if (at + corpus_record_size(record) > corpus->header->size) {
+        return -1;
+    }
+    corpus_view(record, replay);
+    return 0;
+}
+
+/* the buttons held on one frame */
+static inline unsigned short corpus_keys(const struct CorpusReplay* replay, unsigned int frame) {
+    if (replay->bits == 0) {
+        return 0;
+    }
+    unsigned int bit = frame * replay->bits;
+    const unsigned int* word = replay->keys + bit / 32;
+    unsigned long long packed = (word[0] | (unsigned long long) word[1] << 32) >> (bit % 32);
+    unsigned short keys = 0;
+    for (int b = 0; b < replay->bits; b++) {
+        if (packed & (1ull << b)) {
+            keys |= replay->buttons[b];
+        }
+    }
+    return keys;
+}
+
+/* the record a replay packs into */
+static inline void corpus_record_of(const struct Replay* replay, struct CorpusRecord* record) {
+    const struct ReplayHeader* h = &replay->header;
+    memset(record, 0, sizeof(*record));
+    record->frames = h->frames;
+    record->flags = h->flags & REPLAY_FRAME_HASHES;
+    for (unsigned int f = 0; f < h->frames; f++) {
+        record->mask |= replay->keys[f];
+    }
+    record->end_frame = h->end_frame;
+    record->end_hash = h->end_hash;
+    record->end_total = h->end_total;
+    record->end_alive = h->end_alive;
+}
+
+/* pack a replay into out, which must hold corpus_record_size() bytes for
+ * its record. returns the bytes written */
+static inline size_t corpus_pack(const struct Replay* replay, unsigned char* out) {
+    const struct ReplayHeader* h = &replay->header;
+    struct CorpusRecord record;
+    corpus_record_of(replay, &record);
+    size_t size = corpus_record_size(&record);
+    memset(out, 0, size);
+    memcpy(out, &record, sizeof(record));
+
+    unsigned int* keys = (unsigned int*) (out + sizeof(record));
+    unsigned int bit = 0;
+    for (unsigned int f = 0; f < h->frames; f++) {
+        for (int b = 0; b < 16; b++) {
+            if (!(record.mask & (1 << b))) {
+                continue;
+            }
+            if (replay->keys[f] & (1 << b)) {
+                keys[bit / 32] |= 1u << (bit % 32);
+            }
+            bit++;
+        }
+    }
+    if (record.flags & REPLAY_FRAME_HASHES) {
+        memcpy(keys + corpus_key_words(h->frames, record.mask), replay->hashes, 4 * (size_t) h->frames);
+    }
+    return size;
+}
+
+/* add replays to the end of a corpus, making it if there is none. returns
+ * 0 on success */
+static inline int corpus_append(const char* path, const struct Replay* replays, int count) {
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    struct CorpusHeader header;
+    unsigned long long* index = NULL;
+    ssize_t got = pread(fd, &header, sizeof(header), 0);
+    if (got == 0) {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CORPUS_MAGIC, 4);
+        header.version = CORPUS_VERSION;
+        header.index_offset = sizeof(header);
+        header.size = sizeof(header);
+        if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+            close(fd);
+            return -1;
+        }
+    } else if (got != sizeof(header) || memcmp(header.magic, CORPUS_MAGIC, 4) != 0 ||
+            header.version != CORPUS_VERSION) {
+        close(fd);
+        return -1;
+    }
+
+    /* the old index, to go at the front of the new one */
+    index = malloc(8 * ((size_t) header.count + count));
+    if (header.count && pread(fd, index, 8 * (size_t) header.count, header.index_offset) !=
+            (ssize_t) (8 * (size_t) header.count)) {
+        free(index);
+        close(fd);
+        return -1;
+    }
+
+    /* the new replays go after everything the header knows of */
+    unsigned long long at = header.size;
+    int ok = 1;
+    for (int i = 0; i < count && ok; i++) {
+        struct CorpusRecord record;
+        corpus_record_of(&replays[i], &record);
+        unsigned char* packed = malloc(corpus_record_size(&record));
+        size_t size = corpus_pack(&replays[i], packed);
+        ok = pwrite(fd, packed, size, at) == (ssize_t) size;
+        free(packed);
+        index[header.count + i] = at;
+        at += size;
+    }
+
+    /* then the index, and once that is down, the header pointing at it */
+    at = (at + 7) & ~7ull;
+    size_t index_bytes = 8 * ((size_t) header.count + count);
+    ok = ok && pwrite(fd, index, index_bytes, at) == (ssize_t) index_bytes && fdatasync(fd) == 0;
+    if (ok) {
+        header.count += count;
+        header.index_offset = at;
+        header.size = at + index_bytes;
+        ok = pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+    }
+    free(index);
+    return (close(fd) == 0 && ok) ? 0 : -1;
+}
+
+/* copy a replay back out of a corpus into a replay of its own */
+static inline void corpus_unpack(const struct CorpusReplay* packed, struct Replay* replay) {
+    const struct CorpusRecord* r = packed->record;
+    replay_new(replay, r->frames, r->flags & REPLAY_FRAME_HASHES);
+    replay->header.end_frame = r->end_frame;
+    replay->header.end_hash = r->end_hash;
+    replay->header.end_total = r->end_total;
+    replay->header.end_alive = r->end_alive;
+    for (unsigned int f = 0; f < r->frames; f++) {
+        replay->keys[f] = corpus_keys(packed, f);
+        if (packed->hashes) {
+            replay->hashes[f] = packed->hashes[f];
+        }
+    }
+}
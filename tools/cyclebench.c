@@ -0,0 +1,211 @@
+/* cyclebench.c
+ * holds the ROM's cycle counts to a baseline, as the GBA itself pays them
+ * with its waitstates, rather than as the host's timings guess at them.
+ *
+ *   gcc -O2 -o cyclebench tools/cyclebench.c
+ *
+ *   cyclebench embed <replay> > benchreplay.h        the keys the ROM plays
+ *   cyclebench bless [log] > baseline                keep a run's counts
+ *   cyclebench check [-t percent] <baseline> [log]   compare a run with them
+ *
+ * the ROM built with PHLAPU_BENCH defined plays the replay in
+ * benchreplay.h instead of reading the keypad. when the replay runs out, or
+ * the dragon dies, it logs every profiler zone a last time through the mGBA
+ * debug registers, then logs "bench done" and stops. run it in mGBA with the
+ * debug log going to standard output and pipe that in, or save it and give
+ * its path; the log is read up to the "bench done" line, so the pipe closing
+ * on the emulator is what stops it.
+ *
+ * check wants every zone in profile.h in the log, and fails if a zone's
+ * cycles a call or a frame went up by more than the given percentage (5 by
+ * default, with 16 cycles either way let through for the smallest zones).
+ * the replay is the same each run, so the counts only change when the code
+ * does */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../profile.h"
+
+#include "replay.h"
+
+/* what the log said about one zone */
+struct ZoneCounts {
+    unsigned int last, worst, avg, calls, per_call;
+    int seen;
+};
+
+/* the counts that may not go up, and the cycles let through either way */
+#define CHECK_SLACK 16
+
+/* read a log up to the bench done line, keeping the last line for each
+ * zone. returns whether the line was there */
+static int read_log(FILE* f, struct ZoneCounts* zones) {
+    memset(zones, 0, sizeof(struct ZoneCounts) * PROFILE_COUNT);
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        if (strstr(line, BENCH_DONE)) {
+            return 1;
+        }
+
+        /* the zone name runs back from ": last" to the emulator's own
+         * prefix, which ends in a colon too */
+        char* counts = strstr(line, ": last ");
+        if (!counts) {
+            continue;
+        }
+        char* name = counts;
+        while (name > line && name[-1] != ':') {
+            name--;
+        }
+        while (*name == ' ') {
+            name++;
+        }
+        *counts = '\0';
+
+        for (int i = 0; i < PROFILE_COUNT; i++) {
+            if (strcmp(name, profile_zones[i].name) != 0) {
+                continue;
+            }
+            struct ZoneCounts* z = &zones[i];
+            if (sscanf(counts + 2, "last %u worst %u avg %u calls %u per call %u",
+                        &z->last, &z->worst, &z->avg, &z->calls, &z->per_call) == 5) {
+                z->seen = 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* open a log by path, or standard input for none or - */
+static FILE* open_log(const char* path) {
+    if (!path || strcmp(path, "-") == 0) {
+        return stdin;
+    }
+    return fopen(path, "r");
+}
+
+/* read a whole run's log, saying what is wrong with it if it is not one */
+static int load_run(const char* path, struct ZoneCounts* zones) {
+    FILE* f = open_log(path);
+    if (!f) {
+        fprintf(stderr, "cyclebench: cannot read %s\n", path);
+        return -1;
+    }
+    int done = read_log(f, zones);
+    if (f != stdin) {
+        fclose(f);
+    }
+    if (!done) {
+        fprintf(stderr, "cyclebench: %s ends before the bench was done\n", path ? path : "the log");
+        return -1;
+    }
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        if (!zones[i].seen) {
+            fprintf(stderr, "cyclebench: %s has no counts for %s\n", path ? path : "the log",
+                    profile_zones[i].name);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int cmd_embed(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: cyclebench embed <replay>\n");
+        return 2;
+    }
+    struct Replay replay;
+    if (replay_load(&replay, argv[2]) != 0 || replay.header.frames == 0) {
+        fprintf(stderr, "cyclebench: cannot load replay %s\n", argv[2]);
+        return 2;
+    }
+    unsigned int frames = replay.header.frames;
+    printf("/* created by cyclebench from %s */\n\n", argv[2]);
+    printf("#define bench_frames %u\n\n", frames);
+    printf("const unsigned short bench_keys [] = {");
+    for (unsigned int i = 0; i < frames; i++) {
+        printf("%s0x%04x%s", i % 9 == 0 ? "\n    " : "", replay.keys[i], i + 1 < frames ? ", " : "");
+    }
+    printf("\n};\n");
+    replay_free(&replay);
+    return 0;
+}
+
+static int cmd_bless(int argc, char** argv) {
+    if (argc > 3) {
+        fprintf(stderr, "usage: cyclebench bless [log]\n");
+        return 2;
+    }
+    struct ZoneCounts zones[PROFILE_COUNT];
+    if (load_run(argc == 3 ? argv[2] : NULL, zones) != 0) {
+        return 1;
+    }
+
+    /* the baseline is written as a log of its own */
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        const struct ZoneCounts* z = &zones[i];
+        printf("%s: last %u worst %u avg %u calls %u per call %u\n", profile_zones[i].name,
+                z->last, z->worst, z->avg, z->calls, z->per_call);
+    }
+    printf("%s\n", BENCH_DONE);
+    return 0;
+}
+
+/* whether a count went up past the threshold */
+static int regressed(unsigned int before, unsigned int now, double percent) {
+    return now > before + CHECK_SLACK && now > before * (1 + percent / 100);
+}
+
+static int cmd_check(int argc, char** argv) {
+    double percent = 5;
+    int first = 2;
+    if (first + 1 < argc && strcmp(argv[first], "-t") == 0) {
+        percent = atof(argv[first + 1]);
+        first += 2;
+    }
+    if (first >= argc || first + 2 < argc || percent < 0) {
+        fprintf(stderr, "usage: cyclebench check [-t percent] <baseline> [log]\n");
+        return 2;
+    }
+    struct ZoneCounts baseline[PROFILE_COUNT], run[PROFILE_COUNT];
+    if (load_run(argv[first], baseline) != 0 ||
+            load_run(first + 1 < argc ? argv[first + 1] : NULL, run) != 0) {
+        return 1;
+    }
+
+    int regressions = 0;
+    printf("zone                 calls   a call   was  change   a frame   was  change\n");
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        const struct ZoneCounts* b = &baseline[i];
+        const struct ZoneCounts* r = &run[i];
+        int bad = regressed(b->per_call, r->per_call, percent) || regressed(b->avg, r->avg, percent);
+        regressions += bad;
+        printf("%-18s %7u %8u %5u %6.1f%% %9u %5u %6.1f%%%s\n", profile_zones[i].name, r->calls,
+                r->per_call, b->per_call, b->per_call ? 100.0 * r->per_call / b->per_call - 100 : 0,
+                r->avg, b->avg, b->avg ? 100.0 * r->avg / b->avg - 100 : 0, bad ? "  <- slower" : "");
+        if (r->calls != b->calls) {
+            printf("%-18s called %u times, was %u: is the replay the same?\n", "", r->calls, b->calls);
+        }
+    }
+    if (regressions) {
+        fprintf(stderr, "cyclebench: %d zones are more than %.1f%% slower\n", regressions, percent);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "embed") == 0) {
+        return cmd_embed(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "bless") == 0) {
+        return cmd_bless(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return cmd_check(argc, argv);
+    }
+    fprintf(stderr, "usage: cyclebench embed <replay> > benchreplay.h\n"
+            "       cyclebench bless [log] > baseline\n"
+            "       cyclebench check [-t percent] <baseline> [log]\n");
+    return 2;
+}
@@ -0,0 +1,412 @@
+/* frontend.c
+ * runs the game natively on Linux, with the game loop and the drawing on
+ * threads of their own.
+ *
+ *   gcc -O2 -pthread -o frontend tools/frontend.c
+ *
+ *   frontend [-d hz] [-t seconds] [-u] [-r replay] [-p last.ppm] [-s stats]
+ *
+ * the simulation thread steps the game at the GBA's 59.73 Hz on a fixed
+ * clock, streaming the level the way the ROM does, with the autopilot
+ * flying or the keys of a replay, and starting again when the dragon dies.
+ * after every step it puts a snapshot of what is on screen, the scroll,
+ * the sprite table and the ground ring, into a single producer single
+ * consumer queue, or counts it dropped if the queue is full; it never waits
+ * on the drawing.
+ *
+ * the render thread draws at its own rate (-d, 60 Hz by default) with the
+ * host picture unit in ppu.h. it keeps the last two snapshots and draws a
+ * step behind the simulation, so the scroll and the sprites can be placed
+ * between the two at the time the frame goes up.
+ *
+ * -u takes both clocks off for throughput: the simulation runs flat out and
+ * waits for room in the queue, and every snapshot is drawn once as it is.
+ *
+ * it runs for the given time (3 seconds by default), then prints how deep
+ * the queue was when the render thread came to it, how old the newest
+ * snapshot was when its frame went up, and both threads' rates. -s writes
+ * the same as name value lines, -p writes the last frame drawn. it exits
+ * non-zero if a snapshot came out of the queue out of order, or in -u if
+ * one went missing */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../autopilot.h"
+#include "../level.h"
+#include "../level1.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "ppu.h"
+#include "replay.h"
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* sleep until a time on the same clock */
+static void sleep_until(double when) {
+    struct timespec ts;
+    ts.tv_sec = (time_t) when;
+    ts.tv_nsec = (long) ((when - ts.tv_sec) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+    }
+}
+
+/* the GBA's frame, 280896 cycles at 2^24 Hz */
+#define SIM_PERIOD (280896.0 / 16777216.0)
+
+/* what the render thread needs of one step */
+struct Snapshot {
+    unsigned int frame;
+
+    /* when the step was due on the simulation's clock, and when it was put
+     * in the queue */
+    double due;
+    double published;
+
+    int xscroll;
+    struct Sprite sprites[NUM_SPRITES];
+    unsigned short ground[LEVEL_ROWS * LEVEL_RING];
+};
+
+/* the queue between the threads. the simulation only writes head and the
+ * render thread only writes tail, each on a cache line of its own */
+#define QUEUE_SLOTS 8
+
+struct SnapshotQueue {
+    struct Snapshot slots[QUEUE_SLOTS];
+    _Alignas(64) atomic_uint head;
+    _Alignas(64) atomic_uint tail;
+};
+
+/* the slot to fill next, or NULL if the queue is full */
+static struct Snapshot* queue_slot(struct SnapshotQueue* q) {
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    return head - tail == QUEUE_SLOTS ? NULL : &q->slots[head % QUEUE_SLOTS];
+}
+
+/* hand the filled slot over */
+static void queue_publish(struct SnapshotQueue* q) {
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+}
+
+/* take the oldest snapshot into out, returns 0 if there was none */
+static int queue_take(struct SnapshotQueue* q, struct Snapshot* out) {
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (head == tail) {
+        return 0;
+    }
+    memcpy(out, &q->slots[tail % QUEUE_SLOTS], sizeof(*out));
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+static unsigned int queue_depth(struct SnapshotQueue* q) {
+    return atomic_load_explicit(&q->head, memory_order_acquire) -
+        atomic_load_explicit(&q->tail, memory_order_relaxed);
+}
+
+static struct SnapshotQueue queue;
+static atomic_int running = 1;
+static atomic_int sim_done = 0;
+
+/* settings */
+static double display_hz = 60;
+static int uncapped = 0;
+static struct Replay replay;
+static int replaying = 0;
+
+/* what the simulation thread counted */
+static struct {
+    unsigned int frames, published, dropped, late, deaths;
+} sim;
+
+static void* simulate(void* data) {
+    static const struct Level level = {level1_data, level1_index, level1_width};
+    static unsigned short screen[2 * 32 * 32];
+    static struct LevelStreamer streamer;
+    static struct Game game;
+    static struct Autopilot autopilot;
+    (void) data;
+
+    double start = now_seconds();
+    unsigned int played = 0;
+    int restart = 1;
+    while (atomic_load(&running)) {
+        if (restart) {
+            game_init(&game, &ground_tilemap);
+            level_streamer_init(&streamer, &level, screen, &game);
+            autopilot_init(&autopilot, 0);
+            restart = 0;
+        }
+
+        /* step the game as the ROM's game and level tasks do */
+        unsigned short keys;
+        if (replaying) {
+            keys = replay.keys[played++ % replay.header.frames];
+        } else {
+            keys = autopilot_decide(&autopilot, &game) ? BUTTON_A : 0;
+        }
+        game_step(&game, keys);
+        if (level_streamer_update(&streamer, &game)) {
+            autopilot.steer_map = 0;
+        }
+        level_streamer_commit(&streamer, screen);
+        if (!game.dragon.alive) {
+            sim.deaths++;
+            restart = 1;
+        }
+
+        /* hand the frame over, or wait for room if nothing is dropped */
+        double due = start + sim.frames * SIM_PERIOD;
+        struct Snapshot* s = queue_slot(&queue);
+        while (!s && uncapped && atomic_load(&running)) {
+            sched_yield();
+            s = queue_slot(&queue);
+        }
+        if (!s && uncapped) {
+            break;
+        }
+        if (s) {
+            s->frame = sim.frames;
+            s->due = due;
+            s->xscroll = game.xscroll;
+            memcpy(s->sprites, game.oam.sprites, sizeof(s->sprites));
+            memcpy(s->ground, streamer.ring, sizeof(s->ground));
+            s->published = now_seconds();
+            queue_publish(&queue);
+            sim.published++;
+        } else {
+            sim.dropped++;
+        }
+        sim.frames++;
+
+        /* wait for the next step, or if this one ran over, start the clock
+         * again from now rather than rushing to catch up */
+        if (!uncapped) {
+            double next = start + sim.frames * SIM_PERIOD;
+            double now = now_seconds();
+            if (now > next + SIM_PERIOD) {
+                sim.late++;
+                start = now - sim.frames * SIM_PERIOD;
+            } else {
+                sleep_until(next);
+            }
+        }
+    }
+    atomic_store(&sim_done, 1);
+    return NULL;
+}
+
+/* what the render thread counted */
+static struct {
+    unsigned int presented, interpolated, snaps_taken, out_of_order, missing;
+    unsigned long long depth_total;
+    unsigned int depth_max;
+    double age_total, age_max;
+    double draw_seconds;
+} render;
+
+static struct PpuFrame frame;
+
+/* where a sprite is between two frames, a fraction t of the way. sprites
+ * that jumped, like ones parked off the screen, are left where they are */
+static struct Sprite sprite_between(const struct Sprite* a, const struct Sprite* b, double t) {
+    struct Sprite out = *b;
+    int ax = a->attribute1 & 0x1ff, bx = b->attribute1 & 0x1ff;
+    int ay = a->attribute0 & 0xff, by = b->attribute0 & 0xff;
+    if (abs(bx - ax) < 32 && abs(by - ay) < 32) {
+        int x = (int) (ax + (bx - ax) * t + 0.5);
+        int y = (int) (ay + (by - ay) * t + 0.5);
+        out.attribute1 = (b->attribute1 & ~0x1ff) | (x & 0x1ff);
+        out.attribute0 = (b->attribute0 & ~0xff) | (y & 0xff);
+    }
+    return out;
+}
+
+static void* present(void* data) {
+    static struct Ppu ppu;
+    static struct Snapshot prev, cur, next;
+    static struct Sprite sprites[NUM_SPRITES];
+    (void) data;
+    ppu_init(&ppu);
+
+    int have = 0;
+    double start = now_seconds();
+    double tick = start;
+    for (;;) {
+        /* the queue as the render thread finds it */
+        unsigned int depth = queue_depth(&queue);
+
+        /* take everything waiting, keeping the newest two. uncapped draws
+         * every one, so it takes one at a time */
+        int took = 0;
+        while ((!uncapped || !took) && queue_take(&queue, &next)) {
+            if (have && next.frame <= cur.frame) {
+                render.out_of_order++;
+            }
+            if (uncapped && have && next.frame != cur.frame + 1) {
+                render.missing++;
+            }
+            prev = have ? cur : next;
+            cur = next;
+            have = 1;
+            took++;
+            render.snaps_taken++;
+        }
+        if (!took && atomic_load(&sim_done)) {
+            break;
+        }
+        if (!have) {
+            sched_yield();
+            continue;
+        }
+
+        /* uncapped draws each snapshot once, so with nothing new it waits
+         * rather than drawing the last one again */
+        if (uncapped && !took) {
+            sched_yield();
+            continue;
+        }
+        render.depth_total += depth;
+        if (depth > render.depth_max) {
+            render.depth_max = depth;
+        }
+
+        /* draw a step behind, between the last two snapshots */
+        double now = now_seconds();
+        double t = 1;
+        if (!uncapped && cur.due > prev.due) {
+            t = (now - SIM_PERIOD - prev.due) / (cur.due - prev.due);
+            t = t < 0 ? 0 : t > 1 ? 1 : t;
+        }
+        double xscroll = prev.xscroll + (cur.xscroll - prev.xscroll) * t;
+        for (int i = 0; i < NUM_SPRITES; i++) {
+            sprites[i] = sprite_between(&prev.sprites[i], &cur.sprites[i], t);
+        }
+        if (t > 0 && t < 1) {
+            render.interpolated++;
+        }
+        struct PpuView view = {cur.ground, LEVEL_RING, LEVEL_ROWS, (int) (xscroll + 0.5),
+            (int) (xscroll * 1.2), sprites};
+        double drawn = now_seconds();
+        ppu_draw(&ppu, &frame, &view);
+        render.draw_seconds += now_seconds() - drawn;
+
+        double age = now_seconds() - cur.published;
+        render.age_total += age;
+        if (age > render.age_max) {
+            render.age_max = age;
+        }
+        render.presented++;
+
+        if (!uncapped) {
+            if (!atomic_load(&running) && queue_depth(&queue) == 0) {
+                break;
+            }
+            tick += 1 / display_hz;
+            if (tick < now_seconds()) {
+                tick = now_seconds();
+            }
+            sleep_until(tick);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    double seconds = 3;
+    const char* last = NULL;
+    const char* stats = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-u") == 0) {
+            uncapped = 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "-d") == 0) {
+            display_hz = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            seconds = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            if (replay_load(&replay, argv[++i]) != 0 || replay.header.frames == 0) {
+                fprintf(stderr, "frontend: cannot load replay %s\n", argv[i]);
+                return 2;
+            }
+            replaying = 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "-p") == 0) {
+            last = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            stats = argv[++i];
+        } else {
+            seconds = -1;
+            break;
+        }
+    }
+    if (seconds <= 0 || display_hz <= 0) {
+        fprintf(stderr, "usage: frontend [-d hz] [-t seconds] [-u] [-r replay] [-p last.ppm] [-s stats]\n");
+        return 2;
+    }
+
+    pthread_t sim_thread, render_thread;
+    double start = now_seconds();
+    pthread_create(&sim_thread, NULL, simulate, NULL);
+    pthread_create(&render_thread, NULL, present, NULL);
+    sleep_until(start + seconds);
+    atomic_store(&running, 0);
+    pthread_join(sim_thread, NULL);
+    pthread_join(render_thread, NULL);
+    double took = now_seconds() - start;
+
+    unsigned int looks = render.presented ? render.presented : 1;
+    double sim_hz = sim.frames / took, render_hz = render.presented / took;
+    printf("%s, %.2f seconds\n", uncapped ? "uncapped" : "fixed step", took);
+    printf("simulation  %8u frames  %8.2f Hz  %u published, %u dropped, %u late, %u deaths\n",
+            sim.frames, sim_hz, sim.published, sim.dropped, sim.late, sim.deaths);
+    printf("render      %8u frames  %8.2f Hz  %u between snapshots, %.1f us a draw\n",
+            render.presented, render_hz, render.interpolated, 1e6 * render.draw_seconds / looks);
+    printf("queue       %.2f deep on average, %u at most, of %d\n",
+            (double) render.depth_total / looks, render.depth_max, QUEUE_SLOTS);
+    printf("frame age   %.2f ms on average, %.2f ms at most\n",
+            1e3 * render.age_total / looks, 1e3 * render.age_max);
+
+    if (stats) {
+        FILE* f = fopen(stats, "w");
+        if (!f) {
+            fprintf(stderr, "frontend: cannot write %s\n", stats);
+            return 2;
+        }
+        fprintf(f, "uncapped %d\nseconds %.3f\n", uncapped, took);
+        fprintf(f, "sim_frames %u\nsim_hz %.3f\nsim_published %u\nsim_dropped %u\nsim_late %u\n"
+                "sim_deaths %u\n", sim.frames, sim_hz, sim.published, sim.dropped, sim.late,
+                sim.deaths);
+        fprintf(f, "render_frames %u\nrender_hz %.3f\nrender_interpolated %u\nrender_draw_us %.2f\n",
+                render.presented, render_hz, render.interpolated, 1e6 * render.draw_seconds / looks);
+        fprintf(f, "queue_depth_avg %.3f\nqueue_depth_max %u\nqueue_slots %d\n",
+                (double) render.depth_total / looks, render.depth_max, QUEUE_SLOTS);
+        fprintf(f, "frame_age_avg_ms %.3f\nframe_age_max_ms %.3f\n",
+                1e3 * render.age_total / looks, 1e3 * render.age_max);
+        fclose(f);
+    }
+    if (last && ppu_write_ppm(&frame, last) != 0) {
+        fprintf(stderr, "frontend: cannot write %s\n", last);
+        return 2;
+    }
+
+    if (render.out_of_order || render.missing) {
+        fprintf(stderr, "frontend: %u snapshots came out of order and %u went missing\n",
+                render.out_of_order, render.missing);
+        return 1;
+    }
+    if (uncapped && (render.snaps_taken != sim.published || render.presented != sim.published)) {
+        fprintf(stderr, "frontend: %u snapshots published but %u taken and %u drawn\n", sim.published,
+                render.snaps_taken, render.presented);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,742 @@
+/* fuzz.c
+ * throws odd input at game_step() and checks the game stays sane.
+ *
+ *   gcc -O2 -fsanitize-coverage=trace-pc -o fuzz tools/fuzz.c
+ *
+ *   fuzz [-t seconds] [-n iterations] [-m frames] [-s seed] [-c dir] [seed replays|dirs|corpora]...
+ *   fuzz run [-m frames] <input>... [-- seed replays|dirs|corpora...]
+ *
+ * an input is a start, a ground and keys. its first byte picks a snapshot
+ * of the game to start from, out of states taken every 16 frames of the
+ * seed replays, or of an autopilot run if there are none. if the low bit of
+ * the second byte is set, the game gets a ground map of its own: the next
+ * three bytes give its width (up to 64), height (up to 32) and the length
+ * of a pattern of tile bytes, which follows and is laid over the map again
+ * and again, each byte a tile of 0 to 63 with the flip bits from its top
+ * two. every byte after that is the keys of a frame, for up to -m frames
+ * (16 by default).
+ *
+ * each iteration puts the game back from its snapshot with game_restore()
+ * rather than setting it up again, fixes the ground and steps it, and after
+ * every step checks that:
+ *
+ *   - every tile read by tile_lookup() and the collision is in the map
+ *   - a step a live dragon takes moves the frame on one, and the scroll
+ *     with it, and a step once he is down changes nothing at all
+ *   - the dragon, the score and the sprite table are in range
+ *   - the dragon's sprite shows the frame of him his collision tests
+ *   - the entities that came on, went or changed column are in range and
+ *     linked into the list of their column, and on the first and last step
+ *     every entity is, once each
+ *
+ * and now and then, and whenever an input finds something new, it runs
+ * the input again and checks the game ends up with the same hash.
+ *
+ * built with -fsanitize-coverage=trace-pc, gcc calls back on every basic
+ * block, and the edges between blocks taken while the game steps, counted
+ * into buckets by how often, are the coverage. an input that reaches an
+ * edge or a bucket no input has before is kept, and new inputs are
+ * mutations of kept ones: bits flipped, bytes set, runs of bytes put in,
+ * taken out, repeated or taken from another input. built without it, the
+ * mutations still run but only the seeds are ever kept.
+ *
+ * the calls are what the coverage costs. put through the same kept inputs,
+ * a build without it runs about two and a half times as many a second
+ * (about 53000 against 21000 on the machine this was measured on), nearly
+ * all of it the call itself and what the code around it has to save, as
+ * an empty callback is not much quicker. gcc has nothing like clang's
+ * inline-8bit-counters to count blocks without a call, so all that can be
+ * done is count only while the game steps and leave the fuzzer's own code
+ * out, which it does. the rest of the gap to an unguided run, which goes
+ * some ten times as fast, is the inputs: the ones a guided run keeps are
+ * longer and bring maps of their own.
+ *
+ * an input that breaks a check is written to the -c directory (. by
+ * default) as fuzz-failure-N and the run exits 1, printing the run command
+ * that puts it through again from the same snapshots. it prints the
+ * iterations a second, the inputs kept and the edges seen every second, and
+ * stops after -t seconds (10 by default) or -n iterations. run puts each
+ * input given through the checks once, starting from snapshots of the seeds
+ * after the -- the way the fuzzing did, and says what it found */
+
+#define PHLAPU_HOST
+
+/* a tile read outside its map, found by the game's own lookups */
+static int bad_read;
+static int bad_index, bad_count;
+#define GAME_TILE_READ(index, count) \
+    do { \
+        if ((unsigned int) (index) >= (unsigned int) (count) && !bad_read) { \
+            bad_read = 1; \
+            bad_index = (index); \
+            bad_count = (count); \
+        } \
+    } while (0)
+
+#include "../game.h"
+#include "../autopilot.h"
+
+#include <errno.h>
+#include <time.h>
+
+#include "replay.h"
+#include "corpus.h"
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* the fuzzer's own code that runs every iteration is left out of the
+ * instrumenting, so it costs no calls at all */
+#define UNTRACED __attribute__((no_sanitize_coverage))
+
+UNTRACED static unsigned int xorshift(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/* the edges between basic blocks, hashed into a map of hit counts. only
+ * counted while tracing, so the fuzzer's own branches stay out of it */
+#define EDGE_BITS 14
+#define EDGES (1 << EDGE_BITS)
+
+static unsigned char edges[EDGES];
+static unsigned int previous_block;
+static volatile int tracing;
+
+/* whether this build calls back at all, found by stepping once at start */
+static int covered;
+
+UNTRACED void __sanitizer_cov_trace_pc(void) {
+    if (!tracing) {
+        return;
+    }
+    unsigned int pc = (unsigned int) (unsigned long) __builtin_return_address(0);
+    unsigned int block = (pc * 2654435761u) >> (32 - EDGE_BITS);
+    edges[block ^ previous_block]++;
+    previous_block = block >> 1;
+}
+
+/* the bucket bit for a hit count: 1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128+ */
+UNTRACED static unsigned char bucket(unsigned char hits) {
+    if (hits <= 3) {
+        return hits == 0 ? 0 : 1 << (hits - 1);
+    }
+    if (hits < 8) {
+        return 8;
+    }
+    if (hits < 16) {
+        return 16;
+    }
+    if (hits < 32) {
+        return 32;
+    }
+    return hits < 128 ? 64 : 128;
+}
+
+/* every bucket bit any input has reached, edge by edge */
+static unsigned char reached[EDGES];
+
+/* fold the last run's edges into what has been reached, returns how many
+ * new bucket bits it found */
+UNTRACED static int new_coverage() {
+    int found = 0;
+    const unsigned long long* words = (const unsigned long long*) edges;
+    for (int w = 0; w < EDGES / 8; w++) {
+        if (!words[w]) {
+            continue;
+        }
+        for (int e = w * 8; e < w * 8 + 8; e++) {
+            unsigned char b = bucket(edges[e]);
+            if (b & ~reached[e]) {
+                reached[e] |= b;
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+static int edges_reached() {
+    int count = 0;
+    for (int e = 0; e < EDGES; e++) {
+        count += reached[e] != 0;
+    }
+    return count;
+}
+
+/* the snapshots an input can start from */
+#define SNAPSHOTS 256
+#define SNAPSHOT_EVERY 16
+
+static struct Game snapshots[SNAPSHOTS];
+static int snapshot_count;
+
+/* a ground map of an input's own */
+#define MAP_MAX_WIDTH 64
+#define MAP_MAX_HEIGHT 32
+
+static unsigned short map_tiles[MAP_MAX_WIDTH * MAP_MAX_HEIGHT];
+static struct TileColumn map_columns[MAP_MAX_WIDTH];
+static struct Tilemap map = {map_tiles, 1, 1, map_columns};
+
+/* the most frames of keys an input gets, and the biggest input. short
+ * inputs from many snapshots cover more for the time than long ones */
+static int max_frames = 16;
+#define INPUT_MAX 1024
+
+static struct Game game;
+
+/* what is wrong with the game, or NULL */
+static char failure[256];
+
+UNTRACED static const char* check_state(const struct Game* g) {
+    const struct Dragon* d = &g->dragon;
+    const struct Score* s = &g->score;
+    const struct Entities* e = &g->entities;
+    if (g->version != GAME_STATE_VERSION || g->xscroll != g->frames + 1) {
+        return "the version or the scroll has gone wrong";
+    }
+    if (d->alive != 0 && d->alive != 1) {
+        return "the dragon is neither alive nor dead";
+    }
+    if (d->frame < 0 || d->frame > 16 || d->counter < 0 || d->counter >= d->animation_delay) {
+        return "the dragon's animation is out of range";
+    }
+    if (d->sprite < 0 || d->sprite >= NUM_SPRITES || s->sprite < 0 || s->sprite >= NUM_SPRITES) {
+        return "a sprite index is out of the table";
+    }
+    if (d->alive && (g->oam.sprites[d->sprite].attribute2 & 0x3ff) != d->frame) {
+        return "the dragon's sprite is not the frame his collision tests";
+    }
+    if (!d->alive && d->falling) {
+        return "the dragon is down but still falling";
+    }
+    if (d->y <= -(1 << 30) || d->y >= 1 << 30 || d->yvel <= -(1 << 30) || d->yvel >= 1 << 30) {
+        return "the dragon's y is close to overflowing";
+    }
+    if (s->frame < 24 || s->frame > 45 || s->total < 0 || (s->lap != 0 && s->lap != s->total / 3 + 1)) {
+        return "the score is out of range";
+    }
+    if (g->oam.next_sprite_index < 0 || g->oam.next_sprite_index > NUM_SPRITES) {
+        return "the sprite table's next index is out of range";
+    }
+    if (e->count < 0 || e->count > ENTITY_CAPACITY || e->shown < 0 || e->shown > ENTITY_CAPACITY) {
+        return "the entity count is out of range";
+    }
+    return NULL;
+}
+
+/* one entity, and its links to the entities either side of it */
+UNTRACED static const char* check_entity(const struct Entities* e, int i) {
+    if (e->kind[i] >= ENTITY_KINDS || e->frame[i] >= entity_kinds[e->kind[i]].frames) {
+        return "an entity's kind or frame is out of range";
+    }
+    if (e->cell[i] != entity_cell(e->x[i])) {
+        return "an entity is in the wrong column";
+    }
+    int before = e->prev[i], after = e->next[i];
+    if (before < 0 ? e->head[e->cell[i]] != i :
+            before >= e->count || e->next[before] != i || e->cell[before] != e->cell[i]) {
+        return "the entity columns' lists are broken";
+    }
+    if (after >= 0 && (after >= e->count || e->prev[after] != i || e->cell[after] != e->cell[i])) {
+        return "the entity columns' lists are broken";
+    }
+    return NULL;
+}
+
+/* the columns as they were at the last check */
+static signed char checked_cell[ENTITY_CAPACITY];
+static int checked_count;
+
+/* check the entities. between whole checks, and unless one came on or went,
+ * only the ones that changed column since the last check are looked at, as
+ * only those had their links touched */
+UNTRACED static const char* check_entities(const struct Entities* e, int whole) {
+    int all = whole || e->count != checked_count;
+    for (int i = 0; i < e->count; i++) {
+        if (all || e->cell[i] != checked_cell[i]) {
+            const char* wrong = check_entity(e, i);
+            if (wrong) {
+                return wrong;
+            }
+            checked_cell[i] = e->cell[i];
+        }
+    }
+    checked_count = e->count;
+    if (!whole) {
+        return NULL;
+    }
+
+    /* every live entity once, in the list of its own column */
+    int listed = 0;
+    for (int c = 0; c < ENTITY_CELLS; c++) {
+        int previous = -1;
+        for (int i = e->head[c]; i >= 0; i = e->next[i]) {
+            if (i >= e->count || e->cell[i] != c || e->prev[i] != previous || ++listed > e->count) {
+                return "the entity columns' lists are broken";
+            }
+            previous = i;
+        }
+    }
+    if (listed != e->count) {
+        return "an entity is missing from the columns";
+    }
+    return NULL;
+}
+
+/* run an input through the checks, filling in failure. returns 0 if it
+ * passed, with the game's hash at the end in hash */
+UNTRACED static int run_input(const unsigned char* data, int size, unsigned int* hash) {
+    int pos = 0;
+    int start = size > pos ? data[pos++] % snapshot_count : 0;
+    int flags = size > pos ? data[pos++] : 0;
+    game_restore(&game, &snapshots[start]);
+
+    if (flags & 1) {
+        int width = 1 + (size > pos ? data[pos++] : 0) % MAP_MAX_WIDTH;
+        int height = 1 + (size > pos ? data[pos++] : 0) % MAP_MAX_HEIGHT;
+        int period = 1 + (size > pos ? data[pos++] : 0) % 64;
+        if (period > size - pos) {
+            period = size - pos;
+        }
+        for (int i = 0; i < width * height; i++) {
+            unsigned char b = period > 0 ? data[pos + i % period] : 0;
+            map_tiles[i] = (b & 0x3f) | ((b >> 6) << 10);
+        }
+        pos += period > 0 ? period : 0;
+        map.width = width;
+        map.height = height;
+        tilemap_columns(&map);
+        game.ground = &map;
+    }
+
+    int frames = size - pos < max_frames ? size - pos : max_frames;
+    failure[0] = 0;
+    bad_read = 0;
+    for (int f = 0; f < frames; f++) {
+        int before = game.frames;
+        tracing = 1;
+        int alive = game_step(&game, data[pos + f]);
+        tracing = 0;
+        if (alive != game.dragon.alive || game.frames != before + 1) {
+            snprintf(failure, sizeof(failure), "frame %d: a live step moved the frame from %d to %d", f,
+                    before, game.frames);
+            break;
+        }
+        const char* wrong = check_state(&game);
+        if (!wrong) {
+            wrong = check_entities(&game.entities, f == 0 || f == frames - 1 || !alive);
+        }
+        if (wrong) {
+            snprintf(failure, sizeof(failure), "frame %d: %s", f, wrong);
+            break;
+        }
+        if (bad_read) {
+            break;
+        }
+
+        /* once down, stepping again must not change a thing */
+        if (!alive) {
+            unsigned int down = game_hash(&game);
+            if (game_step(&game, 0xffff) || game_hash(&game) != down) {
+                snprintf(failure, sizeof(failure), "frame %d: stepping after the dragon went down changed "
+                        "the game", f);
+            }
+            break;
+        }
+    }
+    if (bad_read && !failure[0]) {
+        snprintf(failure, sizeof(failure), "tile %d read from a %dx%d map of %d tiles", bad_index,
+                game.ground->width, game.ground->height, bad_count);
+    }
+    *hash = game_hash(&game);
+    return failure[0] != 0;
+}
+
+/* run an input twice and check it comes out the same */
+UNTRACED static int run_twice(const unsigned char* data, int size) {
+    unsigned int first, second;
+    if (run_input(data, size, &first)) {
+        return 1;
+    }
+    if (covered) {
+        memset(edges, 0, sizeof(edges));
+    }
+    if (run_input(data, size, &second)) {
+        return 1;
+    }
+    if (first != second) {
+        snprintf(failure, sizeof(failure), "the same input hashed %08x then %08x", first, second);
+        return 1;
+    }
+    return 0;
+}
+
+/* the kept inputs */
+struct Input {
+    unsigned char* data;
+    int size;
+};
+
+static struct Input* kept;
+static int kept_count, kept_capacity;
+
+UNTRACED static void keep(const unsigned char* data, int size) {
+    if (kept_count == kept_capacity) {
+        kept_capacity = kept_capacity ? 2 * kept_capacity : 256;
+        kept = realloc(kept, sizeof(struct Input) * kept_capacity);
+    }
+    kept[kept_count].data = malloc(size ? size : 1);
+    memcpy(kept[kept_count].data, data, size);
+    kept[kept_count].size = size;
+    kept_count++;
+}
+
+/* change an input in one to four ways, returns its new size */
+UNTRACED static int mutate(unsigned char* data, int size, unsigned int* rng) {
+    int changes = 1 + xorshift(rng) % 4;
+    for (int c = 0; c < changes; c++) {
+        int at = size ? xorshift(rng) % size : 0;
+        int length = 1 + xorshift(rng) % 32;
+        switch (xorshift(rng) % 8) {
+        case 0:
+            if (size) {
+                data[at] ^= 1 << (xorshift(rng) % 8);
+            }
+            break;
+        case 1:
+            if (size) {
+                data[at] = (unsigned char) xorshift(rng);
+            }
+            break;
+        case 2:
+            if (size) {
+                data[at] += (unsigned char) (xorshift(rng) % 17) - 8;
+            }
+            break;
+        case 3:
+            /* a run of one key, held or let go for a while */
+            for (int i = at; i < size && i < at + length; i++) {
+                data[i] = c & 1 ? BUTTON_A : 0;
+            }
+            break;
+        case 4:
+            /* put in random bytes */
+            if (size + length <= INPUT_MAX) {
+                memmove(data + at + length, data + at, size - at);
+                for (int i = 0; i < length; i++) {
+                    data[at + i] = (unsigned char) xorshift(rng);
+                }
+                size += length;
+            }
+            break;
+        case 5:
+            /* take some out */
+            if (at + length <= size) {
+                memmove(data + at, data + at + length, size - at - length);
+                size -= length;
+            }
+            break;
+        case 6:
+            /* repeat a stretch */
+            if (at + length <= size && size + length <= INPUT_MAX) {
+                memmove(data + at + length, data + at, size - at);
+                size += length;
+            }
+            break;
+        case 7: {
+            /* a stretch of another kept input */
+            const struct Input* other = &kept[xorshift(rng) % kept_count];
+            if (other->size) {
+                int from = xorshift(rng) % other->size;
+                for (int i = 0; i < length && from + i < other->size && at + i < INPUT_MAX; i++) {
+                    data[at + i] = other->data[from + i];
+                    if (at + i >= size) {
+                        size = at + i + 1;
+                    }
+                }
+            }
+            break;
+        }
+        }
+    }
+    return size;
+}
+
+/* the seed replays given, as an input's first byte means nothing without
+ * the same snapshots */
+static char** seed_args;
+static int seed_arg_count;
+
+/* put a failing input where it can be run again, and say how */
+static void save_failure(const char* dir, const unsigned char* data, int size, int n) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/fuzz-failure-%d", dir, n);
+    FILE* f = fopen(path, "wb");
+    if (!f || fwrite(data, 1, size, f) != (size_t) size || fclose(f) != 0) {
+        fprintf(stderr, "fuzz: cannot write %s\n", path);
+        return;
+    }
+    printf("wrote %s, run it again with\n  fuzz run -m %d %s", path, max_frames, path);
+    if (seed_arg_count) {
+        printf(" --");
+        for (int i = 0; i < seed_arg_count; i++) {
+            printf(" %s", seed_args[i]);
+        }
+    }
+    printf("\n");
+}
+
+/* take a snapshot every SNAPSHOT_EVERY frames of a run, while it lasts */
+static void snapshot_run(const unsigned short* keys, unsigned int frames, const struct CorpusReplay* packed) {
+    static struct Game run;
+    game_init(&run, &ground_tilemap);
+    for (unsigned int f = 0; f < frames && snapshot_count < SNAPSHOTS && run.dragon.alive; f++) {
+        if (f % SNAPSHOT_EVERY == 0) {
+            game_save(&snapshots[snapshot_count++], &run);
+        }
+        game_step(&run, packed ? corpus_keys(packed, f) : keys[f]);
+    }
+}
+
+/* the seed inputs, a stretch of keys from the start of each seed run */
+static void seed_input(const unsigned short* keys, unsigned int frames, const struct CorpusReplay* packed) {
+    unsigned char data[INPUT_MAX];
+    int size = 2;
+    data[0] = 0;
+    data[1] = 0;
+    for (unsigned int f = 0; f < frames && size < INPUT_MAX && size - 2 < max_frames; f++) {
+        data[size++] = (unsigned char) (packed ? corpus_keys(packed, f) : keys[f]);
+    }
+    keep(data, size);
+}
+
+/* load the seed replays, taking snapshots and seed inputs from each */
+static int load_seeds(char** args, int count) {
+    char** paths;
+    int found = replay_collect(args, count, &paths);
+    for (int i = 0; i < found; i++) {
+        if (corpus_sniff(paths[i])) {
+            struct Corpus corpus;
+            if (corpus_open(&corpus, paths[i]) != 0) {
+                fprintf(stderr, "fuzz: cannot map corpus %s\n", paths[i]);
+                return -1;
+            }
+            for (unsigned int e = 0; e < corpus.count; e++) {
+                struct CorpusReplay packed;
+                if (corpus_get(&corpus, e, &packed) == 0) {
+                    snapshot_run(NULL, packed.record->frames, &packed);
+                    seed_input(NULL, packed.record->frames, &packed);
+                }
+            }
+            corpus_close(&corpus);
+        } else {
+            struct Replay replay;
+            if (replay_load(&replay, paths[i]) != 0) {
+                fprintf(stderr, "fuzz: cannot load %s\n", paths[i]);
+                return -1;
+            }
+            snapshot_run(replay.keys, replay.header.frames, NULL);
+            seed_input(replay.keys, replay.header.frames, NULL);
+            replay_free(&replay);
+        }
+        free(paths[i]);
+    }
+    free(paths);
+    return 0;
+}
+
+/* with no seeds, the autopilot flies a run to take snapshots from */
+static void autopilot_seeds() {
+    static struct Game run;
+    struct Autopilot* ap = malloc(sizeof(struct Autopilot));
+    autopilot_init(ap, 256);
+    game_init(&run, &ground_tilemap);
+    unsigned short* keys = malloc(sizeof(unsigned short) * SNAPSHOTS * SNAPSHOT_EVERY);
+    unsigned int frames = 0;
+    while (frames < SNAPSHOTS * SNAPSHOT_EVERY && run.dragon.alive) {
+        keys[frames] = autopilot_decide(ap, &run) ? BUTTON_A : 0;
+        game_step(&run, keys[frames++]);
+    }
+    snapshot_run(keys, frames, NULL);
+    seed_input(keys, frames, NULL);
+    free(keys);
+    free(ap);
+}
+
+/* take the snapshots from the seeds given, or the autopilot if none */
+static int load_snapshots(char** args, int count) {
+    seed_args = args;
+    seed_arg_count = count;
+    if (count && load_seeds(args, count) != 0) {
+        return -1;
+    }
+    if (snapshot_count == 0) {
+        autopilot_seeds();
+    }
+    return 0;
+}
+
+/* step once with tracing on, to find whether this build has coverage */
+static void find_coverage() {
+    game_restore(&game, &snapshots[0]);
+    memset(edges, 0, sizeof(edges));
+    tracing = 1;
+    game_step(&game, 0);
+    tracing = 0;
+    for (int e = 0; e < EDGES && !covered; e++) {
+        covered = edges[e] != 0;
+    }
+}
+
+static int cmd_run(int argc, char** argv) {
+    int first = 2;
+    if (argc > 3 && strcmp(argv[2], "-m") == 0) {
+        max_frames = atoi(argv[3]);
+        first = 4;
+    }
+    int inputs = first;
+    while (inputs < argc && strcmp(argv[inputs], "--") != 0) {
+        inputs++;
+    }
+    if (inputs == first || max_frames <= 0 || max_frames > INPUT_MAX) {
+        fprintf(stderr, "usage: fuzz run [-m frames] <input>... [-- seed replays|dirs|corpora...]\n");
+        return 2;
+    }
+    int seeds = inputs < argc ? argc - inputs - 1 : 0;
+    if (load_snapshots(argv + inputs + 1, seeds) != 0) {
+        return 2;
+    }
+    find_coverage();
+    int failed = 0;
+    for (int i = first; i < inputs; i++) {
+        unsigned char data[INPUT_MAX];
+        FILE* f = fopen(argv[i], "rb");
+        if (!f) {
+            fprintf(stderr, "fuzz: cannot read %s\n", argv[i]);
+            return 2;
+        }
+        int size = (int) fread(data, 1, sizeof(data), f);
+        fclose(f);
+        if (run_twice(data, size)) {
+            printf("%s: %s\n", argv[i], failure);
+            failed++;
+        } else {
+            printf("%s: ok\n", argv[i]);
+        }
+    }
+    return failed ? 1 : 0;
+}
+
+UNTRACED int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "run") == 0) {
+        return cmd_run(argc, argv);
+    }
+
+    double seconds = 10;
+    unsigned long long iterations = 0;
+    unsigned int seed = 1;
+    const char* dir = ".";
+    char* seeds[256];
+    int seed_count = 0;
+    int usage = 0;
+    for (int i = 1; i < argc && !usage; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            max_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = (unsigned int) strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (argv[i][0] != '-' && seed_count < 256) {
+            seeds[seed_count++] = argv[i];
+        } else {
+            usage = 1;
+        }
+    }
+    if (usage || seconds <= 0 || max_frames <= 0 || max_frames > INPUT_MAX) {
+        fprintf(stderr, "usage: fuzz [-t seconds] [-n iterations] [-m frames] [-s seed] [-c dir] "
+                "[seed replays|dirs|corpora]...\n"
+                "       fuzz run [-m frames] <input>... [-- seed replays|dirs|corpora...]\n");
+        return 2;
+    }
+
+    if (load_snapshots(seeds, seed_count) != 0) {
+        return 2;
+    }
+    find_coverage();
+
+    /* the seeds and a couple of inputs of nothing go in first */
+    static const unsigned char empty[2] = {0, 0};
+    keep(empty, sizeof(empty));
+    int seeded = kept_count;
+    for (int i = 0; i < seeded; i++) {
+        memset(edges, 0, sizeof(edges));
+        if (run_twice(kept[i].data, kept[i].size)) {
+            printf("seed %d: %s\n", i, failure);
+            save_failure(dir, kept[i].data, kept[i].size, 0);
+            return 1;
+        }
+        new_coverage();
+    }
+
+    unsigned int rng = seed * 2654435761u + 1;
+    unsigned char data[INPUT_MAX];
+    unsigned long long done = 0, twice = 0;
+    double start = now_seconds(), next_report = start + 1;
+    for (;;) {
+        const struct Input* parent = &kept[xorshift(&rng) % kept_count];
+        memcpy(data, parent->data, parent->size);
+        int size = mutate(data, parent->size, &rng);
+
+        if (covered) {
+            memset(edges, 0, sizeof(edges));
+        }
+        unsigned int hash;
+        int failed = run_input(data, size, &hash);
+        int found = !failed && covered && new_coverage();
+
+        /* run it again if it found something, and every so often anyway */
+        if (!failed && (found || (done & 15) == 0)) {
+            failed = run_twice(data, size);
+            twice++;
+        }
+        done++;
+        if (failed) {
+            printf("iteration %llu: %s\n", done, failure);
+            save_failure(dir, data, size, 1);
+            return 1;
+        }
+        if (found) {
+            keep(data, size);
+        }
+
+        if ((done & 1023) == 0 || done == iterations) {
+            double now = now_seconds();
+            if (now >= next_report || now - start >= seconds || done == iterations) {
+                printf("%8llu iterations, %8.0f a second, %5d inputs kept, %5d edges, %llu run twice\n",
+                        done, done / (now - start), kept_count, edges_reached(), twice);
+                fflush(stdout);
+                next_report = now + 1;
+            }
+            if (now - start >= seconds || done == iterations) {
+                break;
+            }
+        }
+    }
+    if (!covered) {
+        printf("no coverage: build with -fsanitize-coverage=trace-pc to guide the mutations\n");
+    }
+    printf("%d snapshots to start from, %d seeds, no failures\n", snapshot_count, seeded);
+    return 0;
+}
@@ -0,0 +1,208 @@
+/* ghostcheck.c
+ * plays run after run into a pretend SRAM the way the ROM does, and checks
+ * the ghost of the best one.
+ *
+ *   gcc -O2 -o ghostcheck tools/ghostcheck.c
+ *
+ *   ghostcheck [--runs N] [--seed S] [--frames N] [--cuts]
+ *
+ * each run (40 by default) starts from what is in SRAM, like a boot: the
+ * best run has to load as the one the check knows is best, and the ghost
+ * has to fly it exactly, down to the frame he goes down on, beside a new
+ * run played by the autopilot on a small budget, with a few wrong flaps
+ * thrown in so the runs come out different. the run is written out a slice
+ * a frame, as the scheduler would, and then the rest once it is over. runs
+ * last until the dragon is down or the frames run out (2400 by default).
+ *
+ * with --cuts, now and then the power goes off while a better run is being
+ * kept: either before the last of it has gone out, or in the middle of its
+ * header, which is made by putting back the header bytes the slice wrote
+ * past a point. the next run must still load the best run from before.
+ *
+ * last it prints the SRAM bytes written, the most in one slice, and what
+ * flying the ghost cost a frame next to stepping the game */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../autopilot.h"
+#include "../ghost.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned int xorshift(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/* 64K of battery backed SRAM, as it comes, all ones */
+static unsigned char sram[GHOST_SLOTS * GHOST_SLOT_BYTES];
+
+/* what the check knows of the best run: its length and score, and where
+ * the dragon was each frame of it */
+struct Best {
+    int kept;
+    unsigned int frames;
+    int total;
+    int* y;
+};
+
+int main(int argc, char** argv) {
+    int runs = 40;
+    unsigned int seed = 1;
+    unsigned int frames = 2400;
+    int cuts = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int) strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (unsigned int) atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--cuts") == 0) {
+            cuts = 1;
+        } else {
+            runs = 0;
+            break;
+        }
+    }
+    if (runs <= 0 || frames == 0 || frames > GHOST_MAX_FRAMES) {
+        fprintf(stderr, "usage: ghostcheck [--runs N] [--seed S] [--frames N] [--cuts]\n");
+        return 2;
+    }
+
+    memset(sram, 0xff, sizeof(sram));
+    static struct Ghost ghost;
+    struct Autopilot* ap = malloc(sizeof(struct Autopilot));
+    static unsigned char before[sizeof(sram)];
+    struct Best best = {0, 0, 0, malloc(sizeof(int) * frames)};
+    int* trace = malloc(sizeof(int) * frames);
+
+    unsigned int rng = seed * 2654435761u + 1;
+    int kept = 0, cut = 0, torn = 0, flown = 0;
+    unsigned long long bytes = 0, slices = 0, stepped = 0, ghost_frames = 0;
+    unsigned int worst = 0;
+    double game_seconds = 0, ghost_seconds = 0;
+    for (int r = 0; r < runs; r++) {
+        ghost_init(&ghost, sram);
+        if ((ghost.best_slot >= 0) != best.kept ||
+                (best.kept && (ghost.best.frames != best.frames || ghost.best.total != best.total))) {
+            fprintf(stderr, "ghostcheck: run %d loaded %s best, %u frames scoring %d, wanted %u scoring %d\n",
+                    r, ghost.best_slot >= 0 ? "a" : "no", ghost.best.frames, ghost.best.total,
+                    best.frames, best.total);
+            return 1;
+        }
+
+        struct Game game;
+        game_init(&game, &ground_tilemap);
+        autopilot_init(ap, 16 << (xorshift(&rng) % 5));
+        int pending = 0;
+        unsigned int f;
+        for (f = 0; f < frames && game.dragon.alive; f++) {
+            unsigned short keys = autopilot_decide(ap, &game) ? BUTTON_A : 0;
+            if (xorshift(&rng) % 256 == 0) {
+                keys ^= BUTTON_A;
+            }
+            double start = now_seconds();
+            game_step(&game, keys);
+            double stepped_at = now_seconds();
+            int was_showing = ghost.showing;
+            ghost_step(&ghost, game.xscroll, game.ground);
+            game_seconds += stepped_at - start;
+            trace[f] = game.dragon.y;
+
+            /* the ghost has to be where the dragon was on this frame of the
+             * best run */
+            if (was_showing) {
+                ghost_seconds += now_seconds() - stepped_at;
+                ghost_frames++;
+                if (ghost.dragon.y != best.y[f]) {
+                    fprintf(stderr, "ghostcheck: run %d frame %u the ghost is at %d, the best run was at %d\n",
+                            r, f, ghost.dragon.y, best.y[f]);
+                    return 1;
+                }
+                if (!ghost.showing && ghost.played != best.frames) {
+                    fprintf(stderr, "ghostcheck: run %d the ghost went after %u frames of %u\n",
+                            r, ghost.played, best.frames);
+                    return 1;
+                }
+            }
+
+            pending |= ghost_record(&ghost, keys);
+            if (pending) {
+                pending = ghost_save(&ghost);
+            }
+        }
+        stepped += f;
+        flown += ghost.played > 0;
+
+        /* the ghost of a run the dragon went down in goes down with him */
+        if (ghost.played == best.frames && best.kept && ghost.dragon.alive != (best.frames == frames)) {
+            fprintf(stderr, "ghostcheck: run %d the ghost is %s at the end of the best run\n",
+                    r, ghost.dragon.alive ? "still up" : "down");
+            return 1;
+        }
+
+        /* the run is over: keep it if it is better, maybe losing power on
+         * the way */
+        int better = !best.kept || game.score.total > best.total ||
+            (game.score.total == best.total && f > best.frames);
+        pending |= ghost_finish(&ghost, game.score.total);
+        if (better != (ghost.state == GHOST_KEEPING)) {
+            fprintf(stderr, "ghostcheck: run %d scoring %d in %u frames was %s\n", r, game.score.total, f,
+                    better ? "dropped" : "kept");
+            return 1;
+        }
+        int power = cuts && better && xorshift(&rng) % 3 == 0 ? 1 + xorshift(&rng) % 2 : 0;
+        if (power == 1) {
+            /* off before the last of it goes out */
+            pending = 0;
+            better = 0;
+            cut++;
+        }
+        while (pending) {
+            memcpy(before, sram, sizeof(sram));
+            pending = ghost_save(&ghost);
+            if (power == 2 && ghost.state == GHOST_SAVED) {
+                /* off partway through the header: put back the bytes it
+                 * wrote after a point */
+                unsigned int at = ghost_slot_offset(ghost.slot);
+                unsigned int from = xorshift(&rng) % sizeof(struct GhostHeader);
+                memcpy(sram + at + from, before + at + from, sizeof(struct GhostHeader) - from);
+                better = 0;
+                torn++;
+            }
+        }
+        if (better) {
+            kept++;
+            best.kept = 1;
+            best.frames = f;
+            best.total = game.score.total;
+            memcpy(best.y, trace, sizeof(int) * f);
+        }
+        bytes += ghost.bytes;
+        slices += ghost.slices;
+        if (ghost.worst > worst) {
+            worst = ghost.worst;
+        }
+    }
+
+    printf("%d runs, %d kept, %d flown against, %d cut off and %d torn, best %u frames scoring %d\n",
+            runs, kept, flown, cut, torn, best.frames, best.total);
+    printf("sram: %llu bytes in %llu slices, worst %u bytes a slice of %d\n", bytes, slices, worst,
+            GHOST_SLICE_BYTES);
+    printf("game_step %.1f ns a frame, ghost %.1f ns a frame flying\n", game_seconds / stepped * 1e9,
+            ghost_frames ? ghost_seconds / ghost_frames * 1e9 : 0);
+    return 0;
+}
@@ -0,0 +1,191 @@
+/* levelbench.c
+ * flies the autopilot through the streamed level and checks the streamer
+ * keeps the ring and the screen blocks in step with the level.
+ *
+ *   gcc -O2 -o levelbench tools/levelbench.c
+ *
+ *   levelbench [frames]
+ *
+ * two games run side by side on the same keys: one collides against the
+ * streamer's ring, the other against the whole level unpacked up front, and
+ * their hashes have to agree every frame. the screen blocks are a host
+ * buffer, and after each vblank's columns go in every column on screen has
+ * to hold the level's tiles, in the ring and in the buffer. every
+ * ROLLBACK_EVERY frames both games go back to a snapshot from
+ * ROLLBACK_FRAMES before, further than the ring keeps behind the screen,
+ * and the streamer has to unpack the whole ring back the way it was.
+ *
+ * it runs for the given number of frames (7200 by default, starting again
+ * when the dragon dies) with the search unlimited, and prints the columns
+ * and bytes unpacked a frame, the worst frame and the time an update
+ * takes */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../autopilot.h"
+#include "../level.h"
+#include "../level1.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const struct Level level = {level1_data, level1_index, level1_width};
+
+/* how often the games are rolled back, and how far */
+#define ROLLBACK_EVERY 600
+#define ROLLBACK_FRAMES 300
+
+/* whether every column on screen holds the level's tiles, in the ring and
+ * in the screen blocks */
+static int on_screen(const struct LevelStreamer* streamer, const unsigned short* screen,
+        const struct Tilemap* whole, int xscroll) {
+    int left = xscroll >> 3;
+    for (int c = left; c <= left + SCREEN_WIDTH / 8; c++) {
+        int slot = c & (LEVEL_RING - 1);
+        const unsigned short* block = screen + (slot >> 5) * 32 * 32 + (slot & 31);
+        for (int row = 0; row < LEVEL_ROWS; row++) {
+            unsigned short want = whole->tiles[row * whole->width + c % whole->width];
+            if (streamer->ring[row * LEVEL_RING + slot] != want || block[row * 32] != want) {
+                fprintf(stderr, "levelbench: column %d row %d is wrong\n", c, row);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/* whether every slot of the ring and the screen holds the column the
+ * streamer's place in the level says it should */
+static int whole_ring(const struct LevelStreamer* streamer, const unsigned short* screen,
+        const struct Tilemap* whole) {
+    for (int c = streamer->next - LEVEL_RING; c < streamer->next; c++) {
+        int slot = c & (LEVEL_RING - 1);
+        const unsigned short* block = screen + (slot >> 5) * 32 * 32 + (slot & 31);
+        for (int row = 0; row < LEVEL_ROWS; row++) {
+            unsigned short want = c < 0 ? 0 : whole->tiles[row * whole->width + c % whole->width];
+            if (streamer->ring[row * LEVEL_RING + slot] != want || block[row * 32] != want) {
+                fprintf(stderr, "levelbench: column %d row %d is wrong after a rollback\n", c, row);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 7200;
+    if (frames <= 0) {
+        fprintf(stderr, "usage: levelbench [frames]\n");
+        return 2;
+    }
+
+    /* the whole level, to check against */
+    static unsigned short tiles[level1_width * LEVEL_ROWS];
+    for (int c = 0; c < level1_width; c++) {
+        level_column_unpack(&level, c, tiles + c, level1_width);
+    }
+    struct Tilemap whole = {tiles, level1_width, LEVEL_ROWS, NULL};
+
+    static unsigned short screen[2 * 32 * 32];
+    static struct LevelStreamer streamer;
+    static struct Game game, check;
+    static struct Game saved, saved_check;
+    static struct Autopilot autopilot;
+
+    double spent = 0, worst_time = 0;
+    long long bytes = 0, columns = 0;
+    int worst = 0, late = 0;
+    int deaths = 0, furthest = 0, rollbacks = 0;
+    int restart = 1, have_saved = 0;
+    for (int f = 0; f < frames; f++) {
+        if (restart) {
+            game_init(&game, &whole);
+            game_init(&check, &whole);
+            level_streamer_init(&streamer, &level, screen, &game);
+            check.ground_next = game.ground_next;
+            autopilot_init(&autopilot, 0);
+            restart = 0;
+            have_saved = 0;
+        }
+
+        /* go back to the snapshot, which the ring has to follow before the
+         * game steps against it */
+        if (f % ROLLBACK_EVERY == 0) {
+            game_save(&saved, &game);
+            game_save(&saved_check, &check);
+            have_saved = 1;
+        } else if (f % ROLLBACK_EVERY == ROLLBACK_FRAMES && have_saved) {
+            game_restore(&game, &saved);
+            game_restore(&check, &saved_check);
+            level_streamer_sync(&streamer, &game);
+            level_streamer_commit(&streamer, screen);
+            if (!whole_ring(&streamer, screen, &whole)) {
+                fprintf(stderr, "levelbench: rolled back to scroll %d on frame %d\n", game.xscroll, f);
+                return 1;
+            }
+            autopilot.steer_map = 0;
+            rollbacks++;
+        }
+
+        unsigned short keys = autopilot_decide(&autopilot, &game) ? BUTTON_A : 0;
+        game_step(&game, keys);
+        game_step(&check, keys);
+        if (game_hash(&game) != game_hash(&check)) {
+            fprintf(stderr, "levelbench: the streamed game went its own way on frame %d\n", f);
+            return 1;
+        }
+
+        unsigned int before = streamer.bytes, was_late = streamer.late;
+        double start = now_seconds();
+        int unpacked = level_streamer_update(&streamer, &game);
+        double took = now_seconds() - start;
+
+        /* the check game has no streamer, so it goes along with the
+         * streamed game's place in the level to hash the same */
+        check.ground_next = game.ground_next;
+        if (unpacked) {
+            autopilot.steer_map = 0;
+        }
+        columns += unpacked;
+        late += streamer.late != was_late;
+        if (unpacked > worst) {
+            worst = unpacked;
+        }
+        spent += took;
+        if (took > worst_time) {
+            worst_time = took;
+        }
+        bytes += streamer.bytes - before;
+        level_streamer_commit(&streamer, screen);
+        if (!on_screen(&streamer, screen, &whole, game.xscroll)) {
+            fprintf(stderr, "levelbench: on frame %d at scroll %d\n", f, game.xscroll);
+            return 1;
+        }
+
+        if (game.xscroll > furthest) {
+            furthest = game.xscroll;
+        }
+        if (!game.dragon.alive) {
+            deaths++;
+            restart = 1;
+        }
+    }
+
+    int packed = sizeof(level1_data) + sizeof(level1_index);
+    printf("level of %d columns, %d bytes packed, %d unpacked\n", level1_width, packed,
+            level1_width * LEVEL_ROWS * 2);
+    printf("%d frames, %d deaths, %d rollbacks, furthest %d pixels (%d laps)\n\n", frames, deaths,
+            rollbacks, furthest, furthest / (level1_width * 8));
+    printf("columns      %8.3f a frame, worst %d, %d late\n", (double) columns / frames, worst, late);
+    printf("bytes read   %8.2f a frame\n", (double) bytes / frames);
+    printf("update       %8.1f ns a frame, worst %.1f ns\n", 1e9 * spent / frames, 1e9 * worst_time);
+    return late != 0;
+}
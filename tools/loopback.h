@@ -0,0 +1,104 @@
+/* loopback.h
+ * an in-process stand-in for the link cable, for running two netplay
+ * consoles in one program. each direction is a queue of messages stamped
+ * with the tick they arrive on: the tick they were sent, plus a fixed
+ * latency, plus up to jitter ticks more. like a real link it never reorders,
+ * so a message held up by jitter holds up the ones behind it too */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the most messages one direction can have in flight, a power of two */
+#define LOOPBACK_QUEUE 1024
+
+/* one direction of the link */
+struct LoopbackQueue {
+    unsigned short messages[LOOPBACK_QUEUE];
+    int arrives[LOOPBACK_QUEUE];
+    int head, tail;
+};
+
+struct Loopback {
+    struct LoopbackQueue queues[2];
+
+    /* the current tick, in frames, which the caller moves on */
+    int tick;
+    int latency;
+    int jitter;
+    unsigned int random;
+
+    /* what each end hands to netplay */
+    struct LoopbackEnd {
+        struct Loopback* loopback;
+        int side;
+    } ends[2];
+    struct Transport transports[2];
+
+    /* messages sent in all, and the most that were ever in flight */
+    unsigned int sent;
+    int most_in_flight;
+};
+
+/* send from one end, to arrive at the other */
+static void loopback_send(void* context, unsigned short message) {
+    struct LoopbackEnd* end = context;
+    struct Loopback* lb = end->loopback;
+    struct LoopbackQueue* queue = &lb->queues[!end->side];
+    if (queue->head - queue->tail >= LOOPBACK_QUEUE) {
+        fprintf(stderr, "loopback: queue overflow\n");
+        exit(1);
+    }
+
+    lb->random ^= lb->random << 13;
+    lb->random ^= lb->random >> 17;
+    lb->random ^= lb->random << 5;
+    int arrives = lb->tick + lb->latency + (lb->jitter ? (int) (lb->random % (lb->jitter + 1)) : 0);
+
+    /* nothing overtakes what went before it */
+    if (queue->head != queue->tail) {
+        int before = queue->arrives[(queue->head - 1) % LOOPBACK_QUEUE];
+        if (arrives < before) {
+            arrives = before;
+        }
+    }
+    queue->messages[queue->head % LOOPBACK_QUEUE] = message;
+    queue->arrives[queue->head % LOOPBACK_QUEUE] = arrives;
+    queue->head++;
+    lb->sent++;
+    if (queue->head - queue->tail > lb->most_in_flight) {
+        lb->most_in_flight = queue->head - queue->tail;
+    }
+}
+
+/* take the next message that has arrived at one end */
+static int loopback_receive(void* context, unsigned short* message) {
+    struct LoopbackEnd* end = context;
+    struct Loopback* lb = end->loopback;
+    struct LoopbackQueue* queue = &lb->queues[end->side];
+    if (queue->head == queue->tail || queue->arrives[queue->tail % LOOPBACK_QUEUE] > lb->tick) {
+        return 0;
+    }
+    *message = queue->messages[queue->tail % LOOPBACK_QUEUE];
+    queue->tail++;
+    return 1;
+}
+
+static void loopback_init(struct Loopback* lb, int latency, int jitter, unsigned int seed) {
+    memset(lb, 0, sizeof(struct Loopback));
+    lb->latency = latency;
+    lb->jitter = jitter;
+    lb->random = seed ? seed : 1;
+    for (int side = 0; side < 2; side++) {
+        lb->ends[side].loopback = lb;
+        lb->ends[side].side = side;
+        lb->transports[side].context = &lb->ends[side];
+        lb->transports[side].send = loopback_send;
+        lb->transports[side].receive = loopback_receive;
+    }
+}
+
+/* whether anything is still on its way */
+static int loopback_busy(const struct Loopback* lb) {
+    return lb->queues[0].head != lb->queues[0].tail || lb->queues[1].head != lb->queues[1].tail;
+}
@@ -0,0 +1,119 @@
+/* maps.h
+ * ground maps for the host tools: reading the GBA Tile Editor headers and
+ * generating seeded maps in the style of the shipped one */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the tiles a generated map is built from */
+#define TILE_EMPTY 0x41
+#define TILE_MARK 0x0b
+
+/* read a map written by the GBA Tile Editor */
+static inline int load_map(const char* path, struct Tilemap* map) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* text = malloc(size + 1);
+    text[fread(text, 1, size, f)] = '\0';
+    fclose(f);
+
+    char* p = strstr(text, "_width");
+    map->width = p ? atoi(p + 6) : 0;
+    p = strstr(text, "_height");
+    map->height = p ? atoi(p + 7) : 0;
+    p = strchr(text, '{');
+    if (!p || map->width <= 0 || map->height <= 0) {
+        free(text);
+        return -1;
+    }
+
+    unsigned short* tiles = malloc(sizeof(unsigned short) * map->width * map->height);
+    int n = 0;
+    while (n < map->width * map->height) {
+        char* end;
+        long v = strtol(p + 1, &end, 0);
+        if (end == p + 1) {
+            p++;
+            if (!*p || *p == '}') {
+                break;
+            }
+            continue;
+        }
+        tiles[n++] = (unsigned short) v;
+        p = end;
+    }
+    free(text);
+    map->tiles = tiles;
+    map->columns = NULL;
+    return n == map->width * map->height ? 0 : -1;
+}
+
+static inline unsigned int maps_xorshift(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/* build a ground map like the shipped one, of any width: pipes from the top
+ * and bottom with a gap between, the ground along rows 18 and 19 and empty
+ * rows below */
+static inline void generate_wide_map(unsigned int seed, int w, struct Tilemap* map) {
+    int h = groundlayermap_height;
+    unsigned short* tiles = malloc(sizeof(unsigned short) * w * h);
+    unsigned int rng = seed * 2654435761u + 1;
+
+    for (int i = 0; i < w * h; i++) {
+        tiles[i] = TILE_EMPTY;
+    }
+    /* copy the ground over from the real map */
+    for (int y = 18; y < 20; y++) {
+        for (int x = 0; x < w; x++) {
+            tiles[y * w + x] = groundlayermap[y * groundlayermap_width + x % groundlayermap_width];
+        }
+    }
+
+    /* the first pipe ends before pixel 40, where the dragon starts */
+    int x = 1 + maps_xorshift(&rng) % 3;
+    while (x + 2 < w) {
+        int gap = 4 + maps_xorshift(&rng) % 4;
+        int top = 1 + maps_xorshift(&rng) % (17 - gap - 1);
+        for (int y = 0; y < 18; y++) {
+            unsigned short left, right;
+            if (y >= top && y < top + gap) {
+                continue;
+            } else if (y == top - 1) {
+                left = 0x0c; right = 0x0d;
+            } else if (y == top + gap) {
+                left = 0x03; right = 0x04;
+            } else {
+                left = (y & 1) ? 0x0e : 0x01;
+                right = (y & 1) ? 0x0f : 0x02;
+            }
+            tiles[y * w + x] = left;
+            tiles[y * w + x + 1] = right;
+        }
+        /* the score counts the mark above the back of the pipe */
+        if (top > 1) {
+            tiles[x + 1] = TILE_MARK;
+        }
+        x += 10 + maps_xorshift(&rng) % 5;
+    }
+
+    map->tiles = tiles;
+    map->width = w;
+    map->height = h;
+    map->columns = NULL;
+}
+
+/* a generated map as wide as the shipped one */
+static inline void generate_map(unsigned int seed, struct Tilemap* map) {
+    generate_wide_map(seed, groundlayermap_width, map);
+}
@@ -0,0 +1,136 @@
+/* maskbench.c
+ * measures the dragon's mask collision test against the five tile probes it
+ * replaced, and counts where the two disagree.
+ *
+ *   gcc -O2 -o maskbench tools/maskbench.c
+ *
+ *   maskbench [--tests N] [--seed S] [map.h]
+ *
+ * the dragon is put at random places and animation frames over the shipped
+ * map or the one given, the given number of times (1000000 by default). it
+ * prints how many places each test called a hit, how many only the probes
+ * called a hit (pixels that are not drawn, or a probe past the edge of the
+ * sprite) and how many only the masks did (drawn pixels between the probes).
+ * then it prints the time per test each way with the scroll kept within the
+ * first lap of the map and within later ones, as tile_lookup() takes longer
+ * the further the game has scrolled. the masks get the map's columns worked
+ * out first, the way the game has them */
+
+#define PHLAPU_HOST
+#include "../game.h"
+
+#include <time.h>
+
+#include "maps.h"
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* the test as it was: five tile lookups around the sprite */
+static int probe_collides(int x, int y, int xscroll, const struct Tilemap* map) {
+    unsigned short below = tile_lookup(x + 8, y + 16, xscroll, 0, map->tiles, map->width, map->height);
+    unsigned short topRight = tile_lookup(x + 13, y, xscroll, 0, map->tiles, map->width, map->height);
+    unsigned short right = tile_lookup(x + 16, y + 8, xscroll, 0, map->tiles, map->width, map->height);
+    unsigned short botRight = tile_lookup(x + 15, y + 15, xscroll, 0, map->tiles, map->width, map->height);
+    unsigned short above = tile_lookup(x + 8, y, xscroll, 0, map->tiles, map->width, map->height);
+
+    return tile_solid(above) || tile_solid(right) || tile_solid(topRight) ||
+        tile_solid(botRight) || tile_solid(below);
+}
+
+int main(int argc, char** argv) {
+    int tests = 1000000;
+    unsigned int seed = 1;
+    struct Tilemap map = ground_tilemap;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tests") == 0 && i + 1 < argc) {
+            tests = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int) strtoul(argv[++i], NULL, 0);
+        } else if (argv[i][0] != '-') {
+            if (load_map(argv[i], &map) != 0) {
+                fprintf(stderr, "maskbench: could not read a map from %s\n", argv[i]);
+                return 2;
+            }
+        } else {
+            fprintf(stderr, "usage: maskbench [--tests N] [--seed S] [map.h]\n");
+            return 2;
+        }
+    }
+    if (tests <= 0) {
+        fprintf(stderr, "maskbench: tests must be positive\n");
+        return 2;
+    }
+
+    /* what is in each column, as the game works out when it starts */
+    struct TileColumn* columns = malloc(sizeof(struct TileColumn) * map.width);
+    map.columns = columns;
+    tilemap_columns(&map);
+
+    /* the places to test, picked up front so both tests see the same ones */
+    int* xs = malloc(sizeof(int) * tests);
+    int* ys = malloc(sizeof(int) * tests);
+    int* scrolls = malloc(sizeof(int) * tests);
+    int* laps = malloc(sizeof(int) * tests);
+    int* frames = malloc(sizeof(int) * tests);
+    unsigned char* probed = malloc(tests);
+    unsigned char* masked = malloc(tests);
+    unsigned int r = seed ? seed : 1;
+    for (int i = 0; i < tests; i++) {
+        r ^= r << 13;
+        r ^= r >> 17;
+        r ^= r << 5;
+        xs[i] = (int) ((r >> 4) % (SCREEN_WIDTH - 15));
+        ys[i] = (int) (r % (SCREEN_HEIGHT - 15));
+        laps[i] = (int) ((r >> 8) % (unsigned int) (map.width * 8));
+        frames[i] = (int) ((r >> 24) % DRAGON_MASK_FRAMES);
+    }
+
+    printf("%d tests on a %dx%d map\n\n", tests, map.width, map.height);
+    printf("laps  probes ns/test  masks ns/test\n");
+    int lap_counts[] = {0, 4, 16, 64};
+    for (int n = 0; n < (int) (sizeof(lap_counts) / sizeof(lap_counts[0])); n++) {
+        for (int i = 0; i < tests; i++) {
+            scrolls[i] = laps[i] + lap_counts[n] * map.width * 8;
+        }
+
+        double start = now_seconds();
+        for (int i = 0; i < tests; i++) {
+            probed[i] = probe_collides(xs[i], ys[i], scrolls[i], &map);
+        }
+        double middle = now_seconds();
+        for (int i = 0; i < tests; i++) {
+            masked[i] = dragon_collides(xs[i], ys[i], frames[i], scrolls[i], &map);
+        }
+        double end = now_seconds();
+        printf("%4d  %14.1f  %13.1f\n", lap_counts[n], 1e9 * (middle - start) / tests,
+                1e9 * (end - middle) / tests);
+    }
+
+    /* the scroll is a whole number of laps past the first, so these are
+     * the same places every time */
+    long long probe_hits = 0, mask_hits = 0, probe_only = 0, mask_only = 0;
+    for (int i = 0; i < tests; i++) {
+        probe_hits += probed[i];
+        mask_hits += masked[i];
+        probe_only += probed[i] && !masked[i];
+        mask_only += masked[i] && !probed[i];
+    }
+    printf("\ntest    hits      only this one\n");
+    printf("probes  %8lld  %13lld\n", probe_hits, probe_only);
+    printf("masks   %8lld  %13lld\n", mask_hits, mask_only);
+
+    free(masked);
+    free(probed);
+    free(frames);
+    free(laps);
+    free(scrolls);
+    free(ys);
+    free(xs);
+    free(columns);
+    return 0;
+}
@@ -0,0 +1,171 @@
+/* mklevel.c
+ * packs a ground map into the column format level.h streams from ROM.
+ *
+ *   gcc -O2 -o mklevel tools/mklevel.c
+ *
+ *   mklevel [-m map.h] name (map.h | --generate columns seed)... > name.h
+ *
+ * the level is the given maps one after another. each is a GBA Tile Editor
+ * header 32 tiles tall and any width, or one generated in the style of the
+ * shipped map with the given width and seed. each column is packed as runs down it, and columns that pack the same are
+ * only kept once. -m also writes the map out unpacked, so reachcheck can
+ * prove the level can be flown through. the sizes go to stderr */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../level.h"
+
+#include "maps.h"
+
+/* pack one column, returning its length */
+static int pack_column(const struct Tilemap* map, int x, unsigned char* out) {
+    int n = 0;
+    int y = 0;
+    while (y < LEVEL_ROWS) {
+        unsigned short entry = map->tiles[y * map->width + x];
+        int length = 1;
+        while (y + length < LEVEL_ROWS && length <= LEVEL_RUN_LENGTH &&
+                map->tiles[(y + length) * map->width + x] == entry) {
+            length++;
+        }
+        int wide = entry > 0xff;
+        out[n++] = (length - 1) | (wide ? LEVEL_RUN_WIDE : 0);
+        out[n++] = entry & 0xff;
+        if (wide) {
+            out[n++] = entry >> 8;
+        }
+        y += length;
+    }
+    return n;
+}
+
+/* write a map the way the GBA Tile Editor does */
+static int save_map(const char* path, const struct Tilemap* map, const char* name) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        return -1;
+    }
+    fprintf(f, "/* created by mklevel */\n\n");
+    fprintf(f, "#define %smap_width %d\n#define %smap_height %d\n\n", name, map->width, name, map->height);
+    fprintf(f, "const unsigned short %smap [] = {", name);
+    for (int i = 0; i < map->width * map->height; i++) {
+        fprintf(f, "%s0x%04x%s", i % 9 == 0 ? "\n    " : "", map->tiles[i],
+                i + 1 < map->width * map->height ? ", " : "");
+    }
+    fprintf(f, "\n};\n");
+    return fclose(f);
+}
+
+/* put one map after another */
+static void append_map(struct Tilemap* level, const struct Tilemap* map) {
+    int width = level->width + map->width;
+    unsigned short* tiles = malloc(sizeof(unsigned short) * width * LEVEL_ROWS);
+    for (int y = 0; y < LEVEL_ROWS; y++) {
+        for (int x = 0; x < level->width; x++) {
+            tiles[y * width + x] = level->tiles[y * level->width + x];
+        }
+        for (int x = 0; x < map->width; x++) {
+            tiles[y * width + level->width + x] = map->tiles[y * map->width + x];
+        }
+    }
+    level->tiles = tiles;
+    level->width = width;
+}
+
+int main(int argc, char** argv) {
+    const char* unpacked = NULL;
+    int arg = 1;
+    if (arg + 1 < argc && strcmp(argv[arg], "-m") == 0) {
+        unpacked = argv[arg + 1];
+        arg += 2;
+    }
+    if (arg + 1 >= argc) {
+        fprintf(stderr, "usage: mklevel [-m map.h] name (map.h | --generate columns seed)...\n");
+        return 2;
+    }
+    const char* name = argv[arg++];
+
+    /* the maps, one after another */
+    struct Tilemap map = {NULL, 0, LEVEL_ROWS, NULL};
+    while (arg < argc) {
+        struct Tilemap part;
+        if (strcmp(argv[arg], "--generate") == 0 && arg + 2 < argc) {
+            int columns = atoi(argv[arg + 1]);
+            if (columns <= 0) {
+                fprintf(stderr, "mklevel: bad width %s\n", argv[arg + 1]);
+                return 2;
+            }
+            generate_wide_map((unsigned int) strtoul(argv[arg + 2], NULL, 0), columns, &part);
+            arg += 3;
+        } else if (argv[arg][0] != '-' && load_map(argv[arg], &part) == 0) {
+            arg++;
+        } else {
+            fprintf(stderr, "mklevel: cannot read map %s\n", argv[arg]);
+            return 2;
+        }
+        if (part.height != LEVEL_ROWS) {
+            fprintf(stderr, "mklevel: a map is %d tall, levels are %d\n", part.height, LEVEL_ROWS);
+            return 2;
+        }
+        append_map(&map, &part);
+    }
+
+    /* pack every column, pointing repeats at the first one like them */
+    unsigned char* data = malloc(map.width * LEVEL_ROWS * 3);
+    unsigned int* index = malloc(sizeof(unsigned int) * map.width);
+    int* lengths = malloc(sizeof(int) * map.width);
+    int size = 0, unique = 0;
+    for (int x = 0; x < map.width; x++) {
+        unsigned char column[LEVEL_ROWS * 3];
+        int n = pack_column(&map, x, column);
+        index[x] = size;
+        lengths[x] = n;
+        for (int earlier = 0; earlier < x; earlier++) {
+            if (lengths[earlier] == n && memcmp(data + index[earlier], column, n) == 0) {
+                index[x] = index[earlier];
+                break;
+            }
+        }
+        if ((int) index[x] == size) {
+            memcpy(data + size, column, n);
+            size += n;
+            unique++;
+        }
+    }
+
+    /* unpack it all again, to be sure */
+    struct Level level = {data, index, map.width};
+    unsigned short check[LEVEL_ROWS];
+    for (int x = 0; x < map.width; x++) {
+        level_column_unpack(&level, x, check, 1);
+        for (int y = 0; y < LEVEL_ROWS; y++) {
+            if (check[y] != map.tiles[y * map.width + x]) {
+                fprintf(stderr, "mklevel: column %d does not unpack the same\n", x);
+                return 1;
+            }
+        }
+    }
+
+    printf("/* created by mklevel */\n\n");
+    printf("#define %s_width %d\n\n", name, map.width);
+    printf("const unsigned int %s_index [] = {", name);
+    for (int x = 0; x < map.width; x++) {
+        printf("%s%u%s", x % 12 == 0 ? "\n    " : "", index[x], x + 1 < map.width ? ", " : "");
+    }
+    printf("\n};\n\n");
+    printf("const unsigned char %s_data [] = {", name);
+    for (int i = 0; i < size; i++) {
+        printf("%s0x%02x%s", i % 12 == 0 ? "\n    " : "", data[i], i + 1 < size ? ", " : "");
+    }
+    printf("\n};\n");
+
+    if (unpacked && save_map(unpacked, &map, name) != 0) {
+        fprintf(stderr, "mklevel: cannot write %s\n", unpacked);
+        return 2;
+    }
+    int raw = map.width * LEVEL_ROWS * 2;
+    int packed = size + map.width * (int) sizeof(unsigned int);
+    fprintf(stderr, "%s: %d columns, %d different, %d bytes packed with the index, "
+            "%d unpacked (%.1f%%)\n", name, map.width, unique, packed, raw, 100.0 * packed / raw);
+    return 0;
+}
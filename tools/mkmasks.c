@@ -0,0 +1,120 @@
+/* mkmasks.c
+ * builds masks.h, the 1bpp collision masks for the dragon sprite and the
+ * background tiles, from the image data png2gba made.
+ *
+ *   gcc -O2 -o mkmasks tools/mkmasks.c
+ *   ./mkmasks > masks.h
+ *
+ * run it again whenever dragon.h or background.h change. a bit is set for
+ * every pixel that is not colour 0, with bit 0 the leftmost pixel.
+ *
+ * the dragon gets a mask for every tile offset its animation uses, 0 to 16,
+ * taken from where the hardware reads a 16x16 256 colour sprite in 1D
+ * mapping: four 64 byte tiles in a row starting 32 bytes times the offset
+ * in. the odd offsets start half way into a tile, and the masks follow what
+ * is really drawn for those too. each mask has 8 empty rows above and below
+ * the sprite, so the game can always test 8 rows against a row of tiles
+ * whatever line the sprite starts on.
+ *
+ * each frame also gets the tiles it covers at every pixel offset within a
+ * tile, a bit for each of the three by three tiles under it, so the game
+ * can rule out the tiles the sprite only reaches with empty pixels without
+ * looking at any of its lines. and the tiles get a flag for whether every
+ * pixel is drawn, as any drawn pixel of the sprite over one of those hits */
+
+#include <stdio.h>
+
+#include "../dragon.h"
+#include "../background.h"
+
+/* the tile offsets the dragon's animation goes through */
+#define DRAGON_FRAMES 17
+
+/* whether a pixel of a 256 colour tile set is drawn, given the byte the
+ * tiles start at and where in a sprite or tile of tiles_across tiles wide
+ * the pixel is */
+static int opaque(const unsigned char* data, int start, int tiles_across, int x, int y) {
+    int tile = (y >> 3) * tiles_across + (x >> 3);
+    return data[start + tile * 64 + (y & 7) * 8 + (x & 7)] != 0;
+}
+
+int main() {
+    int tiles = (background_width / 8) * (background_height / 8);
+
+    printf("/* masks.h\n * generated by mkmasks from dragon.h and background.h */\n\n");
+    printf("/* one bit per pixel, bit 0 the leftmost, set where a pixel is drawn */\n");
+    printf("#define DRAGON_MASK_FRAMES %d\n", DRAGON_FRAMES);
+    printf("#define TILE_MASK_COUNT %d\n\n", tiles);
+
+    /* each dragon frame, a row of 16 pixels to a word, between 8 empty rows
+     * above and below so any 8 rows in line with the tiles can be read */
+    unsigned short masks[DRAGON_FRAMES][32] = {{0}};
+    for (int frame = 0; frame < DRAGON_FRAMES; frame++) {
+        for (int y = 0; y < 16; y++) {
+            for (int x = 0; x < 16; x++) {
+                masks[frame][8 + y] |= opaque(dragon_data, frame * 32, 2, x, y) << x;
+            }
+        }
+    }
+    printf("const unsigned short dragon_masks[DRAGON_MASK_FRAMES][32] = {\n");
+    for (int frame = 0; frame < DRAGON_FRAMES; frame++) {
+        for (int y = 0; y < 32; y += 8) {
+            printf("%s", y == 0 ? "    {" : "     ");
+            for (int i = y; i < y + 8; i++) {
+                printf("0x%04x%s", masks[frame][i], i == 31 ? "},\n" : i % 8 == 7 ? ",\n" : ", ");
+            }
+        }
+    }
+    printf("};\n\n");
+
+    /* the tiles each frame covers, by the line of its tile row the sprite
+     * starts on times 8 plus the pixel of its tile column, a bit for the
+     * tile in column c and row r of the three by three at bit c * 3 + r */
+    printf("const unsigned short dragon_cover[DRAGON_MASK_FRAMES][64] = {\n");
+    for (int frame = 0; frame < DRAGON_FRAMES; frame++) {
+        for (int offset = 0; offset < 64; offset++) {
+            int top = offset >> 3, shift = offset & 7;
+            unsigned int cover = 0;
+            for (int y = 0; y < 16; y++) {
+                for (int x = 0; x < 16; x++) {
+                    if (masks[frame][8 + y] & (1 << x)) {
+                        cover |= 1u << (((shift + x) >> 3) * 3 + ((top + y) >> 3));
+                    }
+                }
+            }
+            printf("%s0x%03x%s", offset == 0 ? "    {" : offset % 8 == 0 ? "     " : "",
+                    cover, offset == 63 ? "},\n" : offset % 8 == 7 ? ",\n" : ", ");
+        }
+    }
+    printf("};\n\n");
+
+    /* each background tile, a row of 8 pixels to a byte */
+    printf("const unsigned char tile_masks[TILE_MASK_COUNT][8] = {\n");
+    for (int tile = 0; tile < tiles; tile++) {
+        printf("    {");
+        for (int y = 0; y < 8; y++) {
+            unsigned char row = 0;
+            for (int x = 0; x < 8; x++) {
+                row |= opaque(background_data, tile * 64, 1, x, y) << x;
+            }
+            printf("0x%02x%s", row, y < 7 ? ", " : "");
+        }
+        printf("},\n");
+    }
+    printf("};\n\n");
+
+    /* whether each background tile has every pixel drawn */
+    printf("const unsigned char tile_full[TILE_MASK_COUNT] = {\n");
+    for (int tile = 0; tile < tiles; tile++) {
+        int full = 1;
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                full &= opaque(background_data, tile * 64, 1, x, y);
+            }
+        }
+        printf("%s%d%s", tile % 16 == 0 ? "    " : "", full,
+                tile == tiles - 1 ? "\n" : tile % 16 == 15 ? ",\n" : ", ");
+    }
+    printf("};\n");
+    return 0;
+}
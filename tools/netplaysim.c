@@ -0,0 +1,202 @@
+/* netplaysim.c
+ * runs two netplay consoles against each other over the loopback link and
+ * checks rollback keeps them in step.
+ *
+ *   gcc -O2 -o netplaysim tools/netplaysim.c
+ *
+ *   netplaysim [--frames N] [--latency L] [--jitter J] [--seed S] [--down F] [--sweep]
+ *
+ * each console flies its own dragon with the autopilot, so the keys change
+ * often and the guesses about the other side are often wrong. once both
+ * have run the given number of frames (1800 by default) the link is let
+ * drain, and both consoles' matches are checked against each other and
+ * against the match stepped straight through with the keys each side sent.
+ * it prints how many frames were rolled back and what the rollbacks cost,
+ * and exits non-zero if anything disagrees. latency and jitter are in
+ * frames; --sweep runs a range of latencies with the given jitter.
+ *
+ * with --down, each autopilot lets go of its dragon after F frames, the
+ * second 40 frames later, and each console stops as the ROM does, once
+ * netplay_over() says both dragons are down for certain rather than at the
+ * frame count. a console that stops while the other still needs its keys
+ * leaves that one stalled, which fails the run */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../autopilot.h"
+#include "../netplay.h"
+
+#include <time.h>
+
+#include "loopback.h"
+
+/* how one run went */
+struct SimResult {
+    int agreed;
+    int stuck;
+    unsigned int stalls;
+    unsigned int rollbacks;
+    unsigned int resimulated;
+    int worst_depth;
+    double seconds;
+    double worst_seconds;
+};
+
+/* the host clock in nanoseconds, cut down to 32 bits for netplay */
+static unsigned int clock_nanoseconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned int) (ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+static void simulate(int frames, int latency, int jitter, unsigned int seed, int down,
+        struct SimResult* result) {
+    struct Loopback* lb = malloc(sizeof(struct Loopback));
+    struct Netplay* consoles = malloc(2 * sizeof(struct Netplay));
+    struct Autopilot* pilots = malloc(2 * sizeof(struct Autopilot));
+    unsigned short* sent[2] = {calloc(frames, 2), calloc(frames, 2)};
+
+    loopback_init(lb, latency, jitter, seed);
+    for (int side = 0; side < 2; side++) {
+        netplay_init(&consoles[side], side, &lb->transports[side], &ground_tilemap);
+        consoles[side].clock = clock_nanoseconds;
+        autopilot_init(&pilots[side], 0);
+    }
+
+    double seconds = 0, worst = 0;
+    unsigned int rollbacks[2] = {0, 0};
+    int tick = 0;
+
+    /* run both consoles a frame per tick until both are done, then give
+     * the link time to drain and the last rollbacks time to happen. a
+     * console still going long after it should have finished is stuck */
+    result->stuck = 0;
+    for (;; tick++) {
+        if (tick > 4 * frames + 1000) {
+            result->stuck = 1;
+            break;
+        }
+        lb->tick = tick;
+        int running = 0;
+        for (int side = 0; side < 2; side++) {
+            struct Netplay* np = &consoles[side];
+            if (np->frame < frames && !(down && netplay_over(np))) {
+                struct Game* own = &np->match.players[side];
+                unsigned short keys = 0;
+                if (own->dragon.alive && (!down || np->frame < down + 40 * side)) {
+                    keys = autopilot_decide(&pilots[side], own) ? BUTTON_A : 0;
+                }
+                if (netplay_update(np, keys)) {
+                    sent[side][np->frame - 1] = keys;
+                }
+                running = 1;
+            } else {
+                netplay_receive(np);
+                netplay_resimulate(np);
+            }
+
+            if (np->rollbacks != rollbacks[side]) {
+                double taken = np->cycles / 1e9;
+                seconds += taken;
+                if (taken > worst) {
+                    worst = taken;
+                }
+                rollbacks[side] = np->rollbacks;
+            }
+        }
+        if (!running && !loopback_busy(lb)) {
+            break;
+        }
+    }
+
+    /* the match as it should have gone */
+    struct Match* reference = malloc(sizeof(struct Match));
+    match_init(reference, &ground_tilemap);
+    for (int frame = 0; frame < frames; frame++) {
+        unsigned short keys[2] = {sent[0][frame], sent[1][frame]};
+        match_step(reference, keys);
+    }
+    unsigned int expected = match_hash(reference);
+
+    /* a dragon that is down stays as he is, so a console that stopped once
+     * both were down has to agree with the match stepped to the end */
+    result->agreed = !result->stuck;
+    for (int side = 0; side < 2; side++) {
+        struct Netplay* np = &consoles[side];
+        int finished = down ? netplay_over(np) :
+            np->confirmed == frames && np->frame == frames;
+        if (!finished || match_hash(&np->match) != expected) {
+            result->agreed = 0;
+        }
+    }
+    result->stalls = consoles[0].stalls + consoles[1].stalls;
+    result->rollbacks = consoles[0].rollbacks + consoles[1].rollbacks;
+    result->resimulated = consoles[0].resimulated + consoles[1].resimulated;
+    result->worst_depth = consoles[0].worst_depth > consoles[1].worst_depth ?
+        consoles[0].worst_depth : consoles[1].worst_depth;
+    result->seconds = seconds;
+    result->worst_seconds = worst;
+
+    free(reference);
+    free(sent[0]);
+    free(sent[1]);
+    free(pilots);
+    free(consoles);
+    free(lb);
+}
+
+static void print_result(int latency, int jitter, const struct SimResult* r) {
+    printf("%7d  %6d  %6s  %6u  %9u  %10.2f  %11d  %13.2f  %11.2f\n", latency, jitter,
+            r->agreed ? "yes" : r->stuck ? "STUCK" : "NO", r->stalls, r->rollbacks,
+            r->rollbacks ? (double) r->resimulated / r->rollbacks : 0.0, r->worst_depth,
+            r->resimulated ? 1e9 * r->seconds / r->resimulated : 0.0,
+            1e6 * r->worst_seconds);
+}
+
+int main(int argc, char** argv) {
+    int frames = 1800;
+    int latency = 3;
+    int jitter = 2;
+    unsigned int seed = 1;
+    int sweep = 0;
+    int down = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+            latency = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--jitter") == 0 && i + 1 < argc) {
+            jitter = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int) strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--down") == 0 && i + 1 < argc) {
+            down = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            sweep = 1;
+        } else {
+            fprintf(stderr, "usage: netplaysim [--frames N] [--latency L] [--jitter J] "
+                    "[--seed S] [--down F] [--sweep]\n");
+            return 2;
+        }
+    }
+    if (frames <= 0 || latency < 0 || jitter < 0 || down < 0) {
+        fprintf(stderr, "netplaysim: frames must be positive, latency, jitter and down not negative\n");
+        return 2;
+    }
+
+    int latencies[] = {0, 1, 2, 3, 4, 6, 8, 12};
+    int runs = sweep ? (int) (sizeof(latencies) / sizeof(latencies[0])) : 1;
+    int failed = 0;
+
+    printf("%d frames per console, window %d frames\n\n", frames, NETPLAY_WINDOW);
+    printf("latency  jitter  agreed  stalls  rollbacks  mean depth  worst depth  ns/resim frame  worst us\n");
+    for (int i = 0; i < runs; i++) {
+        int l = sweep ? latencies[i] : latency;
+        struct SimResult result;
+        simulate(frames, l, jitter, seed, down, &result);
+        print_result(l, jitter, &result);
+        failed |= !result.agreed;
+    }
+    return failed;
+}
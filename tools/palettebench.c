@@ -0,0 +1,176 @@
+/* palettebench.c
+ * checks the packed palette blend against blending one colour at a time,
+ * then runs the effects the ROM uses and shows what they cost.
+ *
+ *   gcc -O2 -o palettebench tools/palettebench.c
+ *
+ *   palettebench [frames]
+ *
+ * every level of every colour is blended towards a spread of colours both
+ * ways and compared. then the game's palettes fade in from black with the
+ * yellows cycling and a hit flash every 90 vblanks, for the given number of
+ * vblanks (3600 by default), with palette memory a host buffer. each vblank
+ * the buffer has to match the palette worked out colour by colour, and at
+ * the end it prints the words blended and the time taken each way */
+
+#define PHLAPU_HOST
+#include "../memory.h"
+#include "../dmaqueue.h"
+#include "../palette.h"
+#include "../background.h"
+#include "../dragon.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* one colour blended a channel at a time */
+static unsigned short blend_one(unsigned short from, unsigned short to, int level) {
+    unsigned short out = 0;
+    for (int shift = 0; shift < 15; shift += 5) {
+        int a = (from >> shift) & 31, b = (to >> shift) & 31;
+        out |= ((a * (PALETTE_LEVELS - level) + b * level) >> 5) << shift;
+    }
+    return out;
+}
+
+/* a whole palette blended that way, for the timings */
+static void blend_each(unsigned short* dest, const unsigned short* source, int colors,
+        unsigned short to, int level) {
+    for (int c = 0; c < colors; c++) {
+        dest[c] = blend_one(source[c], to, level);
+    }
+}
+
+/* the palette a bank should be showing, worked out from scratch */
+static void expected(const struct PaletteBank* bank, unsigned short* want) {
+    int colors = bank->words * 2;
+    for (int c = 0; c < colors; c++) {
+        want[c] = bank->source[c];
+    }
+    for (int i = 0; i < bank->cycle_count; i++) {
+        const struct PaletteCycle* cycle = &bank->cycles[i];
+        for (int c = 0; c < cycle->count; c++) {
+            want[cycle->first + c] = bank->source[cycle->first + (c + cycle->phase) % cycle->count];
+        }
+    }
+    int fade = palette_fade_level(bank);
+    for (int c = 0; c < colors; c++) {
+        if (fade) {
+            want[c] = blend_one(want[c], bank->fade_color, fade);
+        }
+        if (bank->flash_level) {
+            want[c] = blend_one(want[c], bank->flash_color, bank->flash_level);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int vblanks = argc > 1 ? atoi(argv[1]) : 3600;
+    if (vblanks <= 0) {
+        fprintf(stderr, "usage: palettebench [frames]\n");
+        return 2;
+    }
+
+    /* every colour, in pairs, at every level towards some colours */
+    static unsigned int all[0x4000], blended[0x4000];
+    for (int c = 0; c < 0x8000; c++) {
+        ((unsigned short*) all)[c] = c;
+    }
+    static const unsigned short targets[] = {PALETTE_BLACK, PALETTE_WHITE, 0x001f, 0x03e0, 0x7c00, 0x4210, 0x1234};
+    for (int t = 0; t < (int) (sizeof(targets) / sizeof(targets[0])); t++) {
+        for (int level = 0; level <= PALETTE_LEVELS; level++) {
+            palette_blend(blended, all, 0x4000, targets[t], level);
+            for (int c = 0; c < 0x8000; c++) {
+                unsigned short want = blend_one(c, targets[t], level);
+                unsigned short got = ((unsigned short*) blended)[c];
+                if (got != want) {
+                    fprintf(stderr, "palettebench: %04x to %04x at level %d gave %04x, not %04x\n",
+                            c, targets[t], level, got, want);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    /* the effects the ROM runs */
+    static unsigned short hardware[PALETTE_BANKS][PALETTE_COLORS];
+    static struct Palettes palettes;
+    struct DmaQueue queue;
+    dma_queue_init(&queue);
+    static unsigned int frame_memory[PALETTE_BANKS * PALETTE_WORDS];
+    struct Arena frame_arena;
+    arena_init(&frame_arena, "frame", frame_memory, sizeof(frame_memory));
+    memcpy(hardware[PALETTE_BG], background_palette, sizeof(hardware[PALETTE_BG]));
+    memcpy(hardware[PALETTE_SPRITES], dragon_palette, sizeof(hardware[PALETTE_SPRITES]));
+    palettes_init(&palettes, background_palette, hardware[PALETTE_BG],
+            dragon_palette, hardware[PALETTE_SPRITES]);
+    palette_cycle_add(&palettes.banks[PALETTE_BG], 19, 2, 24);
+    for (int b = 0; b < PALETTE_BANKS; b++) {
+        palette_fade(&palettes.banks[b], PALETTE_BLACK, PALETTE_LEVELS, 0);
+        palette_fade(&palettes.banks[b], PALETTE_BLACK, 0, 32);
+    }
+
+    double spent = 0;
+    long long bytes = 0;
+    int busy = 0;
+    for (int v = 0; v < vblanks; v++) {
+        if (v % 90 == 45) {
+            palette_flash(&palettes.banks[PALETTE_SPRITES], PALETTE_WHITE, 24, 12);
+        }
+        double start = now_seconds();
+        arena_reset(&frame_arena);
+        int words = palettes_update(&palettes, &queue, &frame_arena);
+        spent += now_seconds() - start;
+        busy += words != 0;
+        bytes += queue.words * 4;
+        for (int i = 0; i < queue.count; i++) {
+            memcpy(queue.copies[i].dest, queue.copies[i].source, queue.copies[i].words * 4);
+        }
+        dma_queue_done(&queue);
+
+        for (int b = 0; b < PALETTE_BANKS; b++) {
+            unsigned short want[PALETTE_COLORS];
+            const struct PaletteBank* bank = &palettes.banks[b];
+            expected(bank, want);
+            if (memcmp(want, hardware[b], bank->words * 4) != 0) {
+                fprintf(stderr, "palettebench: bank %d is wrong at vblank %d\n", b, v);
+                return 1;
+            }
+        }
+    }
+
+    /* a whole bank each way, to compare the two */
+    const int rounds = 20000;
+    unsigned short scratch[PALETTE_COLORS];
+    double start = now_seconds();
+    for (int r = 0; r < rounds; r++) {
+        palette_blend(blended, (const unsigned int*) background_palette, PALETTE_WORDS, PALETTE_BLACK, r & 31);
+    }
+    double packed = (now_seconds() - start) / rounds;
+    start = now_seconds();
+    for (int r = 0; r < rounds; r++) {
+        blend_each(scratch, background_palette, PALETTE_COLORS, PALETTE_BLACK, r & 31);
+        blended[r & 127] = scratch[r & 255];
+    }
+    double each = (now_seconds() - start) / rounds;
+
+    printf("bank        colours used\n");
+    printf("background  %12d\nsprites     %12d\n\n", palettes.banks[PALETTE_BG].words * 2,
+            palettes.banks[PALETTE_SPRITES].words * 2);
+    printf("%d vblanks, %d with blending, %u words blended, worst %d in one vblank\n",
+            vblanks, busy, palettes.total, palettes.worst);
+    printf("uploaded %.2f bytes a vblank, %u banks, %u dropped\n", (double) bytes / vblanks,
+            palettes.uploads, palettes.dropped);
+    printf("update               %8.1f ns a vblank\n", 1e9 * spent / vblanks);
+    printf("256 colours packed   %8.1f ns\n", 1e9 * packed);
+    printf("256 colours singly   %8.1f ns\n", 1e9 * each);
+    return palettes.dropped != 0;
+}
@@ -0,0 +1,174 @@
+/* particlebench.c
+ * times the particle update and checks the sprites it writes.
+ *
+ *   gcc -O2 -o particlebench tools/particlebench.c
+ *
+ *   particlebench [frames]
+ *
+ * a burst of 64 of a kind goes off every 24 frames, turn about, with a few
+ * puffs every frame in between, so the pool is full some of the time and
+ * has to turn some down. after every update each live particle has to sit
+ * in its sprite, 8x8 at its own tile, and the sprites behind them from the
+ * frame before have to be hidden. a plain loop over a struct a particle,
+ * fed the same throws, has to keep the same particles alive. it runs for
+ * the given number of frames (100000 by default) and prints the time a
+ * particle takes both ways */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../memory.h"
+#include "../particles.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* the same particles, a struct each, to time against */
+struct Particle {
+    int x, y;
+    short xvel, yvel, gravity;
+    unsigned char life;
+    unsigned short tile;
+};
+
+static struct Particle reference[PARTICLE_CAPACITY];
+static int reference_count;
+
+static void reference_copy_in(const struct Particles* p, int from) {
+    for (int i = from; i < p->count; i++) {
+        struct Particle* r = &reference[reference_count++];
+        r->x = p->x[i];
+        r->y = p->y[i];
+        r->xvel = p->xvel[i];
+        r->yvel = p->yvel[i];
+        r->gravity = p->gravity[i];
+        r->life = p->life[i];
+        r->tile = p->tile[i];
+    }
+}
+
+static int reference_update(struct Sprite* out) {
+    int n = reference_count;
+    int i = 0;
+    while (i < n) {
+        struct Particle* r = &reference[i];
+        int px = r->x + r->xvel;
+        int py = r->y + r->yvel;
+        int sx = px >> 8, sy = py >> 8;
+        if (--r->life == 0 || sx < -8 || sx >= SCREEN_WIDTH || sy < -8 || sy >= SCREEN_HEIGHT) {
+            *r = reference[--n];
+            continue;
+        }
+        r->x = px;
+        r->y = py;
+        r->yvel += r->gravity;
+        out[i].attribute0 = (sy & 0xff) | (1 << 13);
+        out[i].attribute1 = sx & 0x1ff;
+        out[i].attribute2 = r->tile;
+        i++;
+    }
+    reference_count = n;
+    return n;
+}
+
+/* whether the sprites hold the particles, and the rest up to shown before
+ * are hidden */
+static int check_sprites(const struct Particles* p, const struct Sprite* out, int shown_before, int frame) {
+    for (int i = 0; i < p->count; i++) {
+        int sx = p->x[i] >> 8, sy = p->y[i] >> 8;
+        if (out[i].attribute0 != ((sy & 0xff) | (1 << 13)) || out[i].attribute1 != (sx & 0x1ff) ||
+                out[i].attribute2 != p->tile[i]) {
+            fprintf(stderr, "particlebench: sprite %d does not match its particle on frame %d\n", i, frame);
+            return 0;
+        }
+        if (p->life[i] == 0) {
+            fprintf(stderr, "particlebench: particle %d is alive with no life on frame %d\n", i, frame);
+            return 0;
+        }
+    }
+    for (int i = p->count; i < shown_before; i++) {
+        if (out[i].attribute0 != SCREEN_HEIGHT || out[i].attribute1 != SCREEN_WIDTH) {
+            fprintf(stderr, "particlebench: sprite %d was left showing on frame %d\n", i, frame);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 100000;
+    if (frames <= 0) {
+        fprintf(stderr, "usage: particlebench [frames]\n");
+        return 2;
+    }
+
+    static struct Particles particles;
+    static struct Sprite out[PARTICLE_CAPACITY], reference_out[PARTICLE_CAPACITY];
+    unsigned char tiles[PARTICLE_KINDS * PARTICLE_TILE_BYTES];
+    particle_tiles_build(tiles);
+    particles_init(&particles, 512);
+
+    double spent = 0, reference_spent = 0;
+    long long moved = 0, emitted = 0, asked = 0;
+    for (int f = 0; f < frames; f++) {
+        int before = particles.count;
+        if (f % 24 == 0) {
+            asked += PARTICLE_CAPACITY;
+            emitted += particles_burst(&particles, (f / 24) % PARTICLE_KINDS, 120, 80, PARTICLE_CAPACITY);
+        } else {
+            asked += 3;
+            emitted += particles_burst(&particles, PARTICLE_PUFF, 60 + f % 40, 70, 3);
+        }
+        reference_copy_in(&particles, before);
+
+        /* the two take turns going first, so neither gets the caches or
+         * the branch history the other left behind every time */
+        int shown_before = particles.shown;
+        moved += particles.count;
+        int left = 0, reference_left = 0;
+        for (int turn = 0; turn < 2; turn++) {
+            double start = now_seconds();
+            if ((turn ^ f) & 1) {
+                reference_left = reference_update(reference_out);
+                reference_spent += now_seconds() - start;
+            } else {
+                left = particles_update(&particles, out);
+                spent += now_seconds() - start;
+            }
+        }
+
+        if (left != reference_left) {
+            fprintf(stderr, "particlebench: %d particles left but the reference has %d on frame %d\n",
+                    left, reference_left, f);
+            return 1;
+        }
+        for (int i = 0; i < left; i++) {
+            if (out[i].attribute0 != reference_out[i].attribute0 ||
+                    out[i].attribute1 != reference_out[i].attribute1 ||
+                    out[i].attribute2 != reference_out[i].attribute2) {
+                fprintf(stderr, "particlebench: sprite %d differs from the reference on frame %d\n", i, f);
+                return 1;
+            }
+        }
+        if (!check_sprites(&particles, out, shown_before, f)) {
+            return 1;
+        }
+    }
+
+    if (asked - emitted != particles.dropped) {
+        fprintf(stderr, "particlebench: %lld turned down but %u counted\n", asked - emitted, particles.dropped);
+        return 1;
+    }
+    printf("%d frames, %lld particles thrown, %u turned down, %d alive at most\n",
+            frames, emitted, particles.dropped, particles.high);
+    printf("%.2f particles moved a frame\n\n", (double) moved / frames);
+    printf("arrays     %6.2f ns a particle\n", 1e9 * spent / moved);
+    printf("structs    %6.2f ns a particle\n", 1e9 * reference_spent / moved);
+    return 0;
+}
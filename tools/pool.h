@@ -0,0 +1,162 @@
+/* pool.h
+ * a small work-stealing thread pool for the host tools.
+ *
+ * a batch of jobs is numbered 0..count-1 and split into one contiguous range
+ * per worker. each worker takes jobs off the back of its own range, and when
+ * it runs dry it steals the front half of the fullest-looking range of
+ * another worker. a range is a (head, tail) pair packed into one 64 bit word
+ * so taking and stealing are both a single compare-and-swap */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <unistd.h>
+
+/* the most workers a pool will start */
+#define POOL_MAX_THREADS 256
+
+/* a job is called with the user pointer, the job number and the worker */
+typedef void (*pool_job)(void* arg, int index, int worker);
+
+/* the range of jobs owned by one worker, padded out to its own cache line */
+struct PoolRange {
+    _Atomic uint64_t range;
+    char pad[64 - sizeof(uint64_t)];
+};
+
+/* what each worker got up to in the last batch */
+struct PoolWorker {
+    int jobs;
+    int steals;
+};
+
+struct Pool {
+    int threads;
+    int count;
+    pool_job job;
+    void* arg;
+    struct PoolRange ranges[POOL_MAX_THREADS];
+    struct PoolWorker workers[POOL_MAX_THREADS];
+};
+
+/* pack and unpack a [head, tail) range */
+static inline uint64_t pool_pack(uint32_t head, uint32_t tail) {
+    return ((uint64_t) head << 32) | tail;
+}
+static inline uint32_t pool_head(uint64_t r) { return (uint32_t) (r >> 32); }
+static inline uint32_t pool_tail(uint64_t r) { return (uint32_t) r; }
+
+/* the number of cores on this machine */
+static inline int pool_cores() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n < 1 ? 1 : (n > POOL_MAX_THREADS ? POOL_MAX_THREADS : (int) n);
+}
+
+/* take the last job of our own range, or -1 if it is empty */
+static inline int pool_take(struct PoolRange* own) {
+    uint64_t r = atomic_load(&own->range);
+    while (pool_head(r) < pool_tail(r)) {
+        uint64_t taken = pool_pack(pool_head(r), pool_tail(r) - 1);
+        if (atomic_compare_exchange_weak(&own->range, &r, taken)) {
+            return (int) pool_tail(taken);
+        }
+    }
+    return -1;
+}
+
+/* steal the front half of some other worker's range into our own, returns
+ * whether anything was stolen */
+static inline int pool_steal(struct Pool* pool, int self) {
+    for (int pass = 0; pass < 2; pass++) {
+        /* look for the victim with the most work left */
+        int victim = -1;
+        uint32_t most = 0;
+        for (int i = 1; i < pool->threads; i++) {
+            int v = (self + i) % pool->threads;
+            uint64_t r = atomic_load(&pool->ranges[v].range);
+            uint32_t left = pool_tail(r) - pool_head(r);
+            if (pool_head(r) < pool_tail(r) && left > most) {
+                most = left;
+                victim = v;
+            }
+        }
+        if (victim < 0) {
+            return 0;
+        }
+
+        uint64_t r = atomic_load(&pool->ranges[victim].range);
+        while (pool_head(r) < pool_tail(r)) {
+            uint32_t head = pool_head(r);
+            uint32_t half = (pool_tail(r) - head + 1) / 2;
+            if (atomic_compare_exchange_weak(&pool->ranges[victim].range, &r,
+                        pool_pack(head + half, pool_tail(r)))) {
+                /* our own range is empty so nobody else can be changing it */
+                atomic_store(&pool->ranges[self].range, pool_pack(head, head + half));
+                pool->workers[self].steals++;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+struct PoolThread {
+    struct Pool* pool;
+    int self;
+};
+
+static inline void* pool_worker(void* p) {
+    struct PoolThread* t = p;
+    struct Pool* pool = t->pool;
+    for (;;) {
+        int index = pool_take(&pool->ranges[t->self]);
+        if (index < 0) {
+            if (!pool_steal(pool, t->self)) {
+                break;
+            }
+            continue;
+        }
+        pool->job(pool->arg, index, t->self);
+        pool->workers[t->self].jobs++;
+    }
+    return NULL;
+}
+
+/* run jobs 0..count-1 across the given number of threads and wait for them
+ * all, the per worker counts are left in pool->workers */
+static inline void pool_run(struct Pool* pool, int threads, int count, pool_job job, void* arg) {
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > POOL_MAX_THREADS) {
+        threads = POOL_MAX_THREADS;
+    }
+    pool->threads = threads;
+    pool->count = count;
+    pool->job = job;
+    pool->arg = arg;
+
+    /* hand out the jobs in contiguous slices */
+    for (int i = 0; i < threads; i++) {
+        uint32_t head = (uint32_t) ((int64_t) count * i / threads);
+        uint32_t tail = (uint32_t) ((int64_t) count * (i + 1) / threads);
+        atomic_store(&pool->ranges[i].range, pool_pack(head, tail));
+        pool->workers[i].jobs = 0;
+        pool->workers[i].steals = 0;
+    }
+
+    /* the calling thread is worker 0 */
+    pthread_t ids[POOL_MAX_THREADS];
+    struct PoolThread args[POOL_MAX_THREADS];
+    for (int i = 0; i < threads; i++) {
+        args[i].pool = pool;
+        args[i].self = i;
+    }
+    for (int i = 1; i < threads; i++) {
+        pthread_create(&ids[i], NULL, pool_worker, &args[i]);
+    }
+    pool_worker(&args[0]);
+    for (int i = 1; i < threads; i++) {
+        pthread_join(ids[i], NULL);
+    }
+}
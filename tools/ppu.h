@@ -0,0 +1,164 @@
+/* ppu.h
+ * draws a frame of the game on the host the way the GBA's picture unit
+ * would: the back layer, the ground over it and the sprites on top, into a
+ * 240x160 picture of 8 bit RGB.
+ *
+ * it knows only what the ROM uses. both backgrounds are 256 colour text
+ * layers drawn from the tiles in background.h, 64 bytes each, with the map
+ * entries' flip bits. sprites are 256 colour, laid out one dimensionally
+ * from dragon.h, any of the square, wide and tall sizes, flipped or not,
+ * wrapping round at 512 across and 256 down; a lower numbered sprite is
+ * drawn over a higher one. colour 0 is see through everywhere but the back
+ * layer, which is over the backdrop.
+ *
+ * this needs game.h for the sprites */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../background.h"
+#include "../dragon.h"
+#include "../layer0map.h"
+
+/* a picture the size of the screen */
+struct PpuFrame {
+    unsigned char rgb[SCREEN_HEIGHT][SCREEN_WIDTH][3];
+};
+
+/* what one frame shows: the ground, its scroll, the back layer's scroll and
+ * the sprite table. the ground map wraps at its own width and height */
+struct PpuView {
+    const unsigned short* ground;
+    int ground_width, ground_height;
+    int xscroll;
+    int back_xscroll;
+    const struct Sprite* sprites;
+};
+
+/* the palettes as 8 bit RGB */
+struct Ppu {
+    unsigned char bg[256][3];
+    unsigned char sprites[256][3];
+};
+
+/* a GBA colour is 5 bits each of red, green and blue from the low bits up */
+static inline void ppu_palette(const unsigned short* colors, int count, unsigned char rgb[256][3]) {
+    memset(rgb, 0, 256 * 3);
+    for (int i = 0; i < count && i < 256; i++) {
+        for (int c = 0; c < 3; c++) {
+            int five = (colors[i] >> (5 * c)) & 0x1f;
+            rgb[i][c] = (five << 3) | (five >> 2);
+        }
+    }
+}
+
+static inline void ppu_init(struct Ppu* ppu) {
+    ppu_palette(background_palette, sizeof(background_palette) / 2, ppu->bg);
+    ppu_palette(dragon_palette, sizeof(dragon_palette) / 2, ppu->sprites);
+}
+
+/* draw a text background scrolled across by xscroll. transparent leaves
+ * colour 0 showing what is under it */
+static inline void ppu_draw_background(const struct Ppu* ppu, struct PpuFrame* frame, const unsigned short* map,
+        int width, int height, int xscroll, int transparent) {
+    int tiles = (int) sizeof(background_data) / 64;
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        int row = (y >> 3) % height;
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            int mx = ((x + xscroll) % (width * 8) + width * 8) % (width * 8);
+            unsigned short entry = map[row * width + (mx >> 3)];
+            int tile = entry & 0x3ff;
+            if (tile >= tiles) {
+                continue;
+            }
+            int px = mx & 7, py = y & 7;
+            if (entry & (1 << 10)) {
+                px = 7 - px;
+            }
+            if (entry & (1 << 11)) {
+                py = 7 - py;
+            }
+            int index = background_data[tile * 64 + py * 8 + px];
+            if (index == 0 && transparent) {
+                continue;
+            }
+            memcpy(frame->rgb[y][x], ppu->bg[index], 3);
+        }
+    }
+}
+
+/* the width and height of each shape and size */
+static const unsigned char ppu_sprite_sizes[3][4][2] = {
+    {{8, 8}, {16, 16}, {32, 32}, {64, 64}},
+    {{16, 8}, {32, 8}, {32, 16}, {64, 32}},
+    {{8, 16}, {8, 32}, {16, 32}, {32, 64}},
+};
+
+static inline void ppu_draw_sprite(const struct Ppu* ppu, struct PpuFrame* frame, const struct Sprite* sprite) {
+    int shape = sprite->attribute0 >> 14;
+    if (shape == 3 || (sprite->attribute0 & (3 << 8)) == (2 << 8)) {
+        return;
+    }
+    int w = ppu_sprite_sizes[shape][sprite->attribute1 >> 14][0];
+    int h = ppu_sprite_sizes[shape][sprite->attribute1 >> 14][1];
+
+    /* positions past the far edge come back in from the near one */
+    int sx = sprite->attribute1 & 0x1ff;
+    int sy = sprite->attribute0 & 0xff;
+    if (sx + w > 512) {
+        sx -= 512;
+    }
+    if (sy + h > 256) {
+        sy -= 256;
+    }
+    int hflip = (sprite->attribute1 >> 12) & 1;
+    int vflip = (sprite->attribute1 >> 13) & 1;
+    int base = (sprite->attribute2 & 0x3ff) * 32;
+
+    for (int y = 0; y < h; y++) {
+        int fy = sy + y;
+        if (fy < 0 || fy >= SCREEN_HEIGHT) {
+            continue;
+        }
+        int py = vflip ? h - 1 - y : y;
+        for (int x = 0; x < w; x++) {
+            int fx = sx + x;
+            if (fx < 0 || fx >= SCREEN_WIDTH) {
+                continue;
+            }
+            int px = hflip ? w - 1 - x : x;
+
+            /* 8x8 tiles of 64 bytes, a row of the sprite's tiles after
+             * another */
+            int tile = (py >> 3) * (w >> 3) + (px >> 3);
+            int at = base + tile * 64 + (py & 7) * 8 + (px & 7);
+            if (at >= (int) sizeof(dragon_data)) {
+                continue;
+            }
+            int index = dragon_data[at];
+            if (index) {
+                memcpy(frame->rgb[fy][fx], ppu->sprites[index], 3);
+            }
+        }
+    }
+}
+
+/* draw a whole frame */
+static inline void ppu_draw(const struct Ppu* ppu, struct PpuFrame* frame, const struct PpuView* view) {
+    ppu_draw_background(ppu, frame, layer0map, layer0map_width, layer0map_height, view->back_xscroll, 0);
+    ppu_draw_background(ppu, frame, view->ground, view->ground_width, view->ground_height, view->xscroll, 1);
+    for (int i = NUM_SPRITES - 1; i >= 0; i--) {
+        ppu_draw_sprite(ppu, frame, &view->sprites[i]);
+    }
+}
+
+/* write a frame out as a binary PPM, returns 0 on success */
+static inline int ppu_write_ppm(const struct PpuFrame* frame, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    int ok = fwrite(frame->rgb, sizeof(frame->rgb), 1, f) == 1;
+    return (fclose(f) == 0 && ok) ? 0 : -1;
+}
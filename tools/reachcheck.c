@@ -0,0 +1,396 @@
+/* reachcheck.c
+ * proves a ground map can be flown through, by a breadth first search over
+ * every (y, yvel, animation) the dragon can be in on each frame of scrolling.
+ *
+ *   gcc -O2 -pthread -o reachcheck tools/reachcheck.c
+ *
+ *   reachcheck [-j N] [-o witness.rpl] [map.h]       check one map
+ *   reachcheck [-j N] --seed S [--count N]            check generated maps
+ *
+ * every frame the search steps each state twice through the real game code,
+ * once flapping and once not, and keeps the ones where the dragon survives
+ * and is still on screen. states are deduplicated by whole pixel of y, a
+ * quarter pixel of yvel, and the animation frame and counter: a flap puts
+ * the wings back to the first frame, and the collision goes by the frame,
+ * so two states in the same place can still hit different things. a found
+ * path is always a real one, while a map reported as blocked could in
+ * principle still have a path the bucketing threw away. a map is passable
+ * when some state survives a full lap of it.
+ *
+ * a single map is searched with its frontier split across the threads, a
+ * seeded batch runs one map per job on the work-stealing pool instead */
+
+#define PHLAPU_HOST
+#include "../game.h"
+
+#include <time.h>
+
+#include "maps.h"
+#include "pool.h"
+#include "replay.h"
+
+/* where the dragon sits on screen and how tall it is */
+#define DRAGON_X 40
+#define DRAGON_SIZE 16
+
+/* the bucket sizes and range of yvel */
+#define YVEL_SHIFT 6
+#define YVEL_LIMIT (64 << 8)
+#define YVEL_BUCKETS ((2 * YVEL_LIMIT) >> YVEL_SHIFT)
+
+/* y is kept to the visible screen, or to the whole map with --offscreen */
+#define Y_BUCKETS 256
+
+/* the animation frames, 0 to 16, and the counter, which runs up to
+ * dragon_init()'s animation_delay of 8 */
+#define ANIMATION_FRAMES 17
+#define ANIMATION_COUNTERS 8
+
+/* one bit per state a frame could keep */
+#define SEEN_BITS (Y_BUCKETS * YVEL_BUCKETS * ANIMATION_FRAMES * ANIMATION_COUNTERS)
+
+/* one state in the search: where it came from and how the dragon is moving */
+struct Node {
+    int y, yvel;
+    /* the animation, as collisions go by the frame that is showing */
+    int frame, counter;
+    int parent;
+    int flap;
+};
+
+/* all the states reached on one frame */
+struct Layer {
+    struct Node* nodes;
+    int count;
+};
+
+struct Search {
+    const struct Tilemap* map;
+    int offscreen;
+    int threads;
+
+    /* the layers found so far, one per frame */
+    struct Layer* layers;
+    int frames;
+
+    /* one bit per (y, yvel bucket, frame, counter) for the layer being
+     * built */
+    _Atomic unsigned int* seen;
+
+    /* per chunk output while a layer is being built */
+    struct Node** out;
+    int* out_count;
+    int chunks;
+    int chunk_size;
+
+    /* results */
+    int passable;
+    int blocked_column;
+    long long states;
+};
+
+/* each thread keeps a game to step states through */
+static _Thread_local struct Game scratch;
+static _Thread_local int scratch_ready;
+
+/* step one state a frame, returns whether the dragon lives and stays in
+ * range, filling in where it ends up */
+static int advance(const struct Tilemap* map, int offscreen, int frame,
+        const struct Node* from, int flapping, struct Node* to) {
+    if (!scratch_ready) {
+        game_init(&scratch, map);
+        scratch_ready = 1;
+    }
+    struct Game game = scratch;
+    game.ground = map;
+    game.xscroll = 1 + frame;
+    game.frames = frame;
+    game.dragon.y = from->y;
+    game.dragon.yvel = from->yvel;
+    game.dragon.frame = from->frame;
+    game.dragon.counter = from->counter;
+    game.dragon.falling = frame > 0;
+
+    if (!game_step(&game, flapping ? BUTTON_A : 0)) {
+        return 0;
+    }
+
+    int y = game.dragon.y >> 8;
+    if (!offscreen && (y < 0 || y > SCREEN_HEIGHT - DRAGON_SIZE)) {
+        return 0;
+    }
+    if (game.dragon.yvel <= -YVEL_LIMIT || game.dragon.yvel >= YVEL_LIMIT) {
+        return 0;
+    }
+    to->y = game.dragon.y;
+    to->yvel = game.dragon.yvel;
+    to->frame = game.dragon.frame;
+    to->counter = game.dragon.counter;
+    to->flap = flapping;
+    return 1;
+}
+
+/* mark a state seen, returns whether it was new */
+static int visit(struct Search* s, const struct Node* n) {
+    unsigned int y = (unsigned int) (n->y >> 8) & (Y_BUCKETS - 1);
+    unsigned int v = (unsigned int) ((n->yvel + YVEL_LIMIT) >> YVEL_SHIFT);
+    unsigned int bit = ((y * YVEL_BUCKETS + v) * ANIMATION_FRAMES + n->frame) * ANIMATION_COUNTERS +
+        n->counter;
+    unsigned int mask = 1u << (bit & 31);
+    return !(atomic_fetch_or(&s->seen[bit >> 5], mask) & mask);
+}
+
+/* expand one chunk of the current frontier */
+static void expand_chunk(void* arg, int chunk, int worker) {
+    struct Search* s = arg;
+    struct Layer* layer = &s->layers[s->frames - 1];
+    int first = chunk * s->chunk_size;
+    int last = first + s->chunk_size;
+    if (last > layer->count) {
+        last = layer->count;
+    }
+    (void) worker;
+
+    struct Node* out = s->out[chunk];
+    int count = 0;
+    for (int i = first; i < last; i++) {
+        for (int flapping = 0; flapping < 2; flapping++) {
+            struct Node next;
+            if (advance(s->map, s->offscreen, s->frames - 1, &layer->nodes[i],
+                        flapping, &next) && visit(s, &next)) {
+                next.parent = i;
+                out[count++] = next;
+            }
+        }
+    }
+    s->out_count[chunk] = count;
+}
+
+/* search a map, with the given number of threads working on each frame */
+static void search(struct Search* s, const struct Tilemap* map, int threads,
+        int offscreen, struct Pool* pool) {
+    int laps = map->width * 8;
+    memset(s, 0, sizeof(*s));
+    s->map = map;
+    s->offscreen = offscreen;
+    s->threads = threads;
+    s->layers = calloc(laps + 2, sizeof(struct Layer));
+    s->seen = calloc(SEEN_BITS / 32, sizeof(unsigned int));
+
+    /* the first frame is the dragon as the game starts it */
+    struct Game start;
+    game_init(&start, map);
+    s->layers[0].nodes = malloc(sizeof(struct Node));
+    s->layers[0].nodes[0].y = start.dragon.y;
+    s->layers[0].nodes[0].yvel = start.dragon.yvel;
+    s->layers[0].nodes[0].frame = start.dragon.frame;
+    s->layers[0].nodes[0].counter = start.dragon.counter;
+    s->layers[0].nodes[0].parent = -1;
+    s->layers[0].nodes[0].flap = 0;
+    s->layers[0].count = 1;
+    s->frames = 1;
+    s->states = 1;
+
+    while (s->frames <= laps) {
+        struct Layer* from = &s->layers[s->frames - 1];
+        memset((void*) s->seen, 0, SEEN_BITS / 8);
+
+        /* split the frontier into a few chunks per thread */
+        s->chunks = threads == 1 ? 1 : threads * 4;
+        if (s->chunks > from->count) {
+            s->chunks = from->count;
+        }
+        s->chunk_size = (from->count + s->chunks - 1) / s->chunks;
+        s->out = malloc(sizeof(struct Node*) * s->chunks);
+        s->out_count = calloc(s->chunks, sizeof(int));
+        for (int c = 0; c < s->chunks; c++) {
+            s->out[c] = malloc(sizeof(struct Node) * 2 * s->chunk_size);
+        }
+
+        if (threads == 1) {
+            for (int c = 0; c < s->chunks; c++) {
+                expand_chunk(s, c, 0);
+            }
+        } else {
+            pool_run(pool, threads, s->chunks, expand_chunk, s);
+        }
+
+        /* gather the chunks into the next layer */
+        struct Layer* to = &s->layers[s->frames];
+        for (int c = 0; c < s->chunks; c++) {
+            to->count += s->out_count[c];
+        }
+        to->nodes = malloc(sizeof(struct Node) * (to->count + 1));
+        int n = 0;
+        for (int c = 0; c < s->chunks; c++) {
+            memcpy(to->nodes + n, s->out[c], sizeof(struct Node) * s->out_count[c]);
+            n += s->out_count[c];
+            free(s->out[c]);
+        }
+        free(s->out);
+        free(s->out_count);
+
+        s->states += to->count;
+        if (to->count == 0) {
+            /* report the column the dragon's nose was going into */
+            int xscroll = 1 + s->frames;
+            s->blocked_column = ((DRAGON_X + DRAGON_SIZE + xscroll) >> 3) % map->width;
+            return;
+        }
+        s->frames++;
+    }
+    s->passable = 1;
+}
+
+static void search_free(struct Search* s) {
+    for (int i = 0; i < s->frames + 1; i++) {
+        free(s->layers[i].nodes);
+    }
+    free(s->layers);
+    free((void*) s->seen);
+}
+
+/* write out the flaps of a path through the map as a replay */
+static int save_witness(struct Search* s, const char* path) {
+    struct Replay replay;
+    int frames = s->frames - 1;
+    replay_new(&replay, frames, 0);
+
+    int index = 0;
+    for (int f = frames; f > 0; f--) {
+        struct Node* n = &s->layers[f].nodes[index];
+        replay.keys[f - 1] = n->flap ? BUTTON_A : 0;
+        index = n->parent;
+    }
+
+    /* fill in the goldens the way the farm would */
+    struct Game game;
+    game_init(&game, s->map);
+    unsigned int f;
+    for (f = 0; f < (unsigned int) frames; f++) {
+        if (!game_step(&game, replay.keys[f])) {
+            f++;
+            break;
+        }
+    }
+    replay.header.end_frame = f;
+    replay.header.end_hash = game_hash(&game);
+    replay.header.end_total = game.score.total;
+    replay.header.end_alive = game.dragon.alive;
+    int result = replay_save(&replay, path);
+    replay_free(&replay);
+    return result;
+}
+
+/* a batch of generated maps, one per job */
+struct Batch {
+    unsigned int seed;
+    int offscreen;
+    int* passable;
+    int* blocked;
+    long long* states;
+};
+
+static void batch_job(void* arg, int index, int worker) {
+    struct Batch* b = arg;
+    struct Tilemap map;
+    struct Search s;
+    (void) worker;
+    generate_map(b->seed + index, &map);
+    search(&s, &map, 1, b->offscreen, NULL);
+    b->passable[index] = s.passable;
+    b->blocked[index] = s.blocked_column;
+    b->states[index] = s.states;
+    search_free(&s);
+    free((void*) map.tiles);
+}
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv) {
+    int threads = pool_cores();
+    int offscreen = 0;
+    int seeded = 0;
+    unsigned int seed = 0;
+    int count = 1;
+    const char* witness = NULL;
+    const char* path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            witness = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seeded = 1;
+            seed = (unsigned int) strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--offscreen") == 0) {
+            offscreen = 1;
+        } else if (argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "usage: reachcheck [-j N] [-o witness.rpl] [--offscreen] "
+                    "[map.h | --seed S [--count N]]\n");
+            return 2;
+        }
+    }
+
+    struct Pool* pool = calloc(1, sizeof(struct Pool));
+    double start = now_seconds();
+
+    if (seeded && count > 1) {
+        struct Batch b;
+        b.seed = seed;
+        b.offscreen = offscreen;
+        b.passable = calloc(count, sizeof(int));
+        b.blocked = calloc(count, sizeof(int));
+        b.states = calloc(count, sizeof(long long));
+        pool_run(pool, threads, count, batch_job, &b);
+
+        int blocked = 0;
+        long long states = 0;
+        for (int i = 0; i < count; i++) {
+            states += b.states[i];
+            if (!b.passable[i]) {
+                blocked++;
+                printf("seed %u: blocked at column %d\n", seed + i, b.blocked[i]);
+            }
+        }
+        double seconds = now_seconds() - start;
+        printf("%d maps, %d passable, %d blocked, %lld states in %.3f s on %d threads "
+                "(%.0f states/s)\n", count, count - blocked, blocked, states, seconds,
+                pool->threads, states / seconds);
+        return blocked ? 1 : 0;
+    }
+
+    struct Tilemap map = ground_tilemap;
+    if (seeded) {
+        generate_map(seed, &map);
+    } else if (path && load_map(path, &map) != 0) {
+        fprintf(stderr, "reachcheck: cannot read map %s\n", path);
+        return 2;
+    }
+
+    struct Search s;
+    search(&s, &map, threads, offscreen, pool);
+    double seconds = now_seconds() - start;
+    if (s.passable) {
+        printf("passable: %d frames, %lld states in %.3f s on %d threads\n",
+                s.frames - 1, s.states, seconds, threads);
+        if (witness && save_witness(&s, witness) != 0) {
+            fprintf(stderr, "reachcheck: cannot write %s\n", witness);
+            return 2;
+        }
+    } else {
+        printf("blocked at column %d after %d frames, %lld states in %.3f s on %d threads\n",
+                s.blocked_column, s.frames, s.states, seconds, threads);
+    }
+    search_free(&s);
+    return s.passable ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+/* replay.h
+ * input replays for the host tools.
+ *
+ * a replay file is a ReplayHeader, then one unsigned short of held buttons
+ * (BUTTON_ bits) per frame, then, if REPLAY_FRAME_HASHES is set, one
+ * game_hash() per frame. everything is little endian. the golden values in
+ * the header are filled in by "replayfarm bless" */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAGIC "PHRP"
+#define REPLAY_VERSION 1
+
+/* flag set when the file carries a hash for every frame */
+#define REPLAY_FRAME_HASHES 0x1
+
+struct ReplayHeader {
+    char magic[4];
+    unsigned int version;
+    unsigned int flags;
+
+    /* the number of frames of input */
+    unsigned int frames;
+
+    /* golden values: the frame the run ended on, the final game_hash() and
+     * the final score */
+    unsigned int end_frame;
+    unsigned int end_hash;
+    int end_total;
+    int end_alive;
+};
+
+/* a replay loaded into memory */
+struct Replay {
+    char path[256];
+    struct ReplayHeader header;
+    unsigned short* keys;
+    unsigned int* hashes;
+};
+
+/* load a replay, returns 0 on success */
+static inline int replay_load(struct Replay* replay, const char* path) {
+    memset(replay, 0, sizeof(*replay));
+    snprintf(replay->path, sizeof(replay->path), "%s", path);
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return -1;
+    }
+    struct ReplayHeader* h = &replay->header;
+    if (fread(h, sizeof(*h), 1, f) != 1 || memcmp(h->magic, REPLAY_MAGIC, 4) != 0 ||
+            h->version != REPLAY_VERSION) {
+        fclose(f);
+        return -1;
+    }
+
+    replay->keys = malloc(sizeof(unsigned short) * (h->frames + 1));
+    replay->hashes = malloc(sizeof(unsigned int) * (h->frames + 1));
+    int ok = fread(replay->keys, sizeof(unsigned short), h->frames, f) == h->frames;
+    if (ok && (h->flags & REPLAY_FRAME_HASHES)) {
+        ok = fread(replay->hashes, sizeof(unsigned int), h->frames, f) == h->frames;
+    }
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+/* write a replay back out, returns 0 on success */
+static inline int replay_save(const struct Replay* replay, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        return -1;
+    }
+    const struct ReplayHeader* h = &replay->header;
+    int ok = fwrite(h, sizeof(*h), 1, f) == 1 &&
+        fwrite(replay->keys, sizeof(unsigned short), h->frames, f) == h->frames;
+    if (ok && (h->flags & REPLAY_FRAME_HASHES)) {
+        ok = fwrite(replay->hashes, sizeof(unsigned int), h->frames, f) == h->frames;
+    }
+    return (fclose(f) == 0 && ok) ? 0 : -1;
+}
+
+/* start an empty replay of the given length */
+static inline void replay_new(struct Replay* replay, unsigned int frames, unsigned int flags) {
+    memset(replay, 0, sizeof(*replay));
+    memcpy(replay->header.magic, REPLAY_MAGIC, 4);
+    replay->header.version = REPLAY_VERSION;
+    replay->header.flags = flags;
+    replay->header.frames = frames;
+    replay->keys = calloc(frames + 1, sizeof(unsigned short));
+    replay->hashes = calloc(frames + 1, sizeof(unsigned int));
+}
+
+static inline void replay_free(struct Replay* replay) {
+    free(replay->keys);
+    free(replay->hashes);
+    replay->keys = NULL;
+    replay->hashes = NULL;
+}
+
+static inline int replay_path_order(const void* a, const void* b) {
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
+
+/* collect replay paths from files and directories on the command line:
+ * files are taken as they are, in the order given, directories for the
+ * .rpl files in them, sorted by name. readdir() hands them back in
+ * whatever order the filesystem keeps, and a corpus numbers its entries,
+ * and the farm and the fuzzer go through them, in the order they come */
+static inline int replay_collect(char** args, int nargs, char*** paths_out) {
+    int count = 0, cap = 64;
+    char** paths = malloc(sizeof(char*) * cap);
+    for (int i = 0; i < nargs; i++) {
+        DIR* dir = opendir(args[i]);
+        if (!dir) {
+            if (count == cap) {
+                paths = realloc(paths, sizeof(char*) * (cap *= 2));
+            }
+            paths[count++] = strdup(args[i]);
+            continue;
+        }
+        struct dirent* e;
+        int first = count;
+        while ((e = readdir(dir))) {
+            size_t n = strlen(e->d_name);
+            if (n < 4 || strcmp(e->d_name + n - 4, ".rpl") != 0) {
+                continue;
+            }
+            if (count == cap) {
+                paths = realloc(paths, sizeof(char*) * (cap *= 2));
+            }
+            paths[count] = malloc(strlen(args[i]) + n + 2);
+            sprintf(paths[count++], "%s/%s", args[i], e->d_name);
+        }
+        closedir(dir);
+        qsort(paths + first, count - first, sizeof(char*), replay_path_order);
+    }
+    *paths_out = paths;
+    return count;
+}
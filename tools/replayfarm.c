@@ -0,0 +1,416 @@
+/* replayfarm.c
+ * reruns a corpus of recorded input replays through the headless game logic
+ * and checks every run still ends exactly where its golden values say.
+ * the replays are files of their own, or packed into corpus files made by
+ * the corpus tool, which verify reads in place.
+ *
+ *   gcc -O2 -pthread -o replayfarm tools/replayfarm.c
+ *
+ *   replayfarm gen <dir> <count> [seed] [frames]   make a corpus flown by the autopilot
+ *   replayfarm bless <replay|dir>...                rewrite the golden values
+ *   replayfarm verify [-j N] [--scale] [--final-only] <replay|dir|corpus>...
+ *
+ * verify runs the replays on a work-stealing pool of N threads (all cores by
+ * default) and reports frames per second and frames per second per core.
+ * with --scale it repeats the run at 1, 2, 4 ... N threads to show how it
+ * scales. it exits non-zero if any replay no longer matches */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../autopilot.h"
+
+#include <time.h>
+
+#include "pool.h"
+#include "replay.h"
+#include "corpus.h"
+
+/* the outcome of running one replay */
+struct RunResult {
+    unsigned int end_frame;
+    unsigned int end_hash;
+    int end_total;
+    int end_alive;
+
+    /* first frame whose hash disagreed with the golden one, or -1 */
+    int first_bad_frame;
+};
+
+/* one replay for the farm: loaded from a file of its own, or read in
+ * place from a corpus */
+struct Run {
+    struct Replay* replay;
+    struct CorpusReplay packed;
+
+    /* the corpus it is in and where, for the messages */
+    const char* corpus;
+    unsigned int entry;
+};
+
+struct Farm {
+    struct Run* runs;
+    struct RunResult* results;
+    int count;
+
+    /* the replays loaded and the corpora mapped */
+    struct Replay* replays;
+    int replay_count;
+    struct Corpus* corpora;
+    int corpus_count;
+
+    /* whether per frame hashes are checked (when the replay has them) */
+    int check_frames;
+
+    /* whether per frame hashes are recorded into the replay (bless) */
+    int record_frames;
+};
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* a run's length, keys and frame hashes, wherever it is kept */
+static unsigned int run_frames(const struct Run* run) {
+    return run->replay ? run->replay->header.frames : run->packed.record->frames;
+}
+static unsigned short run_keys(const struct Run* run, unsigned int f) {
+    return run->replay ? run->replay->keys[f] : corpus_keys(&run->packed, f);
+}
+static const unsigned int* run_hashes(const struct Run* run) {
+    if (run->replay) {
+        return run->replay->header.flags & REPLAY_FRAME_HASHES ? run->replay->hashes : NULL;
+    }
+    return run->packed.hashes;
+}
+
+/* the golden values a run should end on */
+static void run_goldens(const struct Run* run, struct RunResult* golden) {
+    if (run->replay) {
+        const struct ReplayHeader* h = &run->replay->header;
+        *golden = (struct RunResult) {h->end_frame, h->end_hash, h->end_total, h->end_alive, -1};
+    } else {
+        const struct CorpusRecord* r = run->packed.record;
+        *golden = (struct RunResult) {r->end_frame, r->end_hash, r->end_total, r->end_alive, -1};
+    }
+}
+
+/* what to call a run in the messages */
+static void run_name(const struct Run* run, char* name, size_t size) {
+    if (run->replay) {
+        snprintf(name, size, "%s", run->replay->path);
+    } else {
+        snprintf(name, size, "%s:%u", run->corpus, run->entry);
+    }
+}
+
+/* run one replay through the game, checking or recording frame hashes.
+ * only a replay loaded from its own file can have them recorded */
+static void run_replay(const struct Run* run, struct RunResult* result,
+        int check_frames, int record_frames) {
+    struct Game game;
+    game_init(&game, &ground_tilemap);
+
+    const unsigned int* hashes = run_hashes(run);
+    unsigned int frames = run_frames(run);
+    result->first_bad_frame = -1;
+
+    unsigned int f;
+    for (f = 0; f < frames; f++) {
+        int alive = game_step(&game, run_keys(run, f));
+        if (record_frames) {
+            run->replay->hashes[f] = game_hash(&game);
+        } else if (check_frames && hashes && result->first_bad_frame < 0 &&
+                game_hash(&game) != hashes[f]) {
+            result->first_bad_frame = (int) f;
+        }
+        if (!alive) {
+            f++;
+            break;
+        }
+    }
+
+    result->end_frame = f;
+    result->end_hash = game_hash(&game);
+    result->end_total = game.score.total;
+    result->end_alive = game.dragon.alive;
+}
+
+static void farm_job(void* arg, int index, int worker) {
+    struct Farm* farm = arg;
+    (void) worker;
+    run_replay(&farm->runs[index], &farm->results[index],
+            farm->check_frames, farm->record_frames);
+}
+
+/* does this result match the goldens */
+static int result_matches(const struct RunResult* golden, const struct RunResult* r) {
+    return r->first_bad_frame < 0 && r->end_frame == golden->end_frame &&
+        r->end_hash == golden->end_hash && r->end_total == golden->end_total &&
+        r->end_alive == golden->end_alive;
+}
+
+/* load every replay named on the command line into a farm, mapping the
+ * corpora among them */
+static int farm_load(struct Farm* farm, char** args, int nargs) {
+    char** paths;
+    int count = replay_collect(args, nargs, &paths);
+    memset(farm, 0, sizeof(*farm));
+    farm->replays = calloc(count + 1, sizeof(struct Replay));
+    farm->corpora = calloc(count + 1, sizeof(struct Corpus));
+    char** corpus_paths = calloc(count + 1, sizeof(char*));
+    int runs = 0;
+    for (int i = 0; i < count; i++) {
+        if (corpus_sniff(paths[i])) {
+            struct Corpus* corpus = &farm->corpora[farm->corpus_count];
+            if (corpus_open(corpus, paths[i]) != 0) {
+                fprintf(stderr, "replayfarm: cannot map corpus %s\n", paths[i]);
+                return -1;
+            }
+            corpus_paths[farm->corpus_count++] = paths[i];
+            runs += corpus->count;
+            continue;
+        }
+        if (replay_load(&farm->replays[farm->replay_count], paths[i]) != 0) {
+            fprintf(stderr, "replayfarm: cannot load %s\n", paths[i]);
+            free(paths[i]);
+            return -1;
+        }
+        farm->replay_count++;
+        runs++;
+        free(paths[i]);
+    }
+    free(paths);
+
+    /* the replays from files, then every replay in each corpus */
+    farm->runs = calloc(runs + 1, sizeof(struct Run));
+    farm->results = calloc(runs + 1, sizeof(struct RunResult));
+    for (int i = 0; i < farm->replay_count; i++) {
+        farm->runs[farm->count++].replay = &farm->replays[i];
+    }
+    for (int c = 0; c < farm->corpus_count; c++) {
+        for (unsigned int e = 0; e < farm->corpora[c].count; e++) {
+            struct Run* run = &farm->runs[farm->count++];
+            run->corpus = corpus_paths[c];
+            run->entry = e;
+            if (corpus_get(&farm->corpora[c], e, &run->packed) != 0) {
+                fprintf(stderr, "replayfarm: replay %u of %s runs past the end\n", e, corpus_paths[c]);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* the runs are flown by the autopilot, so they last and go through the
+ * laps, the entities and the map wrapping round. each run slips now and
+ * then, flapping when the autopilot would not, some runs more often than
+ * others, so the runs differ and some of them end in a crash. the search
+ * has no node limit, as the host has the time */
+
+static unsigned int xorshift(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static int cmd_gen(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: replayfarm gen <dir> <count> [seed] [frames]\n");
+        return 2;
+    }
+    const char* dir = argv[2];
+    int count = atoi(argv[3]);
+    unsigned int seed = argc > 4 ? (unsigned int) strtoul(argv[4], NULL, 0) : 1;
+    unsigned int frames = argc > 5 ? (unsigned int) atoi(argv[5]) : 3600;
+
+    struct Autopilot* ap = malloc(sizeof(struct Autopilot));
+    int survived = 0;
+    for (int i = 0; i < count; i++) {
+        unsigned int rng = seed * 2654435761u + i * 40503u + 1;
+        struct Replay replay;
+        replay_new(&replay, frames, REPLAY_FRAME_HASHES);
+
+        struct Game game;
+        game_init(&game, &ground_tilemap);
+        autopilot_init(ap, 0);
+        unsigned int slip_every = 512u << (xorshift(&rng) % 5);
+        for (unsigned int f = 0; f < frames; f++) {
+            unsigned short keys = 0;
+            if (game.dragon.alive &&
+                    (autopilot_decide(ap, &game) || xorshift(&rng) % slip_every == 0)) {
+                keys |= BUTTON_A;
+            }
+            replay.keys[f] = keys;
+            game_step(&game, keys);
+        }
+        survived += game.dragon.alive;
+
+        struct RunResult r;
+        struct Run run = {.replay = &replay};
+        run_replay(&run, &r, 0, 1);
+        replay.header.end_frame = r.end_frame;
+        replay.header.end_hash = r.end_hash;
+        replay.header.end_total = r.end_total;
+        replay.header.end_alive = r.end_alive;
+
+        char path[512];
+        snprintf(path, sizeof(path), "%s/run%05d.rpl", dir, i);
+        if (replay_save(&replay, path) != 0) {
+            fprintf(stderr, "replayfarm: cannot write %s\n", path);
+            return 1;
+        }
+        replay_free(&replay);
+    }
+    free(ap);
+    printf("wrote %d replays to %s, %d still flying at the end\n", count, dir, survived);
+    return 0;
+}
+
+static int cmd_bless(int argc, char** argv) {
+    struct Farm farm;
+    if (farm_load(&farm, argv + 2, argc - 2) != 0) {
+        return 1;
+    }
+    if (farm.corpus_count) {
+        fprintf(stderr, "replayfarm: corpora are read only, bless the replays before packing them\n");
+        return 2;
+    }
+    farm.record_frames = 1;
+    struct Pool* pool = calloc(1, sizeof(struct Pool));
+    pool_run(pool, pool_cores(), farm.count, farm_job, &farm);
+
+    for (int i = 0; i < farm.count; i++) {
+        struct Replay* replay = farm.runs[i].replay;
+        struct RunResult* r = &farm.results[i];
+        replay->header.flags |= REPLAY_FRAME_HASHES;
+        replay->header.end_frame = r->end_frame;
+        replay->header.end_hash = r->end_hash;
+        replay->header.end_total = r->end_total;
+        replay->header.end_alive = r->end_alive;
+        if (replay_save(replay, replay->path) != 0) {
+            fprintf(stderr, "replayfarm: cannot write %s\n", replay->path);
+            return 1;
+        }
+    }
+    printf("blessed %d replays\n", farm.count);
+    return 0;
+}
+
+/* run the whole corpus once on the given number of threads, returns the
+ * number of frames simulated and the wall time it took */
+static unsigned long long farm_pass(struct Farm* farm, struct Pool* pool,
+        int threads, double* seconds) {
+    double start = now_seconds();
+    pool_run(pool, threads, farm->count, farm_job, farm);
+    *seconds = now_seconds() - start;
+
+    unsigned long long frames = 0;
+    for (int i = 0; i < farm->count; i++) {
+        frames += farm->results[i].end_frame;
+    }
+    return frames;
+}
+
+static int cmd_verify(int argc, char** argv) {
+    int threads = pool_cores();
+    int scale = 0;
+    int check_frames = 1;
+    int first = 2;
+    for (; first < argc && argv[first][0] == '-'; first++) {
+        if (strcmp(argv[first], "-j") == 0 && first + 1 < argc) {
+            threads = atoi(argv[++first]);
+        } else if (strcmp(argv[first], "--scale") == 0) {
+            scale = 1;
+        } else if (strcmp(argv[first], "--final-only") == 0) {
+            check_frames = 0;
+        } else {
+            fprintf(stderr, "replayfarm: unknown option %s\n", argv[first]);
+            return 2;
+        }
+    }
+
+    struct Farm farm;
+    if (farm_load(&farm, argv + first, argc - first) != 0) {
+        return 1;
+    }
+    if (farm.count == 0) {
+        fprintf(stderr, "replayfarm: no replays given\n");
+        return 2;
+    }
+    farm.check_frames = check_frames;
+
+    struct Pool* pool = calloc(1, sizeof(struct Pool));
+    double seconds;
+    unsigned long long frames = farm_pass(&farm, pool, threads, &seconds);
+
+    int failures = 0;
+    for (int i = 0; i < farm.count; i++) {
+        struct RunResult golden;
+        struct RunResult* r = &farm.results[i];
+        run_goldens(&farm.runs[i], &golden);
+        if (result_matches(&golden, r)) {
+            continue;
+        }
+        failures++;
+        char name[300];
+        run_name(&farm.runs[i], name, sizeof(name));
+        printf("FAIL %s: ended frame %u hash %08x score %d alive %d, "
+                "expected frame %u hash %08x score %d alive %d",
+                name, r->end_frame, r->end_hash, r->end_total, r->end_alive,
+                golden.end_frame, golden.end_hash, golden.end_total, golden.end_alive);
+        if (r->first_bad_frame >= 0) {
+            printf(", first diverged at frame %d", r->first_bad_frame);
+        }
+        printf("\n");
+    }
+
+    int steals = 0;
+    for (int i = 0; i < pool->threads; i++) {
+        steals += pool->workers[i].steals;
+    }
+    printf("%d replays, %d failed, %llu frames in %.3f s on %d threads (%d steals)\n",
+            farm.count, failures, frames, seconds, pool->threads, steals);
+    printf("%.0f frames/s, %.0f frames/s/core\n",
+            frames / seconds, frames / seconds / pool->threads);
+
+    if (scale) {
+        printf("\nthreads  frames/s      frames/s/core  speedup  efficiency\n");
+        double base = 0;
+        for (int t = 1;; t *= 2) {
+            if (t > threads) {
+                t = threads;
+            }
+            frames = farm_pass(&farm, pool, t, &seconds);
+            double fps = frames / seconds;
+            if (t == 1) {
+                base = fps;
+            }
+            printf("%7d  %12.0f  %13.0f  %7.2f  %9.0f%%\n", t, fps, fps / t,
+                    fps / base, 100.0 * fps / base / t);
+            if (t == threads) {
+                break;
+            }
+        }
+    }
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "gen") == 0) {
+        return cmd_gen(argc, argv);
+    }
+    if (argc >= 3 && strcmp(argv[1], "bless") == 0) {
+        return cmd_bless(argc, argv);
+    }
+    if (argc >= 3 && strcmp(argv[1], "verify") == 0) {
+        return cmd_verify(argc, argv);
+    }
+    fprintf(stderr, "usage: replayfarm gen <dir> <count> [seed] [frames]\n"
+            "       replayfarm bless <replay|dir>...\n"
+            "       replayfarm verify [-j N] [--scale] [--final-only] <replay|dir|corpus>...\n");
+    return 2;
+}
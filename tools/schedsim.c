@@ -0,0 +1,188 @@
+/* schedsim.c
+ * runs the frame scheduler against a pretend cycle counter, with tasks
+ * shaped like the ROM's, and checks it keeps to its rules.
+ *
+ *   gcc -O2 -o schedsim tools/schedsim.c
+ *
+ *   schedsim [frames] [seed]
+ *
+ * each task moves the counter on by what it costs. the game task usually
+ * takes a fifth of a frame but now and then most of one, and the video task
+ * now and then runs past the end of vblank. a background job of 40 slices
+ * is woken every 30 frames. vblank comes every 280896 cycles, and a frame
+ * whose tasks run past it waits for the one after, as the GBA would.
+ *
+ * the phases have to run in order, highest priority first, a background
+ * slice may only start when the slowest that task has taken fits before
+ * the margin, and the misses counted have to match the runs that really
+ * ended late. it runs for the given number of frames (3600 by default) and
+ * prints how the frames went and how long jobs took to get through */
+
+#define PHLAPU_HOST
+#include "../scheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* the pretend counter */
+static unsigned int now;
+static unsigned int clock_now() {
+    return now;
+}
+
+static struct Scheduler scheduler;
+
+/* runs in the order they happened this frame */
+static int ran[64];
+static int ran_count;
+
+/* whether this lot of runs went phase by phase, highest priority first,
+ * with at least the given number of them */
+static int in_order(int frame, int least) {
+    for (int i = 1; i < ran_count; i++) {
+        const struct Task* a = &scheduler.tasks[ran[i - 1]];
+        const struct Task* b = &scheduler.tasks[ran[i]];
+        if (a->phase > b->phase || (a->phase == b->phase && a != b && a->priority < b->priority)) {
+            fprintf(stderr, "schedsim: %s ran before %s on frame %d\n", a->name, b->name, frame);
+            return 0;
+        }
+    }
+    if (ran_count < least) {
+        fprintf(stderr, "schedsim: only %d tasks ran on frame %d\n", ran_count, frame);
+        return 0;
+    }
+    return 1;
+}
+
+/* a random number between 0 and n - 1 */
+static unsigned int seed;
+static unsigned int random_below(unsigned int n) {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % n;
+}
+
+/* the work each task does */
+struct Work {
+    int id;
+    unsigned int cost;
+    unsigned int spike;
+    unsigned int spike_in;
+};
+
+static unsigned int late_runs;
+
+static int run_work(void* data) {
+    struct Work* work = data;
+    ran[ran_count++] = work->id;
+    now += work->cost;
+    if (work->spike && random_below(work->spike_in) == 0) {
+        now += work->spike;
+    }
+    if (now - scheduler.vblank_start > scheduler.tasks[work->id].deadline) {
+        late_runs++;
+    }
+    return 0;
+}
+
+/* the background job */
+static int job_slices_left;
+static unsigned int bad_slices;
+static int slice(void* data) {
+    struct Work* work = data;
+    const struct Task* task = &scheduler.tasks[work->id];
+    unsigned int limit = SCHEDULER_FRAME_CYCLES - scheduler.margin;
+    if (task->runs > 0 && now - scheduler.vblank_start + task->worst > limit) {
+        bad_slices++;
+    }
+    ran[ran_count++] = work->id;
+    now += work->cost + random_below(work->cost / 2);
+    if (now - scheduler.vblank_start > task->deadline) {
+        late_runs++;
+    }
+    return --job_slices_left > 0;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 3600;
+    seed = argc > 2 ? (unsigned int) atoi(argv[2]) : 1;
+    if (frames <= 0) {
+        fprintf(stderr, "usage: schedsim [frames] [seed]\n");
+        return 2;
+    }
+
+    static struct Work work[] = {
+        {0, 6000, 90000, 50},      /* video */
+        {0, 1500, 0, 1},           /* input */
+        {0, 56000, 180000, 40},    /* game */
+        {0, 9000, 0, 1},           /* sprites */
+        {0, 4000, 0, 1},           /* effects */
+        {0, 11000, 0, 1},          /* background job */
+    };
+    scheduler_init(&scheduler, clock_now);
+    work[0].id = scheduler_add(&scheduler, "video", TASK_VBLANK, 1, 0, run_work, &work[0]);
+    work[1].id = scheduler_add(&scheduler, "input", TASK_VBLANK, 0, 0, run_work, &work[1]);
+    work[5].id = scheduler_add(&scheduler, "job", TASK_BACKGROUND, 0, 0, slice, &work[5]);
+    work[4].id = scheduler_add(&scheduler, "effects", TASK_FRAME, 0, 0, run_work, &work[4]);
+    work[2].id = scheduler_add(&scheduler, "game", TASK_FRAME, 2, 0, run_work, &work[2]);
+    work[3].id = scheduler_add(&scheduler, "sprites", TASK_FRAME, 1, 0, run_work, &work[3]);
+
+    unsigned int next_vblank = SCHEDULER_FRAME_CYCLES;
+    int dropped = 0, jobs = 0, jobs_done = 0, job_started = 0;
+    long long job_frames = 0, idle = 0;
+    for (int f = 0; f < frames; f++) {
+        if (f % 30 == 0 && job_slices_left == 0) {
+            job_slices_left = 40;
+            job_started = f;
+            jobs++;
+            scheduler_wake(&scheduler, work[5].id);
+        }
+
+        ran_count = 0;
+        scheduler_frame(&scheduler);
+        if (!in_order(f, 3)) {
+            return 1;
+        }
+        idle += scheduler.idle;
+        if (job_slices_left == 0 && !scheduler.tasks[work[5].id].pending && job_started >= 0) {
+            job_frames += f - job_started + 1;
+            jobs_done++;
+            job_started = -1;
+        }
+
+        /* wait for vblank, or the one after if this frame ran into it */
+        while (now > next_vblank) {
+            next_vblank += SCHEDULER_FRAME_CYCLES;
+            dropped++;
+        }
+        now = next_vblank;
+        next_vblank += SCHEDULER_FRAME_CYCLES;
+        ran_count = 0;
+        scheduler_vblank(&scheduler);
+
+        if (!in_order(f, 2)) {
+            return 1;
+        }
+    }
+
+    if (bad_slices) {
+        fprintf(stderr, "schedsim: %u background slices started with no room\n", bad_slices);
+        return 1;
+    }
+    if (late_runs != scheduler.misses) {
+        fprintf(stderr, "schedsim: %u runs were late but %u misses were counted\n",
+                late_runs, scheduler.misses);
+        return 1;
+    }
+
+    printf("%d frames, %d vblanks missed, %u deadline misses, %u frames deferred background work\n",
+            frames, dropped, scheduler.misses, scheduler.deferred);
+    printf("idle %.0f cycles a frame on average\n\n", (double) idle / frames);
+    printf("task     phase  runs   worst  deadline  misses\n");
+    for (int i = 0; i < scheduler.count; i++) {
+        const struct Task* t = &scheduler.tasks[scheduler.order[i]];
+        printf("%-8s %5d %5u %7u %9u %7u\n", t->name, t->phase, t->runs, t->worst, t->deadline, t->misses);
+    }
+    printf("\n%d jobs of 40 slices, %d finished, %.2f frames each\n", jobs, jobs_done,
+            jobs_done ? (double) job_frames / jobs_done : 0);
+    return 0;
+}
@@ -0,0 +1,89 @@
+/* snapbench.c
+ * measures what it costs to save, restore and hash the game state, next to
+ * what one game_step() costs, so search and rollback code can tell how many
+ * snapshots a frame can afford.
+ *
+ *   gcc -O2 -o snapbench tools/snapbench.c
+ *
+ *   snapbench [iterations]
+ *
+ * the game is stepped a few frames first so the state is not all zeroes, then
+ * each operation is run the given number of times (1000000 by default) and
+ * the mean time for one is printed */
+
+#define PHLAPU_HOST
+#include "../game.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* keeps results alive so the loops are not optimised away */
+static volatile unsigned int sink;
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (iterations <= 0) {
+        fprintf(stderr, "usage: snapbench [iterations]\n");
+        return 2;
+    }
+
+    static struct Game game, snapshot;
+    game_init(&game, &ground_tilemap);
+    for (int i = 0; i < 8; i++) {
+        game_step(&game, 0);
+    }
+
+    printf("struct Game is %d bytes, %d of them hashed, version %d\n\n",
+            (int) sizeof(struct Game), (int) GAME_HASHED_WORDS * 4, GAME_STATE_VERSION);
+
+    double start = now_seconds();
+    for (int i = 0; i < iterations; i++) {
+        game_save(&snapshot, &game);
+        sink = snapshot.frames;
+    }
+    double save = (now_seconds() - start) / iterations;
+
+    start = now_seconds();
+    for (int i = 0; i < iterations; i++) {
+        snapshot.frames = i;
+        game_restore(&game, &snapshot);
+        sink = game.frames;
+    }
+    double restore = (now_seconds() - start) / iterations;
+
+    start = now_seconds();
+    for (int i = 0; i < iterations; i++) {
+        game.frames = i;
+        sink = game_hash(&game);
+    }
+    double hash = (now_seconds() - start) / iterations;
+
+    /* go back to the snapshot every few frames so the dragon never hits the
+     * ground, the restores are a small part of the time */
+    game_save(&snapshot, &game);
+    start = now_seconds();
+    for (int i = 0; i < iterations; i++) {
+        if ((i & 7) == 0) {
+            game_restore(&game, &snapshot);
+        }
+        sink = game_step(&game, 0);
+    }
+    double step = (now_seconds() - start) / iterations;
+    if (!game.dragon.alive) {
+        fprintf(stderr, "snapbench: the dragon died while stepping\n");
+        return 1;
+    }
+
+    printf("save     %8.1f ns\n", save * 1e9);
+    printf("restore  %8.1f ns\n", restore * 1e9);
+    printf("hash     %8.1f ns\n", hash * 1e9);
+    printf("step     %8.1f ns\n", step * 1e9);
+    return 0;
+}
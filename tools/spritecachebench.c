@@ -0,0 +1,104 @@
+/* spritecachebench.c
+ * runs the game with the autopilot flying and the sprites streamed through
+ * the sprite tile cache, and checks every shown sprite points at its frame.
+ *
+ *   gcc -O2 -o spritecachebench tools/spritecachebench.c
+ *
+ *   spritecachebench [frames]
+ *
+ * sprite VRAM is a host buffer and the vblank queue is copied with memcpy.
+ * after each frame's copies every shown 8x8 or 16x16 sprite has its tiles
+ * compared with the frame of the sheet the game meant. the game runs for
+ * the given number of frames (3600 by default, starting again when the
+ * dragon dies), then it prints the hit rate, the uploads per frame and the
+ * time the rewrite takes */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../autopilot.h"
+#include "../dmaqueue.h"
+#include "../spritecache.h"
+#include "../dragon.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* what the GBA does in vblank */
+static void flush(struct DmaQueue* queue) {
+    for (int i = 0; i < queue->count; i++) {
+        memcpy(queue->copies[i].dest, queue->copies[i].source, queue->copies[i].words * 4);
+    }
+    dma_queue_done(queue);
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 3600;
+    if (frames <= 0) {
+        fprintf(stderr, "usage: spritecachebench [frames]\n");
+        return 2;
+    }
+
+    static unsigned char vram[0x8000];
+    static struct Game game;
+    static struct Autopilot autopilot;
+    struct Sprite out[NUM_SPRITES];
+    struct SpriteCache cache;
+    struct DmaQueue queue;
+    sprite_cache_init(&cache, dragon_data, vram, 0);
+    dma_queue_init(&queue);
+    autopilot_init(&autopilot, 256);
+    game_init(&game, &ground_tilemap);
+
+    double spent = 0;
+    long long shown = 0, words = 0;
+    int deaths = 0;
+    for (int f = 0; f < frames; f++) {
+        if (!game.dragon.alive) {
+            game_init(&game, &ground_tilemap);
+            autopilot_init(&autopilot, 256);
+            deaths++;
+        }
+        game_step(&game, autopilot_decide(&autopilot, &game) ? BUTTON_A : 0);
+
+        double start = now_seconds();
+        sprite_cache_stream(&cache, &game.oam, out, &queue);
+        spent += now_seconds() - start;
+        words += queue.words;
+        flush(&queue);
+
+        /* every shown sprite has to show the frame the game asked for */
+        for (int i = 0; i < NUM_SPRITES; i++) {
+            const struct Sprite* sprite = &game.oam.sprites[i];
+            if (sprite_hidden(sprite) || sprite_hidden(&out[i])) {
+                continue;
+            }
+            int bytes = (sprite->attribute1 >> 14) ? 256 : 64;
+            const unsigned char* want = dragon_data + (sprite->attribute2 & 0x3ff) * 32;
+            const unsigned char* got = vram + (out[i].attribute2 & 0x3ff) * 32;
+            if (memcmp(want, got, bytes) != 0) {
+                fprintf(stderr, "spritecachebench: sprite %d on frame %d shows the wrong tiles\n", i, f);
+                return 1;
+            }
+            shown++;
+        }
+    }
+
+    unsigned int lookups = cache.hits + cache.misses;
+    printf("%d frames, %d deaths, %d slots of %d bytes\n\n", frames, deaths,
+            SPRITE_CACHE_SLOTS, SPRITE_SLOT_BYTES);
+    printf("sprites shown      %10.2f a frame\n", (double) shown / frames);
+    printf("hits               %10u (%.1f%%)\n", cache.hits, lookups ? 100.0 * cache.hits / lookups : 0);
+    printf("misses             %10u\n", cache.misses);
+    printf("overflows          %10u\n", cache.overflows);
+    printf("uploaded           %10.2f bytes a frame, worst %u\n", 4.0 * words / frames, queue.high * 4);
+    printf("rewrite            %10.1f ns a frame\n", 1e9 * spent / frames);
+    return cache.overflows != 0;
+}
@@ -0,0 +1,375 @@
+/* sweep.c
+ * runs the game under a grid of dragon physics and difficulty constants and
+ * prints how long the dragon lasts and how much he scores under each.
+ *
+ *   gcc -O2 -pthread -o sweep tools/sweep.c
+ *
+ *   sweep [-j N] [--maps N] [--seed S] [--frames N] [--budget N]
+ *         [-r replay|dir|corpus]... [-o runs.csv] [name=values]...
+ *
+ * the constants are the ones dragon_init() and flap() set up:
+ *
+ *   gravity    added to yvel every frame          (40)
+ *   impulse    taken off yvel by a flap           (1500)
+ *   lift       taken off y by a flap              (40)
+ *   border     how near the edge he walks         (40)
+ *   delay      frames between animation frames    (8)
+ *
+ * each is given as a list, 30,40,50, or a range with a step, 30:50:5, and
+ * left out it keeps its value in brackets; by default gravity and impulse
+ * are swept around theirs. every combination is a parameter set.
+ *
+ * under each set the autopilot flies the shipped map and a number of
+ * generated ones (16 by default) with the given node budget (1024 by
+ * default, 0 for no limit), or, with -r, the keys of each recorded replay
+ * are played into the shipped map as they were, from files or a corpus.
+ * a run lasts until the dragon dies or the frames run out (3600 by
+ * default). runs go across all cores on the work-stealing pool.
+ *
+ * for each set it prints the share of runs that lasted, the frames
+ * survived at the 10th, 50th and 90th percentile and on average, and the
+ * score's median, average and best. -o writes every run as a line of CSV.
+ * last it prints the frames simulated a second in all and a core */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../autopilot.h"
+
+#include <time.h>
+
+#include "maps.h"
+#include "pool.h"
+#include "replay.h"
+#include "corpus.h"
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* the constants swept, in the order the sets count through them */
+enum Param {
+    PARAM_GRAVITY,
+    PARAM_IMPULSE,
+    PARAM_LIFT,
+    PARAM_BORDER,
+    PARAM_DELAY,
+    PARAMS
+};
+
+static const char* param_names[PARAMS] = {"gravity", "impulse", "lift", "border", "delay"};
+
+/* the most values one constant can take */
+#define PARAM_VALUES 64
+
+struct Grid {
+    int values[PARAMS][PARAM_VALUES];
+    int counts[PARAMS];
+};
+
+/* one parameter set's constants */
+struct Tuning {
+    int values[PARAMS];
+};
+
+/* put a set's constants into a fresh dragon */
+static void tune(struct Dragon* dragon, const struct Tuning* t) {
+    dragon->gravity = t->values[PARAM_GRAVITY];
+    dragon->flap_impulse = t->values[PARAM_IMPULSE];
+    dragon->flap_lift = t->values[PARAM_LIFT];
+    dragon->border = t->values[PARAM_BORDER];
+    dragon->animation_delay = t->values[PARAM_DELAY];
+}
+
+/* read "a,b,c" or "from:to:step" into a constant's values */
+static int parse_values(const char* text, int* values) {
+    int from, to, step, count = 0;
+    if (sscanf(text, "%d:%d:%d", &from, &to, &step) == 3) {
+        if (step <= 0 || to < from) {
+            return 0;
+        }
+        for (int v = from; v <= to && count < PARAM_VALUES; v += step) {
+            values[count++] = v;
+        }
+        return count;
+    }
+    const char* p = text;
+    while (*p && count < PARAM_VALUES) {
+        char* end;
+        values[count++] = (int) strtol(p, &end, 0);
+        if (end == p || (*end && *end != ',')) {
+            return 0;
+        }
+        p = *end ? end + 1 : end;
+    }
+    return count;
+}
+
+/* one run: a set and a map or replay */
+struct Run {
+    int set;
+    int source;
+
+    /* results */
+    int frames;
+    int total;
+    int alive;
+};
+
+struct Sweep {
+    struct Tuning* sets;
+    struct Run* runs;
+    int sources;
+    int frames;
+    int budget;
+
+    /* maps for the autopilot, or the replays' keys */
+    struct Tilemap* maps;
+    struct Replay* replays;
+    struct CorpusReplay* packed;
+    int replay_count;
+};
+
+static void sweep_job(void* arg, int index, int worker) {
+    struct Sweep* s = arg;
+    struct Run* run = &s->runs[index];
+    struct Game game;
+    (void) worker;
+
+    int replaying = s->replays || s->packed;
+    game_init(&game, replaying ? &ground_tilemap : &s->maps[run->source]);
+    tune(&game.dragon, &s->sets[run->set]);
+
+    struct Autopilot* ap = NULL;
+    unsigned int keys_frames = 0;
+    if (!replaying) {
+        ap = malloc(sizeof(struct Autopilot));
+        autopilot_init(ap, s->budget);
+    } else if (run->source < s->replay_count) {
+        keys_frames = s->replays[run->source].header.frames;
+    } else {
+        keys_frames = s->packed[run->source - s->replay_count].record->frames;
+    }
+
+    for (run->frames = 0; run->frames < s->frames; run->frames++) {
+        unsigned short keys;
+        if (ap) {
+            keys = autopilot_decide(ap, &game) ? BUTTON_A : 0;
+        } else if ((unsigned int) run->frames >= keys_frames) {
+            keys = 0;
+        } else if (run->source < s->replay_count) {
+            keys = s->replays[run->source].keys[run->frames];
+        } else {
+            keys = corpus_keys(&s->packed[run->source - s->replay_count], run->frames);
+        }
+        if (!game_step(&game, keys)) {
+            run->frames++;
+            break;
+        }
+    }
+    run->total = game.score.total;
+    run->alive = game.dragon.alive;
+    free(ap);
+}
+
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*) a, y = *(const int*) b;
+    return (x > y) - (x < y);
+}
+
+/* the value a share p of the way up a sorted list */
+static int percentile(const int* sorted, int count, double p) {
+    int i = (int) (p * (count - 1) + 0.5);
+    return sorted[i];
+}
+
+/* load the replays named with -r, mapping the corpora among them */
+static int load_replays(struct Sweep* s, char** paths_in, int path_count) {
+    char** paths;
+    int count = replay_collect(paths_in, path_count, &paths);
+    s->replays = calloc(count + 1, sizeof(struct Replay));
+    int packed = 0, packed_cap = 0;
+    for (int i = 0; i < count; i++) {
+        if (corpus_sniff(paths[i])) {
+            struct Corpus* corpus = malloc(sizeof(struct Corpus));
+            if (corpus_open(corpus, paths[i]) != 0) {
+                fprintf(stderr, "sweep: cannot map corpus %s\n", paths[i]);
+                return -1;
+            }
+            s->packed = realloc(s->packed, sizeof(struct CorpusReplay) * (packed_cap += corpus->count));
+            for (unsigned int e = 0; e < corpus->count; e++) {
+                if (corpus_get(corpus, e, &s->packed[packed++]) != 0) {
+                    fprintf(stderr, "sweep: replay %u of %s runs past the end\n", e, paths[i]);
+                    return -1;
+                }
+            }
+        } else if (replay_load(&s->replays[s->replay_count++], paths[i]) != 0) {
+            fprintf(stderr, "sweep: cannot load %s\n", paths[i]);
+            return -1;
+        }
+        free(paths[i]);
+    }
+    free(paths);
+    s->sources = s->replay_count + packed;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int threads = pool_cores();
+    int map_count = 16;
+    unsigned int seed = 1;
+    const char* csv = NULL;
+    char* replay_paths[256];
+    int replay_path_count = 0;
+
+    struct Sweep s;
+    memset(&s, 0, sizeof(s));
+    s.frames = 3600;
+    s.budget = 1024;
+
+    static const int defaults[PARAMS] = {40, 1500, 40, 40, 8};
+    struct Grid grid;
+    memset(&grid, 0, sizeof(grid));
+    int usage = 0;
+    for (int i = 1; i < argc && !usage; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--maps") == 0 && i + 1 < argc) {
+            map_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int) strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            s.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            s.budget = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc && replay_path_count < 256) {
+            replay_paths[replay_path_count++] = argv[++i];
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            csv = argv[++i];
+        } else {
+            usage = 1;
+            for (int p = 0; p < PARAMS; p++) {
+                size_t n = strlen(param_names[p]);
+                if (strncmp(argv[i], param_names[p], n) == 0 && argv[i][n] == '=') {
+                    grid.counts[p] = parse_values(argv[i] + n + 1, grid.values[p]);
+                    usage = grid.counts[p] == 0;
+                }
+            }
+        }
+    }
+    if (usage || s.frames <= 0 || map_count < 0) {
+        fprintf(stderr, "usage: sweep [-j N] [--maps N] [--seed S] [--frames N] [--budget N]\n"
+                "             [-r replay|dir|corpus]... [-o runs.csv] [name=values]...\n"
+                "names: gravity impulse lift border delay, values: a,b,c or from:to:step\n");
+        return 2;
+    }
+
+    /* sweep gravity and impulse if nothing was named */
+    int named = 0;
+    for (int p = 0; p < PARAMS; p++) {
+        named += grid.counts[p] != 0;
+    }
+    if (!named) {
+        grid.counts[PARAM_GRAVITY] = parse_values("30:50:5", grid.values[PARAM_GRAVITY]);
+        grid.counts[PARAM_IMPULSE] = parse_values("1200:1800:150", grid.values[PARAM_IMPULSE]);
+    }
+    int set_count = 1;
+    for (int p = 0; p < PARAMS; p++) {
+        if (grid.counts[p] == 0) {
+            grid.values[p][0] = defaults[p];
+            grid.counts[p] = 1;
+        }
+        set_count *= grid.counts[p];
+    }
+
+    /* every combination, the last constant counting fastest */
+    s.sets = malloc(sizeof(struct Tuning) * set_count);
+    for (int i = 0; i < set_count; i++) {
+        int rest = i;
+        for (int p = PARAMS - 1; p >= 0; p--) {
+            s.sets[i].values[p] = grid.values[p][rest % grid.counts[p]];
+            rest /= grid.counts[p];
+        }
+    }
+
+    /* the shipped map then the generated ones, or the replays */
+    if (replay_path_count) {
+        if (load_replays(&s, replay_paths, replay_path_count) != 0) {
+            return 2;
+        }
+    } else {
+        s.sources = map_count + 1;
+        s.maps = malloc(sizeof(struct Tilemap) * s.sources);
+        s.maps[0] = ground_tilemap;
+        for (int i = 1; i < s.sources; i++) {
+            generate_map(seed + i - 1, &s.maps[i]);
+        }
+    }
+    if (s.sources == 0) {
+        fprintf(stderr, "sweep: no replays given\n");
+        return 2;
+    }
+
+    int count = set_count * s.sources;
+    s.runs = calloc(count, sizeof(struct Run));
+    for (int i = 0; i < count; i++) {
+        s.runs[i].set = i / s.sources;
+        s.runs[i].source = i % s.sources;
+    }
+
+    struct Pool* pool = calloc(1, sizeof(struct Pool));
+    double start = now_seconds();
+    pool_run(pool, threads, count, sweep_job, &s);
+    double seconds = now_seconds() - start;
+
+    printf("%d sets, %d %s each, up to %d frames, %d threads\n\n", set_count, s.sources,
+            replay_path_count ? "replays" : "maps", s.frames, pool->threads);
+    printf("gravity impulse lift border delay  lasted    p10    p50    p90   mean  "
+            "score p50   mean  best\n");
+    int* frames = malloc(sizeof(int) * s.sources);
+    int* totals = malloc(sizeof(int) * s.sources);
+    unsigned long long simulated = 0;
+    for (int set = 0; set < set_count; set++) {
+        int lasted = 0;
+        double frame_sum = 0, total_sum = 0;
+        for (int r = 0; r < s.sources; r++) {
+            const struct Run* run = &s.runs[set * s.sources + r];
+            frames[r] = run->frames;
+            totals[r] = run->total;
+            lasted += run->alive;
+            frame_sum += run->frames;
+            total_sum += run->total;
+        }
+        simulated += (unsigned long long) frame_sum;
+        qsort(frames, s.sources, sizeof(int), compare_ints);
+        qsort(totals, s.sources, sizeof(int), compare_ints);
+        const int* v = s.sets[set].values;
+        printf("%7d %7d %4d %6d %5d  %5.1f%% %6d %6d %6d %6.0f  %9d %6.1f %5d\n",
+                v[PARAM_GRAVITY], v[PARAM_IMPULSE], v[PARAM_LIFT], v[PARAM_BORDER], v[PARAM_DELAY],
+                100.0 * lasted / s.sources, percentile(frames, s.sources, 0.1),
+                percentile(frames, s.sources, 0.5), percentile(frames, s.sources, 0.9),
+                frame_sum / s.sources, percentile(totals, s.sources, 0.5), total_sum / s.sources,
+                totals[s.sources - 1]);
+    }
+    printf("\n%llu frames in %.3f s, %.0f frames/s, %.0f frames/s/core\n", simulated, seconds,
+            simulated / seconds, simulated / seconds / pool->threads);
+
+    if (csv) {
+        FILE* f = fopen(csv, "w");
+        if (!f) {
+            fprintf(stderr, "sweep: cannot write %s\n", csv);
+            return 2;
+        }
+        fprintf(f, "set,gravity,impulse,lift,border,delay,source,frames,score,alive\n");
+        for (int i = 0; i < count; i++) {
+            const struct Run* run = &s.runs[i];
+            const int* v = s.sets[run->set].values;
+            fprintf(f, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", run->set, v[PARAM_GRAVITY], v[PARAM_IMPULSE],
+                    v[PARAM_LIFT], v[PARAM_BORDER], v[PARAM_DELAY], run->source, run->frames,
+                    run->total, run->alive);
+        }
+        fclose(f);
+    }
+    return 0;
+}
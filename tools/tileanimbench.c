@@ -0,0 +1,115 @@
+/* tileanimbench.c
+ * runs the background tile animations the ROM sets up against a host copy
+ * of the char block, checks each tile holds the frame it should, and shows
+ * what they cost next to rewriting map entries instead.
+ *
+ *   gcc -O2 -o tileanimbench tools/tileanimbench.c
+ *
+ *   tileanimbench [frames]
+ *
+ * for each animated tile it counts the cells of the ground and back layer
+ * maps that use it. changing those cells' map entries every time the frame
+ * changes would be a scattered 2 byte write a cell, against one 64 byte
+ * copy for the tile however many cells there are. it then runs the
+ * animations for the given number of vblanks (3600 by default) and prints
+ * the writes and bytes each way */
+
+#define PHLAPU_HOST
+#include "../dmaqueue.h"
+#include "../tileanim.h"
+#include "../background.h"
+#include "../groundlayermap.h"
+#include "../layer0map.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the animations Phlapu.c sets up: tile, colours, both ways, delay */
+static const int animations[][5] = {
+    {5, 5, 6, 1, 20},
+    {6, 5, 6, 1, 20},
+    {0x22, 18, 1, 0, 30},
+    {0x37, 18, 1, 0, 45},
+};
+#define ANIMATIONS ((int) (sizeof(animations) / sizeof(animations[0])))
+
+/* how many cells of a map use a tile */
+static int cells(const unsigned short* map, int count, int tile) {
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        n += map[i] == tile;
+    }
+    return n;
+}
+
+int main(int argc, char** argv) {
+    int vblanks = argc > 1 ? atoi(argv[1]) : 3600;
+    if (vblanks <= 0) {
+        fprintf(stderr, "usage: tileanimbench [frames]\n");
+        return 2;
+    }
+
+    static unsigned char char_block[0x4000];
+    static unsigned char recoloured[ANIMATIONS][TILE_BYTES];
+    memcpy(char_block, background_data, sizeof(background_data));
+
+    struct TileAnimator animator;
+    struct DmaQueue queue;
+    tile_animator_init(&animator, char_block);
+    dma_queue_init(&queue);
+    int map_cells[ANIMATIONS];
+    for (int i = 0; i < ANIMATIONS; i++) {
+        const unsigned char* frames[2];
+        frames[0] = background_data + animations[i][0] * TILE_BYTES;
+        tile_anim_recolour(recoloured[i], frames[0], animations[i][1], animations[i][2], animations[i][3]);
+        frames[1] = recoloured[i];
+        if (memcmp(frames[0], frames[1], TILE_BYTES) == 0) {
+            fprintf(stderr, "tileanimbench: tile %d has none of colour %d\n",
+                    animations[i][0], animations[i][1]);
+            return 1;
+        }
+        tile_animator_add(&animator, animations[i][0], frames, 2, animations[i][4]);
+        map_cells[i] = cells(groundlayermap, groundlayermap_width * groundlayermap_height, animations[i][0]) +
+            cells(layer0map, layer0map_width * layer0map_height, animations[i][0]);
+    }
+
+    long long tile_bytes = 0, map_bytes = 0, map_writes = 0;
+    for (int v = 0; v < vblanks; v++) {
+        tile_animator_update(&animator, &queue);
+        tile_bytes += queue.words * 4;
+        for (int c = 0; c < queue.count; c++) {
+            int tile = (int) ((unsigned char*) queue.copies[c].dest - char_block) / TILE_BYTES;
+            for (int i = 0; i < ANIMATIONS; i++) {
+                if (animations[i][0] == tile) {
+                    map_bytes += 2 * map_cells[i];
+                    map_writes += map_cells[i];
+                }
+            }
+            memcpy(queue.copies[c].dest, queue.copies[c].source, queue.copies[c].words * 4);
+        }
+        dma_queue_done(&queue);
+
+        /* every animated tile has to hold the frame it is on */
+        for (int i = 0; i < ANIMATIONS; i++) {
+            const struct TileAnimation* a = &animator.animations[i];
+            if (memcmp(char_block + a->tile * TILE_BYTES, a->frames[a->frame], TILE_BYTES) != 0) {
+                fprintf(stderr, "tileanimbench: tile %d is not on frame %d at vblank %d\n",
+                        a->tile, a->frame, v);
+                return 1;
+            }
+        }
+    }
+
+    printf("tile  delay  map cells\n");
+    for (int i = 0; i < ANIMATIONS; i++) {
+        printf("%4d  %5d  %9d\n", animations[i][0], animations[i][4], map_cells[i]);
+    }
+    printf("\n%d vblanks, %u tiles copied, worst %d in one vblank\n", vblanks, animator.total, animator.worst);
+    printf("              writes/vblank  bytes/vblank\n");
+    printf("tile copies   %13.3f  %12.2f\n", (double) animator.total / vblanks,
+            (double) tile_bytes / vblanks);
+    printf("map rewrites  %13.3f  %12.2f\n", (double) map_writes / vblanks,
+            (double) map_bytes / vblanks);
+    return animator.dropped != 0;
+}
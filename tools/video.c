@@ -0,0 +1,466 @@
+/* video.c
+ * turns a replay into a video, for bug reports and trailers, with nothing
+ * but this to make it.
+ *
+ *   gcc -O2 -pthread -o video tools/video.c
+ *
+ *   video [-s scale] [-j threads] [-q jobs] [-f frames] [-l] <replay> <out.y4m|->
+ *
+ * the video is YUV4MPEG2, which players and encoders read as it is: 4:4:4,
+ * so the pixels keep their colours, at the GBA's 59.73 frames a second and
+ * scaled up a whole number of times (3 by default) with every pixel made a
+ * square block.
+ *
+ * the work is a pipeline of four stages on threads of their own:
+ *
+ *   simulate   one thread steps the game with the replay's keys and takes a
+ *              snapshot of the scroll, the sprite table and the ground
+ *   render     draws each snapshot with the host picture unit in ppu.h
+ *   scale      turns the picture into Y, Cb and Cr and blows it up
+ *   write      one thread puts the frames out in order
+ *
+ * render and scale have the given number of threads each (the number of
+ * cores by default) and take whichever frame comes next, so frames reach
+ * the writer out of order and it holds them until their turn. the stages
+ * hand frames on through bounded queues, and a frame's buffers go back to
+ * a free list once written, so no more than -q frames (4 a thread by
+ * default) are ever in flight and a slow stage holds the ones before it up
+ * rather than letting memory grow.
+ *
+ * the replay is played on the shipped ground map, as replayfarm plays it,
+ * until the keys run out, the dragon goes down or -f frames. -l flies the
+ * long level through the streamer the way the ROM does instead.
+ *
+ * last it prints each stage's frames a second: over the whole run, and
+ * what its threads could keep up if they never had to wait, which shows
+ * the stage holding the others back, and how long they spent waiting */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../level.h"
+#include "../level1.h"
+
+#include <time.h>
+
+#include "ppu.h"
+#include "pool.h"
+#include "replay.h"
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* the GBA's frame rate, 2^24 Hz over 280896 cycles a frame */
+#define VIDEO_RATE_NUM 16777216
+#define VIDEO_RATE_DEN 280896
+
+/* one frame on its way through the pipeline */
+struct Job {
+    unsigned int frame;
+
+    /* the snapshot */
+    int xscroll;
+    struct Sprite sprites[NUM_SPRITES];
+    unsigned short ring[LEVEL_ROWS * LEVEL_RING];
+
+    /* the picture, then its three planes scaled up */
+    struct PpuFrame rgb;
+    unsigned char* yuv;
+};
+
+/* a bounded queue of jobs between stages. it is done once every thread
+ * feeding it has said so and it is empty */
+struct Queue {
+    struct Job** items;
+    int capacity;
+    int head;
+    int count;
+    int producers;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+};
+
+static void queue_init(struct Queue* q, int capacity, int producers) {
+    q->items = malloc(sizeof(struct Job*) * capacity);
+    q->capacity = capacity;
+    q->head = 0;
+    q->count = 0;
+    q->producers = producers;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->changed, NULL);
+}
+
+/* add a job, waiting for room */
+static void queue_push(struct Queue* q, struct Job* job) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->capacity) {
+        pthread_cond_wait(&q->changed, &q->lock);
+    }
+    q->items[(q->head + q->count) % q->capacity] = job;
+    q->count++;
+    pthread_cond_broadcast(&q->changed);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/* take the oldest job, waiting for one, or NULL once the queue is done */
+static struct Job* queue_pop(struct Queue* q) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && q->producers > 0) {
+        pthread_cond_wait(&q->changed, &q->lock);
+    }
+    struct Job* job = NULL;
+    if (q->count) {
+        job = q->items[q->head];
+        q->head = (q->head + 1) % q->capacity;
+        q->count--;
+        pthread_cond_broadcast(&q->changed);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return job;
+}
+
+/* one of the threads feeding a queue has finished */
+static void queue_done(struct Queue* q) {
+    pthread_mutex_lock(&q->lock);
+    q->producers--;
+    pthread_cond_broadcast(&q->changed);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/* what a stage's threads did between them */
+struct Stage {
+    const char* name;
+    int threads;
+    unsigned int frames;
+    double busy;
+    double waited;
+    pthread_mutex_t lock;
+};
+
+static void stage_add(struct Stage* stage, unsigned int frames, double busy, double waited) {
+    pthread_mutex_lock(&stage->lock);
+    stage->frames += frames;
+    stage->busy += busy;
+    stage->waited += waited;
+    pthread_mutex_unlock(&stage->lock);
+}
+
+enum StageId {
+    STAGE_SIMULATE,
+    STAGE_RENDER,
+    STAGE_SCALE,
+    STAGE_WRITE,
+    STAGES
+};
+
+static struct Stage stages[STAGES] = {
+    [STAGE_SIMULATE] = {.name = "simulate", .threads = 1},
+    [STAGE_RENDER] = {.name = "render"},
+    [STAGE_SCALE] = {.name = "scale"},
+    [STAGE_WRITE] = {.name = "write", .threads = 1},
+};
+
+/* the queue into each stage, and the free jobs into the first */
+static struct Queue queues[STAGES];
+
+/* settings */
+static struct Replay replay;
+static unsigned int frame_limit;
+static int scale = 3;
+static int streaming = 0;
+static FILE* out;
+static int jobs;
+
+/* the size of one scaled plane */
+#define PLANE_WIDTH (SCREEN_WIDTH * scale)
+#define PLANE_HEIGHT (SCREEN_HEIGHT * scale)
+
+static void* simulate(void* data) {
+    static const struct Level level = {level1_data, level1_index, level1_width};
+    static unsigned short screen[2 * 32 * 32];
+    static struct LevelStreamer streamer;
+    static struct Game game;
+    unsigned int frames = 0;
+    double busy = 0, waited = 0;
+    (void) data;
+
+    game_init(&game, &ground_tilemap);
+    if (streaming) {
+        level_streamer_init(&streamer, &level, screen, &game);
+    }
+    while (frames < frame_limit) {
+        double start = now_seconds();
+        struct Job* job = queue_pop(&queues[STAGE_SIMULATE]);
+        double got = now_seconds();
+
+        /* step the game as the ROM's game and level tasks do */
+        game_step(&game, replay.keys[frames]);
+        if (streaming) {
+            level_streamer_update(&streamer, &game);
+            level_streamer_commit(&streamer, screen);
+            memcpy(job->ring, streamer.ring, sizeof(job->ring));
+        }
+        job->frame = frames++;
+        job->xscroll = game.xscroll;
+        memcpy(job->sprites, game.oam.sprites, sizeof(job->sprites));
+
+        double done = now_seconds();
+        queue_push(&queues[STAGE_RENDER], job);
+        busy += done - got;
+        waited += got - start + now_seconds() - done;
+        if (!game.dragon.alive) {
+            break;
+        }
+    }
+    stage_add(&stages[STAGE_SIMULATE], frames, busy, waited);
+    queue_done(&queues[STAGE_RENDER]);
+    return NULL;
+}
+
+/* the palettes, shared by the render threads */
+static struct Ppu ppu;
+
+static void* render(void* data) {
+    unsigned int frames = 0;
+    double busy = 0, waited = 0;
+    (void) data;
+    for (;;) {
+        double start = now_seconds();
+        struct Job* job = queue_pop(&queues[STAGE_RENDER]);
+        double got = now_seconds();
+        waited += got - start;
+        if (!job) {
+            break;
+        }
+        struct PpuView view;
+        view.ground = streaming ? job->ring : ground_tilemap.tiles;
+        view.ground_width = streaming ? LEVEL_RING : ground_tilemap.width;
+        view.ground_height = streaming ? LEVEL_ROWS : ground_tilemap.height;
+        view.xscroll = job->xscroll;
+        view.back_xscroll = (int) (job->xscroll * 1.2);
+        view.sprites = job->sprites;
+        ppu_draw(&ppu, &job->rgb, &view);
+        frames++;
+
+        double done = now_seconds();
+        queue_push(&queues[STAGE_SCALE], job);
+        busy += done - got;
+        waited += now_seconds() - done;
+    }
+    stage_add(&stages[STAGE_RENDER], frames, busy, waited);
+    queue_done(&queues[STAGE_SCALE]);
+    return NULL;
+}
+
+/* BT.601 studio range, as YUV4MPEG2 players take it */
+static void rgb_to_yuv(const unsigned char* rgb, unsigned char* y, unsigned char* u, unsigned char* v) {
+    int r = rgb[0], g = rgb[1], b = rgb[2];
+    *y = (unsigned char) (((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+    *u = (unsigned char) (((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    *v = (unsigned char) (((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+static void* scale_up(void* data) {
+    unsigned int frames = 0;
+    double busy = 0, waited = 0;
+    (void) data;
+    for (;;) {
+        double start = now_seconds();
+        struct Job* job = queue_pop(&queues[STAGE_SCALE]);
+        double got = now_seconds();
+        waited += got - start;
+        if (!job) {
+            break;
+        }
+
+        /* a line of each plane at a time: convert it, widen it, and copy
+         * the widened line down the block */
+        size_t plane = (size_t) PLANE_WIDTH * PLANE_HEIGHT;
+        for (int line = 0; line < SCREEN_HEIGHT; line++) {
+            unsigned char* rows[3];
+            for (int p = 0; p < 3; p++) {
+                rows[p] = job->yuv + p * plane + (size_t) line * scale * PLANE_WIDTH;
+            }
+            for (int x = 0; x < SCREEN_WIDTH; x++) {
+                unsigned char yuv[3];
+                rgb_to_yuv(job->rgb.rgb[line][x], &yuv[0], &yuv[1], &yuv[2]);
+                for (int p = 0; p < 3; p++) {
+                    memset(rows[p] + x * scale, yuv[p], scale);
+                }
+            }
+            for (int p = 0; p < 3; p++) {
+                for (int copy = 1; copy < scale; copy++) {
+                    memcpy(rows[p] + copy * PLANE_WIDTH, rows[p], PLANE_WIDTH);
+                }
+            }
+        }
+        frames++;
+
+        double done = now_seconds();
+        queue_push(&queues[STAGE_WRITE], job);
+        busy += done - got;
+        waited += now_seconds() - done;
+    }
+    stage_add(&stages[STAGE_SCALE], frames, busy, waited);
+    queue_done(&queues[STAGE_WRITE]);
+    return NULL;
+}
+
+/* bytes written and whether any write failed */
+static unsigned long long written;
+static int write_failed;
+
+static void* write_out(void* data) {
+    struct Job** held = calloc(jobs, sizeof(struct Job*));
+    unsigned int next = 0, frames = 0;
+    double busy = 0, waited = 0;
+    size_t bytes = (size_t) 3 * PLANE_WIDTH * PLANE_HEIGHT;
+    (void) data;
+
+    double start = now_seconds();
+    int header = fprintf(out, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C444\n", PLANE_WIDTH, PLANE_HEIGHT,
+            VIDEO_RATE_NUM, VIDEO_RATE_DEN);
+    write_failed |= header < 0;
+    written += header > 0 ? header : 0;
+    busy += now_seconds() - start;
+    for (;;) {
+        start = now_seconds();
+        struct Job* job = queue_pop(&queues[STAGE_WRITE]);
+        double got = now_seconds();
+        waited += got - start;
+        if (!job) {
+            break;
+        }
+
+        /* hold it until every frame before it is out. there are only so
+         * many jobs, so the ones held all fit */
+        held[job->frame % jobs] = job;
+        while ((job = held[next % jobs]) && job->frame == next) {
+            held[next % jobs] = NULL;
+            write_failed |= fputs("FRAME\n", out) < 0 || fwrite(job->yuv, bytes, 1, out) != 1;
+            written += 6 + bytes;
+            next++;
+            frames++;
+            queue_push(&queues[STAGE_SIMULATE], job);
+        }
+        busy += now_seconds() - got;
+    }
+    start = now_seconds();
+    write_failed |= fflush(out) != 0;
+    busy += now_seconds() - start;
+    stage_add(&stages[STAGE_WRITE], frames, busy, waited);
+    free(held);
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    int threads = pool_cores();
+    int limit = 0;
+    const char* paths[2];
+    int path_count = 0;
+    int usage = 0;
+    for (int i = 1; i < argc && !usage; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            scale = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-q") == 0 && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            limit = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-l") == 0) {
+            streaming = 1;
+        } else if (path_count < 2 && (argv[i][0] != '-' || strcmp(argv[i], "-") == 0)) {
+            paths[path_count++] = argv[i];
+        } else {
+            usage = 1;
+        }
+    }
+    if (usage || path_count != 2 || scale < 1 || scale > 16 || threads < 1 || jobs < 0 || limit < 0) {
+        fprintf(stderr, "usage: video [-s scale] [-j threads] [-q jobs] [-f frames] [-l] <replay> <out.y4m|->\n");
+        return 2;
+    }
+    if (replay_load(&replay, paths[0]) != 0 || replay.header.frames == 0) {
+        fprintf(stderr, "video: cannot load replay %s\n", paths[0]);
+        return 2;
+    }
+    frame_limit = replay.header.frames;
+    if (limit && (unsigned int) limit < frame_limit) {
+        frame_limit = limit;
+    }
+    out = strcmp(paths[1], "-") == 0 ? stdout : fopen(paths[1], "wb");
+    if (!out) {
+        fprintf(stderr, "video: cannot write %s\n", paths[1]);
+        return 2;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+    /* every job starts on the free list, and no queue can hold more than
+     * there are, so only the free list ever makes a stage wait for room */
+    if (!jobs) {
+        jobs = 4 * threads;
+    }
+    if (jobs < 2) {
+        jobs = 2;
+    }
+    stages[STAGE_RENDER].threads = threads;
+    stages[STAGE_SCALE].threads = threads;
+    for (int s = 0; s < STAGES; s++) {
+        pthread_mutex_init(&stages[s].lock, NULL);
+    }
+    queue_init(&queues[STAGE_SIMULATE], jobs, 1);
+    queue_init(&queues[STAGE_RENDER], jobs, 1);
+    queue_init(&queues[STAGE_SCALE], jobs, threads);
+    queue_init(&queues[STAGE_WRITE], jobs, threads);
+    for (int i = 0; i < jobs; i++) {
+        struct Job* job = malloc(sizeof(struct Job));
+        job->yuv = malloc((size_t) 3 * PLANE_WIDTH * PLANE_HEIGHT);
+        queue_push(&queues[STAGE_SIMULATE], job);
+    }
+
+    ppu_init(&ppu);
+    pthread_t* ids = malloc(sizeof(pthread_t) * (2 * threads + 2));
+    int started = 0;
+    double start = now_seconds();
+    pthread_create(&ids[started++], NULL, simulate, NULL);
+    for (int i = 0; i < threads; i++) {
+        pthread_create(&ids[started++], NULL, render, NULL);
+        pthread_create(&ids[started++], NULL, scale_up, NULL);
+    }
+    pthread_create(&ids[started++], NULL, write_out, NULL);
+    for (int i = 0; i < started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    double seconds = now_seconds() - start;
+    if (out != stdout && fclose(out) != 0) {
+        write_failed = 1;
+    }
+
+    /* the report goes to stderr when the video goes to stdout */
+    FILE* report = out == stdout ? stderr : stdout;
+    const struct Stage* last = &stages[STAGE_WRITE];
+    fprintf(report, "%u frames at %dx%d, %llu bytes, %d threads a stage, %d in flight\n", last->frames,
+            PLANE_WIDTH, PLANE_HEIGHT, written, threads, jobs);
+    fprintf(report, "stage     threads    frames/s   could keep up   waited\n");
+    for (int s = 0; s < STAGES; s++) {
+        const struct Stage* stage = &stages[s];
+        fprintf(report, "%-9s %7d %11.1f %15.1f %7.1f%%\n", stage->name, stage->threads,
+                stage->frames / seconds, stage->busy > 0 ? stage->frames * stage->threads / stage->busy : 0,
+                100.0 * stage->waited / (stage->threads * seconds));
+    }
+    fprintf(report, "%.3f s, %.1f frames/s, %.1f MB/s out\n", seconds, last->frames / seconds,
+            written / seconds / 1e6);
+
+    if (write_failed) {
+        fprintf(stderr, "video: writing %s failed\n", paths[1]);
+        return 1;
+    }
+    if (last->frames != stages[STAGE_SIMULATE].frames) {
+        fprintf(stderr, "video: %u frames simulated but %u written\n", stages[STAGE_SIMULATE].frames,
+                last->frames);
+        return 1;
+    }
+    return 0;
+}
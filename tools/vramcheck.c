@@ -0,0 +1,117 @@
+/* vramcheck.c
+ * checks the VRAM allocator in vram.h by laying out the shipped game and
+ * then swapping levels in and out around it, the way a level change would.
+ *
+ *   gcc -O2 -o vramcheck tools/vramcheck.c
+ *
+ *   vramcheck [levels]
+ *
+ * the shipped layout is claimed with vram_layout() from vramlayout.h, the
+ * same as the ROM does, and a claim over each part of it has to be turned
+ * down. then each level (8 by default) gives back the one before's tiles
+ * and map and takes a char block of tiles and a map of its own. it prints
+ * the use of each 16K block at the end, and exits non-zero if anything
+ * landed on something else */
+
+#define PHLAPU_HOST
+#include "../game.h"
+#include "../vram.h"
+#include "../dmaqueue.h"
+#include "../spritecache.h"
+#include "../memory.h"
+#include "../particles.h"
+#include "../level.h"
+#include "../background.h"
+#include "../dragon.h"
+#include "../layer0map.h"
+#include "../score.h"
+#include "../vramlayout.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* a level's tiles, up to a full char block, and its map */
+#define LEVEL_TILE_BYTES 0x3000
+#define LEVEL_MAP_BYTES MAP_BYTES(layer0map)
+
+static int failed;
+
+static void check(int ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "vramcheck: %s\n", what);
+        failed = 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    int levels = argc > 1 ? atoi(argv[1]) : 8;
+    if (levels <= 0) {
+        fprintf(stderr, "usage: vramcheck [levels]\n");
+        return 2;
+    }
+
+    struct Vram vram;
+    vram_init(&vram);
+    struct VramLayout layout;
+    vram_layout(&vram, &layout);
+    check(vram.failures == 0, "could not lay out the shipped game");
+    check(layout.sprite_cache == 0, "the sprite cache did not go at the start of sprite VRAM");
+    check(layout.particles == SPRITE_CACHE_BYTES, "the particles did not go straight after the sprite cache");
+
+    /* anything over the fixed layout has to be turned down */
+    unsigned int failures = vram.failures;
+    check(!vram_reserve(&vram, VRAM_BG, "over tiles", VRAM_SCREEN_OFFSET(2), LEVEL_MAP_BYTES),
+            "a map went over the background tiles");
+    check(!vram_reserve(&vram, VRAM_BG, "over ground", VRAM_SCREEN_OFFSET(GROUND_SCREEN_BLOCK),
+                LEVEL_MAP_BYTES), "a map went over the ground map");
+    check(!vram_reserve(&vram, VRAM_BG, "over ground", VRAM_SCREEN_OFFSET(GROUND_SCREEN_BLOCK + 1),
+                LEVEL_MAP_BYTES), "a map went over the right half of the ground map");
+    check(!vram_reserve(&vram, VRAM_BG, "over affine", VRAM_SCREEN_OFFSET(AFFINE_SCREEN_BLOCK),
+                LEVEL_MAP_BYTES), "a map went over the affine map");
+    check(!vram_reserve(&vram, VRAM_SPRITES, "over cache", 0, 32), "tiles went over the sprite cache");
+    check(!vram_reserve(&vram, VRAM_SPRITES, "over particles", layout.particles, 32),
+            "tiles went over the particles");
+    check(vram.failures == failures + 6, "the turned down claims were not counted");
+
+    /* swap levels in and out. the first char block is the shipped tiles'
+     * and the last two have maps in, so each level's tiles have to go in
+     * the one the level before gave back */
+    int tiles = -1, map = -1;
+    for (int level = 0; level < levels; level++) {
+        if (tiles >= 0) {
+            vram_free(&vram, VRAM_BG, tiles);
+            vram_free(&vram, VRAM_BG, map);
+        }
+        int next_tiles = vram_alloc(&vram, VRAM_BG, "level tiles", LEVEL_TILE_BYTES,
+                VRAM_CHAR_BLOCK_UNITS);
+        int next_map = vram_alloc(&vram, VRAM_BG, "level map", LEVEL_MAP_BYTES, 1);
+        check(next_tiles == VRAM_CHAR_OFFSET(1), "a level's tiles did not get the free char block");
+        check(next_map >= 0, "a level's map did not fit");
+        check(VRAM_DISJOINT(next_tiles, LEVEL_TILE_BYTES, next_map, LEVEL_MAP_BYTES),
+                "a level's map went over its tiles");
+        check(tiles < 0 || (next_tiles == tiles && next_map == map),
+                "a level did not reuse what the level before gave back");
+        tiles = next_tiles;
+        map = next_map;
+    }
+
+    /* with a level in, there is no char block left for another */
+    check(vram_alloc(&vram, VRAM_BG, "extra tiles", LEVEL_TILE_BYTES, VRAM_CHAR_BLOCK_UNITS) < 0,
+            "a second level's tiles found a char block that was not free");
+
+    printf("block  used bytes\n");
+    for (int block = 0; block < 6; block++) {
+        printf("%5d  %10u\n", block, vram_block_used(&vram, block));
+    }
+    printf("\nhigh water: bg %d of %d units, sprites %d of %d units\n",
+            vram.high[VRAM_BG], VRAM_UNITS, vram.high[VRAM_SPRITES], VRAM_UNITS);
+    for (int i = 0; i < VRAM_MAX_RANGES; i++) {
+        const struct VramRange* range = &vram.ranges[i];
+        if (range->used) {
+            printf("%-8s %-12s %6u to %6u\n", range->region == VRAM_BG ? "bg" : "sprites",
+                    range->name, range->first * vram_unit_size(range->region),
+                    (range->first + range->count) * vram_unit_size(range->region));
+        }
+    }
+    return failed;
+}
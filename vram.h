@@ -0,0 +1,198 @@
+/* vram.h
+ * who owns which part of video memory.
+ *
+ * the 64K of background VRAM is shared by tile images and tile maps: char
+ * block n (16K, where a background reads its tiles from) is the same memory
+ * as screen blocks 8n to 8n+7 (2K each, where it reads its map from). the
+ * 32K of sprite VRAM after it holds the sprites' tiles. nothing stops a map
+ * being loaded over the tiles, so every image and map is given a range here
+ * first.
+ *
+ * background VRAM is handed out a screen block at a time and sprite VRAM a
+ * kilobyte (32 tiles) at a time, so each region is one 32 bit mask with a
+ * bit per unit. a layout fixed at compile time can be checked for overlaps
+ * with VRAM_DISJOINT and _Static_assert, and reserved at boot so it shows up
+ * in the report. ranges for things that come and go with a level are taken
+ * with vram_alloc() and given back with vram_free(), so a new level's tiles
+ * can go in without reloading the rest.
+ *
+ * nothing in here touches the hardware, so the host tools can use it too */
+
+/* the regions of VRAM, and the unit each is handed out in */
+enum VramRegion {
+    VRAM_BG,
+    VRAM_SPRITES,
+    VRAM_REGIONS
+};
+
+#define VRAM_BG_SIZE 0x10000
+#define VRAM_SPRITE_SIZE 0x8000
+#define VRAM_BG_UNIT 0x800
+#define VRAM_SPRITE_UNIT 0x400
+
+/* 32 units to a region, one bit each */
+#define VRAM_UNITS 32
+
+/* a char block is 8 screen blocks */
+#define VRAM_CHAR_BLOCK_UNITS 8
+#define VRAM_CHAR_BLOCK_SIZE 0x4000
+
+/* the most ranges that can be out at once */
+#define VRAM_MAX_RANGES 16
+
+/* the byte offsets of char blocks and screen blocks into background VRAM,
+ * and of sprite tiles (32 bytes each) into sprite VRAM */
+#define VRAM_CHAR_OFFSET(block) ((block) * VRAM_CHAR_BLOCK_SIZE)
+#define VRAM_SCREEN_OFFSET(block) ((block) * VRAM_BG_UNIT)
+#define VRAM_SPRITE_TILE_OFFSET(tile) ((tile) * 32)
+
+/* whether two byte ranges miss each other, for checking a fixed layout
+ * with _Static_assert */
+#define VRAM_DISJOINT(a, a_bytes, b, b_bytes) \
+    ((a) + (a_bytes) <= (b) || (b) + (b_bytes) <= (a))
+
+/* one range handed out */
+struct VramRange {
+    const char* name;
+    unsigned char region;
+    unsigned char first;
+    unsigned char count;
+    unsigned char used;
+};
+
+struct Vram {
+    /* a bit for each unit in use, per region */
+    unsigned int units[VRAM_REGIONS];
+
+    /* the most units there have been in use at once, per region */
+    int high[VRAM_REGIONS];
+
+    struct VramRange ranges[VRAM_MAX_RANGES];
+
+    /* requests that overlapped something or did not fit */
+    unsigned int failures;
+};
+
+/* the size of a region's units */
+unsigned int vram_unit_size(enum VramRegion region) {
+    return region == VRAM_BG ? VRAM_BG_UNIT : VRAM_SPRITE_UNIT;
+}
+
+/* the mask of count units from first */
+unsigned int vram_mask(int first, int count) {
+    return (count >= VRAM_UNITS ? 0xffffffffu : ((1u << count) - 1)) << first;
+}
+
+/* the number of bits set in a mask */
+int vram_bits(unsigned int mask) {
+    int count = 0;
+    while (mask) {
+        mask &= mask - 1;
+        count++;
+    }
+    return count;
+}
+
+void vram_init(struct Vram* vram) {
+    for (int r = 0; r < VRAM_REGIONS; r++) {
+        vram->units[r] = 0;
+        vram->high[r] = 0;
+    }
+    for (int i = 0; i < VRAM_MAX_RANGES; i++) {
+        vram->ranges[i].used = 0;
+    }
+    vram->failures = 0;
+}
+
+/* mark count units from first as owned by name, returns 0 if any of them
+ * are already taken or there is no room to keep the range */
+int vram_take(struct Vram* vram, enum VramRegion region, const char* name, int first, int count) {
+    if (first < 0 || count <= 0 || first + count > VRAM_UNITS ||
+            (vram->units[region] & vram_mask(first, count))) {
+        vram->failures++;
+        return 0;
+    }
+    for (int i = 0; i < VRAM_MAX_RANGES; i++) {
+        struct VramRange* range = &vram->ranges[i];
+        if (range->used) {
+            continue;
+        }
+        range->name = name;
+        range->region = region;
+        range->first = first;
+        range->count = count;
+        range->used = 1;
+        vram->units[region] |= vram_mask(first, count);
+        int now = vram_bits(vram->units[region]);
+        if (now > vram->high[region]) {
+            vram->high[region] = now;
+        }
+        return 1;
+    }
+    vram->failures++;
+    return 0;
+}
+
+/* the number of units a size in bytes takes up */
+int vram_units_for(enum VramRegion region, unsigned int bytes) {
+    unsigned int unit = vram_unit_size(region);
+    return (int) ((bytes + unit - 1) / unit);
+}
+
+/* claim a range at a fixed byte offset, for the parts of the layout that
+ * never move. returns 0 if it overlaps something */
+int vram_reserve(struct Vram* vram, enum VramRegion region, const char* name,
+        unsigned int offset, unsigned int bytes) {
+    unsigned int unit = vram_unit_size(region);
+    int first = (int) (offset / unit);
+    int last = vram_units_for(region, offset + bytes);
+    return vram_take(vram, region, name, first, last - first);
+}
+
+/* find room for bytes starting on a multiple of align units, lowest first,
+ * and take it. returns the byte offset into the region, or -1 if there is
+ * no room. tile images for a background want an align of
+ * VRAM_CHAR_BLOCK_UNITS, as a background can only start reading at a char
+ * block, and maps want 1 */
+int vram_alloc(struct Vram* vram, enum VramRegion region, const char* name,
+        unsigned int bytes, int align) {
+    int count = vram_units_for(region, bytes);
+    if (align < 1) {
+        align = 1;
+    }
+    for (int first = 0; first + count <= VRAM_UNITS; first += align) {
+        if (!(vram->units[region] & vram_mask(first, count))) {
+            if (!vram_take(vram, region, name, first, count)) {
+                return -1;
+            }
+            return first * (int) vram_unit_size(region);
+        }
+    }
+    vram->failures++;
+    return -1;
+}
+
+/* give back the range that starts at a byte offset */
+void vram_free(struct Vram* vram, enum VramRegion region, unsigned int offset) {
+    int first = (int) (offset / vram_unit_size(region));
+    for (int i = 0; i < VRAM_MAX_RANGES; i++) {
+        struct VramRange* range = &vram->ranges[i];
+        if (range->used && range->region == region && range->first == first) {
+            vram->units[region] &= ~vram_mask(first, range->count);
+            range->used = 0;
+            return;
+        }
+    }
+}
+
+/* how many bytes of a 16K block are in use: char blocks 0-3 of background
+ * VRAM, then 4 and 5 for the two halves of sprite VRAM */
+unsigned int vram_block_used(const struct Vram* vram, int block) {
+    if (block < 4) {
+        return vram_bits(vram->units[VRAM_BG] & vram_mask(block * VRAM_CHAR_BLOCK_UNITS,
+                    VRAM_CHAR_BLOCK_UNITS)) * VRAM_BG_UNIT;
+    }
+    int per_block = VRAM_CHAR_BLOCK_SIZE / VRAM_SPRITE_UNIT;
+    return vram_bits(vram->units[VRAM_SPRITES] & vram_mask((block - 4) * per_block,
+                per_block)) * VRAM_SPRITE_UNIT;
+}
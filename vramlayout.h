@@ -0,0 +1,81 @@
+/* vramlayout.h
+ * where everything the game shows lives in VRAM.
+ *
+ * the backgrounds' tiles fill char block 0, and the maps sit at fixed
+ * screen blocks in char blocks 2 and 3: the back layer at 16, the ground's
+ * two blocks at 21 and 22, the score page at 26, and the score page again
+ * as an affine map at 27. the layout is fixed, so the compiler checks none
+ * of it runs into anything else. char block 1 is left free for a level's
+ * own tiles.
+ *
+ * sprite VRAM is allocated rather than fixed: the dragon's frame cache goes
+ * first, then the particles' tiles.
+ *
+ * vram_layout() claims all of it in the order the ROM does, so Phlapu.c and
+ * vramcheck in the tools work from the same layout. this needs vram.h,
+ * level.h, spritecache.h and particles.h, and the images and maps */
+
+#define BG_TILES_CHAR_BLOCK 0
+#define LAYER0_SCREEN_BLOCK 16
+#define GROUND_SCREEN_BLOCK 21
+#define SCORE_SCREEN_BLOCK 26
+#define AFFINE_SCREEN_BLOCK 27
+
+#define BG_TILES_BYTES (background_width * background_height)
+#define MAP_BYTES(name) (name##_width * name##_height * 2)
+
+/* the ground is a 64x32 map, two screen blocks side by side */
+#define GROUND_MAP_BYTES (LEVEL_RING * LEVEL_ROWS * 2)
+
+/* the score page again as an affine map, a byte a tile */
+#define AFFINE_MAP_BYTES (score_width * score_height)
+
+/* the sprite tiles: the dragon's frame slots and a tile per particle kind */
+#define SPRITE_CACHE_BYTES (SPRITE_CACHE_SLOTS * SPRITE_SLOT_BYTES)
+#define PARTICLE_TILES_BYTES (PARTICLE_KINDS * PARTICLE_TILE_BYTES)
+
+_Static_assert(VRAM_DISJOINT(VRAM_CHAR_OFFSET(BG_TILES_CHAR_BLOCK), BG_TILES_BYTES,
+            VRAM_SCREEN_OFFSET(LAYER0_SCREEN_BLOCK), MAP_BYTES(layer0map)),
+        "the background tiles run into the back layer's map");
+_Static_assert(VRAM_DISJOINT(VRAM_CHAR_OFFSET(BG_TILES_CHAR_BLOCK), BG_TILES_BYTES,
+            VRAM_SCREEN_OFFSET(GROUND_SCREEN_BLOCK), GROUND_MAP_BYTES),
+        "the background tiles run into the ground layer's map");
+_Static_assert(VRAM_DISJOINT(VRAM_CHAR_OFFSET(BG_TILES_CHAR_BLOCK), BG_TILES_BYTES,
+            VRAM_SCREEN_OFFSET(SCORE_SCREEN_BLOCK), MAP_BYTES(score)),
+        "the background tiles run into the score page's map");
+_Static_assert(VRAM_DISJOINT(VRAM_SCREEN_OFFSET(LAYER0_SCREEN_BLOCK), MAP_BYTES(layer0map),
+            VRAM_SCREEN_OFFSET(GROUND_SCREEN_BLOCK), GROUND_MAP_BYTES),
+        "the back layer's map runs into the ground layer's");
+_Static_assert(VRAM_DISJOINT(VRAM_SCREEN_OFFSET(GROUND_SCREEN_BLOCK), GROUND_MAP_BYTES,
+            VRAM_SCREEN_OFFSET(SCORE_SCREEN_BLOCK), MAP_BYTES(score)),
+        "the ground layer's map runs into the score page's");
+_Static_assert(VRAM_DISJOINT(VRAM_CHAR_OFFSET(BG_TILES_CHAR_BLOCK), BG_TILES_BYTES,
+            VRAM_SCREEN_OFFSET(AFFINE_SCREEN_BLOCK), AFFINE_MAP_BYTES),
+        "the background tiles run into the affine page's map");
+_Static_assert(VRAM_DISJOINT(VRAM_SCREEN_OFFSET(SCORE_SCREEN_BLOCK), MAP_BYTES(score),
+            VRAM_SCREEN_OFFSET(AFFINE_SCREEN_BLOCK), AFFINE_MAP_BYTES),
+        "the score page's map runs into the affine page's");
+_Static_assert(BG_TILES_BYTES / 64 <= 256, "an affine map cannot reach all the background tiles");
+_Static_assert(dragon_width * dragon_height <= VRAM_SPRITE_SIZE,
+        "the dragon's tiles do not fit in sprite VRAM");
+_Static_assert(SPRITE_CACHE_BYTES + PARTICLE_TILES_BYTES <= VRAM_SPRITE_SIZE,
+        "the sprite cache and the particles do not fit in sprite VRAM");
+
+/* where the allocated parts of sprite VRAM ended up, as byte offsets */
+struct VramLayout {
+    int sprite_cache;
+    int particles;
+};
+
+/* claim the fixed background layout and allocate the sprite tiles, so the
+ * report shows all of it and nothing allocated later lands on any of it */
+void vram_layout(struct Vram* vram, struct VramLayout* layout) {
+    vram_reserve(vram, VRAM_BG, "bg tiles", VRAM_CHAR_OFFSET(BG_TILES_CHAR_BLOCK), BG_TILES_BYTES);
+    vram_reserve(vram, VRAM_BG, "back map", VRAM_SCREEN_OFFSET(LAYER0_SCREEN_BLOCK), MAP_BYTES(layer0map));
+    vram_reserve(vram, VRAM_BG, "ground map", VRAM_SCREEN_OFFSET(GROUND_SCREEN_BLOCK), GROUND_MAP_BYTES);
+    vram_reserve(vram, VRAM_BG, "score map", VRAM_SCREEN_OFFSET(SCORE_SCREEN_BLOCK), MAP_BYTES(score));
+    vram_reserve(vram, VRAM_BG, "affine map", VRAM_SCREEN_OFFSET(AFFINE_SCREEN_BLOCK), AFFINE_MAP_BYTES);
+
+    layout->sprite_cache = vram_alloc(vram, VRAM_SPRITES, "sprite cache", SPRITE_CACHE_BYTES, 1);
+    layout->particles = vram_alloc(vram, VRAM_SPRITES, "particles", PARTICLE_TILES_BYTES, 1);
+}